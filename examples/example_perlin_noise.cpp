@@ -1,4 +1,7 @@
+#include <array>
 #include <fstream>
+#include <vector>
+
 #include <utils/logging.hpp>
 #include <utils/perlin_noise.hpp>
 
@@ -10,11 +13,14 @@ auto main() -> int {
     constexpr size_t HEIGHT = 128;
     constexpr size_t NUM_BYTES = 3 * WIDTH * HEIGHT;
     auto buffer = std::array<uint8_t, NUM_BYTES>();
+    // Sample the whole heightmap in a single call
+    auto heightmap = std::vector<float>(WIDTH * HEIGHT);
+    utils::PerlinNoise::SampleGrid2d(utils::Vec2(0.0F, 0.0F),
+                                     utils::Vec2(1.0F, 1.0F), WIDTH, HEIGHT,
+                                     heightmap.data());
     for (size_t i = 0; i < HEIGHT; i++) {
         for (size_t j = 0; j < WIDTH; j++) {
-            float noise_value =
-                100.0F * utils::PerlinNoise::Sample2d(static_cast<float>(j),
-                                                      static_cast<float>(i));
+            float noise_value = 100.0F * heightmap[j + i * WIDTH];
             buffer.at(3 * (j + i * WIDTH) + 0) =
                 static_cast<uint8_t>(std::max(0.0F, noise_value));
             buffer.at(3 * (j + i * WIDTH) + 1) =
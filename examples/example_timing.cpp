@@ -25,12 +25,21 @@ auto main() -> int {
                      .count();
     LOG_WARN("now: {0}", time_stamp);
 
+    // Events in the hot loop can be resolved once (by name) into handles
+    const auto lapse_1 = utils::Clock::RegisterEvent("lapse_1");
+
     constexpr size_t NUM_STEPS = 10;
     for (size_t i = 0; i < NUM_STEPS; i++) {
         utils::Clock::Tick();
-        utils::Clock::Tick("lapse_1");
+        utils::Clock::Tick(lapse_1);
         std::this_thread::sleep_for(std::chrono::microseconds(11000));
-        utils::Clock::Tock("lapse_1");
+        utils::Clock::Tock(lapse_1);
+
+        {
+            // Scoped events don't require matching Tick/Tock calls
+            CLOCK_SCOPE("lapse_scoped");
+            std::this_thread::sleep_for(std::chrono::microseconds(1000));
+        }
 
         utils::Clock::Tick("lapse_2");
         utils::Clock::Tick("lapse_3");
@@ -52,13 +61,15 @@ auto main() -> int {
         LOG_TRACE("fps            : {0}", utils::Clock::GetFps());
         LOG_TRACE("avg-fps        : {0}", utils::Clock::GetAvgFps());
         LOG_TRACE("lapse_1.step   : {0}",
-                  utils::Clock::GetEvent("lapse_1").time_duration);
+                  utils::Clock::GetEvent(lapse_1).time_duration);
         LOG_TRACE("lapse_2.step   : {0}",
                   utils::Clock::GetEvent("lapse_2").time_duration);
         LOG_TRACE("lapse_3.step   : {0}",
                   utils::Clock::GetEvent("lapse_3").time_duration);
         LOG_TRACE("lapse_4.step   : {0}",
                   utils::Clock::GetEvent("lapse_4").time_duration);
+        LOG_TRACE("scoped.step    : {0}",
+                  utils::Clock::GetEvent("lapse_scoped").time_duration);
     }
 
     utils::Logger::Release();
@@ -1,5 +1,6 @@
 #include <utils/common.hpp>
 #include <utils/logging.hpp>
+#include <utils/noise_field.hpp>
 #include <utils/path_handling.hpp>
 #include <utils/perlin_noise.hpp>
 #include <utils/profiling.hpp>
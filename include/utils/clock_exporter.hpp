@@ -0,0 +1,167 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utils/timing.hpp>
+
+namespace utils {
+
+/// Formats supported by the clock exporter
+enum class eClockExportFormat : uint8_t {
+    /// Blocks of columns (see ClockExporter for the layout)
+    BINARY,
+    /// Comma-separated values, one row per frame
+    CSV,
+};
+
+/// Appends per-frame records of all the registered events of a clock to a
+/// file, for offline analysis of (possibly hours-long) runs. Each frame stores
+/// the frame index, the wall-time of the clock, and the last duration (in ns)
+/// of each event, or -1 if the event wasn't sampled during that frame. Usage:
+///
+///     ClockExporter exporter("./timings.bin");
+///     while (running) {
+///         Clock::Tick();
+///         ...
+///         Clock::Tock();
+///         exporter.Record();
+///     }
+///
+/// Frames are accumulated into blocks, which are handed over to a background
+/// thread that writes them to disk, so Record() never blocks on I/O.
+///
+/// The binary layout (native endianness) is an 8-byte header (BINARY_MAGIC)
+/// followed by blocks, each one being:
+///   - uint32 num_frames, uint32 num_events
+///   - num_events names, each one as uint32 size followed by the characters
+///   - int64 frame[num_frames], float64 wall_time[num_frames]
+///   - int64 duration_ns[num_frames], for each one of the events
+/// Events registered during the run show up in the blocks that follow. CSV
+/// files keep the columns of the events registered at the first Record()
+class UTILS_API ClockExporter {
+    DEFINE_SMART_POINTERS(ClockExporter)
+
+    NO_COPY_NO_MOVE_NO_ASSIGN(ClockExporter)
+
+ public:
+    /// Default number of frames per block
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1024;
+    /// Header of binary files (format identifier plus version)
+    static constexpr const char* BINARY_MAGIC = "LOCOCLK1";
+    /// Size of the header of binary files (in bytes)
+    static constexpr size_t BINARY_MAGIC_SIZE = 8;
+
+    /// Creates an exporter that writes into the given file (truncated). If no
+    /// clock is given, the clock of the thread calling Record() is used
+    explicit ClockExporter(
+        std::string filepath,
+        eClockExportFormat format = eClockExportFormat::BINARY,
+        size_t block_size = DEFAULT_BLOCK_SIZE, Clock* clock = nullptr);
+
+    /// Writes the pending frames and closes the file
+    ~ClockExporter();
+
+    /// Appends a record of the current frame (should be called by the thread
+    /// that owns the clock, usually right after the Tock of the main event)
+    auto Record() -> void;
+
+    /// Hands over the frames recorded so far, and waits until they're written
+    auto Flush() -> void;
+
+    /// Writes the pending frames, stops the writer, and closes the file
+    auto Close() -> void;
+
+    /// Returns whether or not the file could be opened (and isn't closed)
+    UTILS_NODISCARD auto ok() const -> bool { return m_Running; }
+
+    /// Returns the number of frames recorded so far
+    UTILS_NODISCARD auto num_frames() const -> uint64_t { return m_NumFrames; }
+
+    /// Returns the path to the file where the frames are written
+    UTILS_NODISCARD auto filepath() const -> std::string { return m_Filepath; }
+
+    /// Returns the format of the file where the frames are written
+    UTILS_NODISCARD auto format() const -> eClockExportFormat {
+        return m_Format;
+    }
+
+ private:
+    /// Frames recorded by the exporter, stored by columns
+    struct Block {
+        /// Names of the events (one column per event)
+        std::vector<std::string> names;
+        /// Number of frames stored in the block
+        size_t num_frames = 0;
+        /// Index of each frame
+        std::vector<int64_t> frames;
+        /// Wall-time of the clock at each frame (in seconds)
+        std::vector<double> wall_times;
+        /// Durations of the events, one column of block_size per event
+        std::vector<int64_t> durations;
+    };
+
+    /// Returns an empty block for the given events (reusing written blocks)
+    auto _AcquireBlock(size_t num_events) -> std::unique_ptr<Block>;
+
+    /// Hands the current block over to the writer (if it has any frames)
+    auto _Submit() -> void;
+
+    /// Loop of the writer thread
+    auto _Run() -> void;
+
+    /// Writes a block in the format of the exporter (writer thread only)
+    auto _WriteBlock(const Block& block) -> void;
+
+ private:
+    /// Path to the file where the frames are written
+    std::string m_Filepath;
+    /// Format of the file
+    eClockExportFormat m_Format = eClockExportFormat::BINARY;
+    /// Number of frames per block
+    size_t m_BlockSize = DEFAULT_BLOCK_SIZE;
+    /// Clock to be recorded (nullptr for the clock of the calling thread)
+    Clock* m_Clock = nullptr;
+    /// Number of frames recorded so far
+    uint64_t m_NumFrames = 0;
+    /// Number of columns of CSV files (fixed at the first Record())
+    size_t m_NumCsvColumns = 0;
+    /// Whether or not we warned about events missing from the CSV columns
+    bool m_WarnedCsvColumns = false;
+    /// Whether or not the header of the CSV file was written (writer only)
+    bool m_CsvHeaderWritten = false;
+    /// Names of the events seen so far (cached, to avoid registry lookups)
+    std::vector<std::string> m_Names;
+    /// Scratch buffers used to read the samples of the clock
+    std::vector<int64_t> m_Durations;
+    std::vector<uint64_t> m_NumSamples;
+    /// Number of samples of each event at the previous frame
+    std::vector<uint64_t> m_LastNumSamples;
+    /// Block being filled by Record()
+    std::unique_ptr<Block> m_Current = nullptr;
+    /// Blocks waiting to be written
+    std::deque<std::unique_ptr<Block>> m_Pending;
+    /// Blocks already written (reused, to avoid allocations)
+    std::vector<std::unique_ptr<Block>> m_Spare;
+    /// Whether the writer is currently writing a block
+    bool m_Writing = false;
+    /// Whether the writer thread is running
+    bool m_Running = false;
+    /// Lock and condition variables shared with the writer thread
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkCondVar;
+    std::condition_variable m_IdleCondVar;
+    /// File where the frames are written (writer thread only)
+    std::ofstream m_File;
+    /// Thread that writes the blocks
+    std::thread m_Thread;
+};
+
+}  // namespace utils
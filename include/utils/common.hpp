@@ -25,6 +25,21 @@
     #define UTILS_NEVER_INLINE
 #endif
 
+// Branch-prediction and code-layout hints (used to keep failure paths cold)
+#if defined(__GNUC__) || defined(__clang__)
+    #define UTILS_LIKELY(x) __builtin_expect(!!(x), 1)
+    #define UTILS_UNLIKELY(x) __builtin_expect(!!(x), 0)
+    #define UTILS_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+    #define UTILS_LIKELY(x) (x)
+    #define UTILS_UNLIKELY(x) (x)
+    #define UTILS_COLD __declspec(noinline)
+#else
+    #define UTILS_LIKELY(x) (x)
+    #define UTILS_UNLIKELY(x) (x)
+    #define UTILS_COLD
+#endif
+
 #define UTILS_LANG_CXX98_FLAG (1 << 1)
 #define UTILS_LANG_CXX03_FLAG (1 << 2)
 #define UTILS_LANG_CXX0X_FLAG (1 << 3)
@@ -190,6 +205,12 @@ typename _Unique_if<T>::_Known_bound make_unique(Args &&...) = delete;
 #define __FUNCTION_NAME__ __FUNCSIG__
 #endif
 
+// Token-pasting helpers (the extra indirection expands macros like __LINE__)
+// NOLINTNEXTLINE
+#define UTILS_CONCAT_IMPL(a, b) a##b
+// NOLINTNEXTLINE
+#define UTILS_CONCAT(a, b) UTILS_CONCAT_IMPL(a, b)
+
 //----------------------------------------------------------------------------//
 //              Smart pointer helper macros for class-declarations            //
 //----------------------------------------------------------------------------//
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <spdlog/spdlog.h>
+
+#include <utils/common.hpp>
+
+namespace utils {
+
+/// Single log record stored in the per-thread crash ring
+struct UTILS_API CrashLogRecord {
+    /// Maximum number of characters of the formatted message kept per record
+    /// (chosen so that each record spans exactly 256 bytes)
+    static constexpr size_t MAX_TEXT_SIZE = 242;
+
+    /// Time-stamp of the record (in nanoseconds since the epoch)
+    int64_t time_ns = 0;
+    /// Severity level of the record (spdlog's level enum)
+    uint8_t level = 0;
+    /// Whether the record was sent to the core logger or the client logger
+    bool is_core = false;
+    /// Whether the formatted message didn't fit and was truncated
+    bool truncated = false;
+    /// Number of valid characters in the text buffer
+    uint16_t size = 0;
+    /// Formatted message (not null-terminated)
+    char text[MAX_TEXT_SIZE] = {};  // NOLINT
+};
+
+/// Always-on, in-memory record of the last log messages of each thread. The
+/// records are dumped to a file on critical errors, failed assertions, and on
+/// fatal signals, so the context that lead to the crash isn't lost
+class UTILS_API CrashLog {
+ public:
+    /// Default number of records kept per thread
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+    /// Default path of the file where the records are dumped
+    static constexpr const char* DEFAULT_FILEPATH = "./crash_log.txt";
+
+    /// Enables recording, and installs the handlers for fatal signals (SIGSEGV,
+    /// SIGABRT, SIGFPE, SIGILL). The capacity applies to new thread-rings
+    static auto Init(const char* filepath = DEFAULT_FILEPATH,
+                     size_t capacity = DEFAULT_CAPACITY) -> void;
+
+    /// Disables recording, restores the previous signal handlers, and drops
+    /// the rings of all threads
+    static auto Release() -> void;
+
+    /// Returns whether or not the crash log is recording messages
+    static auto IsEnabled() -> bool;
+
+    /// Formats a message into the next slot of the calling thread's ring, and
+    /// returns the slot (or nullptr if recording is disabled)
+    template <typename... Args>
+    static auto Record(bool is_core, spdlog::level::level_enum level,
+                       fmt::basic_string_view<char> fmt, const Args&... args)
+        -> const CrashLogRecord* {
+        auto* record = _AcquireRecord(is_core, level);
+        if (record == nullptr) {
+            return nullptr;
+        }
+        auto result = fmt::vformat_to_n(record->text,
+                                        CrashLogRecord::MAX_TEXT_SIZE, fmt,
+                                        fmt::make_format_args(args...));
+        record->truncated = (result.size > CrashLogRecord::MAX_TEXT_SIZE);
+        record->size = static_cast<uint16_t>(
+            record->truncated ? CrashLogRecord::MAX_TEXT_SIZE : result.size);
+        return record;
+    }
+
+    /// Writes the records of all threads into the crash-log file
+    static auto Dump(const char* reason) -> void;
+
+ private:
+    /// Returns the next slot in the calling thread's ring (overwriting the
+    /// oldest record once the ring is full)
+    static auto _AcquireRecord(bool is_core, spdlog::level::level_enum level)
+        -> CrashLogRecord*;
+};
+
+}  // namespace utils
@@ -1,15 +1,110 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/sinks/stdout_sinks.h>
 #include <spdlog/spdlog.h>
 
 #include <utils/common.hpp>
+#include <utils/crash_log.hpp>
+#include <utils/logging_kv.hpp>
 
 namespace utils {
 
+/// Per call-site state used by the rate-limited logging macros. Instances are
+/// constant-initialized, so a function-local static has no init-guard cost
+class UTILS_API LogRateLimiter {
+ public:
+    constexpr LogRateLimiter() = default;
+
+    /// Returns true for the first call, and then once every n calls. The
+    /// calls skipped in between are reported along with the next allowed one
+    auto EveryN(uint64_t n) -> bool {
+        const auto count = m_Count.fetch_add(1, std::memory_order_relaxed);
+        if ((n <= 1) || (count % n == 0)) {
+            _FlushSuppressed();
+            return true;
+        }
+        m_Suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /// Returns true if at least period_ms milliseconds have passed since the
+    /// last time this call-site was allowed to log
+    auto EveryMs(uint64_t period_ms) -> bool {
+        const int64_t now_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        const auto period_ns = static_cast<int64_t>(period_ms * 1000000);
+        auto last_ns = m_LastNs.load(std::memory_order_relaxed);
+        if ((last_ns == 0 || now_ns - last_ns >= period_ns) &&
+            m_LastNs.compare_exchange_strong(last_ns, now_ns,
+                                             std::memory_order_relaxed)) {
+            _FlushSuppressed();
+            return true;
+        }
+        m_Suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /// Returns true only for the first n calls. Afterwards, a summary is
+    /// scheduled each time the total of suppressed calls hits a power of two
+    auto FirstN(uint64_t n) -> bool {
+        const auto count = m_Count.fetch_add(1, std::memory_order_relaxed);
+        if (count < n) {
+            return true;
+        }
+        m_Suppressed.fetch_add(1, std::memory_order_relaxed);
+        const auto total_suppressed = count - n + 1;
+        if ((total_suppressed & (total_suppressed - 1)) == 0) {
+            _FlushSuppressed();
+        }
+        return false;
+    }
+
+    /// Returns the number of suppressed calls that are pending to be reported
+    /// (if any), and marks them as reported
+    auto TakePendingSummary() -> uint64_t {
+        if (m_Pending.load(std::memory_order_relaxed) == 0) {
+            return 0;
+        }
+        return m_Pending.exchange(0, std::memory_order_relaxed);
+    }
+
+ private:
+    /// Moves the suppressed-calls count into the pending-summary count
+    auto _FlushSuppressed() -> void {
+        const auto suppressed =
+            m_Suppressed.exchange(0, std::memory_order_relaxed);
+        if (suppressed > 0) {
+            m_Pending.fetch_add(suppressed, std::memory_order_relaxed);
+        }
+    }
+
+    /// Number of calls that went through this call-site
+    std::atomic<uint64_t> m_Count{0};
+    /// Number of calls suppressed since the last summary
+    std::atomic<uint64_t> m_Suppressed{0};
+    /// Number of suppressed calls that should be reported in a summary
+    std::atomic<uint64_t> m_Pending{0};
+    /// Time-stamp (in nanoseconds) of the last allowed call (0 means never)
+    std::atomic<int64_t> m_LastNs{0};
+};
+
+/// Exception thrown by failed assertions when using the THROW policy
+class UTILS_API AssertionError : public std::runtime_error {
+ public:
+    explicit AssertionError(const std::string& msg)
+        : std::runtime_error(msg) {}
+};
+
 class UTILS_API Logger {
     // cppcheck-suppress unknownMacro
     NO_COPY_NO_MOVE_NO_ASSIGN(Logger)
@@ -25,6 +120,21 @@ class UTILS_API Logger {
         FILE_LOGGER
     };
 
+    /// Available policies to handle failed assertions
+    enum class eAssertPolicy : uint8_t {
+        /// Log the failure, dump the crash log and exit(EXIT_FAILURE)
+        EXIT,
+        /// Log the failure and call std::abort (the crash log is dumped by
+        /// the SIGABRT handler)
+        ABORT,
+        /// Log the failure and throw an AssertionError
+        THROW,
+        /// Log the failure and keep going
+        LOG_AND_CONTINUE,
+        /// Log the failure and break into the debugger (if any)
+        DEBUG_BREAK
+    };
+
     /// Releases the resources allocated by this logger
     ~Logger() = default;
 
@@ -46,9 +156,28 @@ class UTILS_API Logger {
     /// Returns an unmutable reference to the internal client logger
     UTILS_NODISCARD auto client_logger() const -> const spdlog::logger&;
 
+    /// Returns the policy used to handle failed assertions
+    UTILS_NODISCARD auto assert_policy() const -> eAssertPolicy {
+        return m_AssertPolicy;
+    }
+
+    /// Returns the encoding used for structured (key-value) records
+    UTILS_NODISCARD auto kv_format() const -> eKvFormat { return m_KvFormat; }
+
+    /// Returns a mutable reference to the core logger for key-value records
+    UTILS_NODISCARD auto core_kv_logger() -> spdlog::logger&;
+
+    /// Returns a mutable reference to the client logger for key-value records
+    UTILS_NODISCARD auto client_kv_logger() -> spdlog::logger&;
+
  public:
-    /// Initialized the logging module given a mode
-    static auto Init(eType logger_type = eType::CONSOLE_LOGGER) -> void;
+    /// Initialized the logging module given a mode, the encoding used for
+    /// structured records (binary records are only supported by file loggers)
+    /// and the policy used to handle failed assertions
+    static auto Init(eType logger_type = eType::CONSOLE_LOGGER,
+                     eKvFormat kv_format = eKvFormat::JSON_LINES,
+                     eAssertPolicy assert_policy = eAssertPolicy::EXIT)
+        -> void;
 
     /// Cleans all resources used by this module
     static auto Release() -> void;
@@ -64,43 +193,61 @@ class UTILS_API Logger {
     template <typename... Args>
     static auto CoreTrace(fmt::basic_string_view<char> fmt, const Args&... args)
         -> void {
-        Logger::GetInstance().core_logger().trace(fmt, args...);
+        _Log(Logger::GetInstance().core_logger(), true,
+             spdlog::level::trace, fmt, args...);
     }
 
     template <typename... Args>
     static auto CoreInfo(fmt::basic_string_view<char> fmt, const Args&... args)
         -> void {
-        Logger::GetInstance().core_logger().info(fmt, args...);
+        _Log(Logger::GetInstance().core_logger(), true,
+             spdlog::level::info, fmt, args...);
     }
 
     template <typename... Args>
     static auto CoreWarn(fmt::basic_string_view<char> fmt, const Args&... args)
         -> void {
-        Logger::GetInstance().core_logger().warn(fmt, args...);
+        _Log(Logger::GetInstance().core_logger(), true,
+             spdlog::level::warn, fmt, args...);
     }
 
     template <typename... Args>
     static auto CoreError(fmt::basic_string_view<char> fmt, const Args&... args)
         -> void {
-        Logger::GetInstance().core_logger().error(fmt, args...);
+        _Log(Logger::GetInstance().core_logger(), true,
+             spdlog::level::err, fmt, args...);
     }
 
     template <typename... Args>
     static auto CoreCritical(fmt::basic_string_view<char> fmt,
                              const Args&... args) -> void {
-        Logger::GetInstance().core_logger().critical(fmt, args...);
+        _Log(Logger::GetInstance().core_logger(), true,
+             spdlog::level::critical, fmt, args...);
+        CrashLog::Dump("critical error");
         exit(EXIT_FAILURE);
     }
 
     template <typename... Args>
     static auto CoreAssert(bool is_not_ok, fmt::basic_string_view<char> fmt,
                            const Args&... args) -> void {
-        if (!is_not_ok) {
+        if (UTILS_LIKELY(!is_not_ok)) {
             return;
         }
+        CoreAssertFailed("", "", 0, fmt, args...);
+    }
 
-        Logger::GetInstance().core_logger().critical(fmt, args...);
-        exit(EXIT_FAILURE);
+    /// Handles a failed core assertion (message arguments are only evaluated
+    /// by the LOG_CORE_ASSERT macro once the assertion has failed)
+    template <typename... Args>
+    UTILS_COLD static auto CoreAssertFailed(const char* expr, const char* file,
+                                            int line,
+                                            fmt::basic_string_view<char> fmt,
+                                            const Args&... args) -> void {
+        fmt::memory_buffer msg;
+        fmt::vformat_to(std::back_inserter(msg), fmt,
+                        fmt::make_format_args(args...));
+        _OnAssertFailed(true, expr, file, line,
+                        spdlog::string_view_t(msg.data(), msg.size()));
     }
 
     //---------------------------------------------------------------------//
@@ -110,48 +257,144 @@ class UTILS_API Logger {
     template <typename... Args>
     static auto ClientTrace(fmt::basic_string_view<char> fmt,
                             const Args&... args) -> void {
-        Logger::GetInstance().client_logger().trace(fmt, args...);
+        _Log(Logger::GetInstance().client_logger(), false,
+             spdlog::level::trace, fmt, args...);
     }
 
     template <typename... Args>
     static auto ClientInfo(fmt::basic_string_view<char> fmt,
                            const Args&... args) -> void {
-        Logger::GetInstance().client_logger().info(fmt, args...);
+        _Log(Logger::GetInstance().client_logger(), false,
+             spdlog::level::info, fmt, args...);
     }
 
     template <typename... Args>
     static auto ClientWarn(fmt::basic_string_view<char> fmt,
                            const Args&... args) -> void {
-        Logger::GetInstance().client_logger().warn(fmt, args...);
+        _Log(Logger::GetInstance().client_logger(), false,
+             spdlog::level::warn, fmt, args...);
     }
 
     template <typename... Args>
     static auto ClientError(fmt::basic_string_view<char> fmt,
                             const Args&... args) -> void {
-        Logger::GetInstance().client_logger().error(fmt, args...);
+        _Log(Logger::GetInstance().client_logger(), false,
+             spdlog::level::err, fmt, args...);
     }
 
     template <typename... Args>
     static auto ClientCritical(fmt::basic_string_view<char> fmt,
                                const Args&... args) -> void {
-        Logger::GetInstance().client_logger().critical(fmt, args...);
+        _Log(Logger::GetInstance().client_logger(), false,
+             spdlog::level::critical, fmt, args...);
+        CrashLog::Dump("critical error");
         exit(EXIT_FAILURE);
     }
 
     template <typename... Args>
     static auto ClientAssert(bool is_not_ok, fmt::basic_string_view<char> fmt,
                              const Args&... args) -> void {
-        if (!is_not_ok) {
+        if (UTILS_LIKELY(!is_not_ok)) {
             return;
         }
+        ClientAssertFailed("", "", 0, fmt, args...);
+    }
 
-        Logger::GetInstance().client_logger().critical(fmt, args...);
-        exit(EXIT_FAILURE);
+    /// Handles a failed client assertion (message arguments are only
+    /// evaluated by the LOG_ASSERT macro once the assertion has failed)
+    template <typename... Args>
+    UTILS_COLD static auto ClientAssertFailed(const char* expr,
+                                              const char* file, int line,
+                                              fmt::basic_string_view<char> fmt,
+                                              const Args&... args) -> void {
+        fmt::memory_buffer msg;
+        fmt::vformat_to(std::back_inserter(msg), fmt,
+                        fmt::make_format_args(args...));
+        _OnAssertFailed(false, expr, file, line,
+                        spdlog::string_view_t(msg.data(), msg.size()));
+    }
+
+    /// Logs an already formatted message into the core logger with the given
+    /// level (recorded in the crash log as well). Used mostly by bindings
+    static auto CoreLog(spdlog::level::level_enum level,
+                        spdlog::string_view_t msg) -> void;
+
+    /// Logs an already formatted message into the client logger with the
+    /// given level (recorded in the crash log as well). Used mostly by bindings
+    static auto ClientLog(spdlog::level::level_enum level,
+                          spdlog::string_view_t msg) -> void;
+
+    /// Reports the number of messages that were suppressed by rate-limiting
+    /// at a given call-site, using the same logger and level of that site
+    static auto LogSuppressed(bool is_core, spdlog::level::level_enum level,
+                              uint64_t num_suppressed, const char* file,
+                              int line) -> void;
+
+    //---------------------------------------------------------------------//
+    // Structured logging functionality (message + alternating key-values) //
+    //---------------------------------------------------------------------//
+
+    template <typename... Args>
+    static auto CoreKv(spdlog::level::level_enum level,
+                       spdlog::string_view_t msg, const Args&... fields)
+        -> void {
+        auto& logger = Logger::GetInstance();
+        _LogKv(logger.core_kv_logger(), logger.kv_format(), level, msg,
+               fields...);
+    }
+
+    template <typename... Args>
+    static auto ClientKv(spdlog::level::level_enum level,
+                         spdlog::string_view_t msg, const Args&... fields)
+        -> void {
+        auto& logger = Logger::GetInstance();
+        _LogKv(logger.client_kv_logger(), logger.kv_format(), level, msg,
+               fields...);
     }
 
  private:
     /// Constructor for a logger given its type. Not exposed to user (singleton)
-    explicit Logger(eType type);
+    Logger(eType type, eKvFormat kv_format, eAssertPolicy assert_policy);
+
+    /// Logs a failed assertion and then applies the configured policy
+    static auto _OnAssertFailed(bool is_core, const char* expr,
+                                const char* file, int line,
+                                spdlog::string_view_t msg) -> void;
+
+    /// Records a message into the crash log (regardless of the level), and
+    /// then sends it to the given logger (only if the level is enabled for it)
+    template <typename... Args>
+    static auto _Log(spdlog::logger& logger, bool is_core,
+                     spdlog::level::level_enum level,
+                     fmt::basic_string_view<char> fmt, const Args&... args)
+        -> void {
+        const auto* record = CrashLog::Record(is_core, level, fmt, args...);
+        if (!logger.should_log(level)) {
+            return;
+        }
+        // Reuse the message already formatted into the ring (if it fit)
+        if (record != nullptr && !record->truncated) {
+            logger.log(level,
+                       spdlog::string_view_t(record->text, record->size));
+        } else {
+            logger.log(level, fmt, args...);
+        }
+    }
+
+    /// Encodes a key-value record into the thread's scratch buffer and sends
+    /// it to the given logger (only if the level is enabled for it)
+    template <typename... Args>
+    static auto _LogKv(spdlog::logger& logger, eKvFormat format,
+                       spdlog::level::level_enum level,
+                       spdlog::string_view_t msg, const Args&... fields)
+        -> void {
+        if (!logger.should_log(level)) {
+            return;
+        }
+        auto& buffer = GetThreadKvBuffer();
+        kv::EncodeRecord(buffer, format, level, msg, fields...);
+        logger.log(level, spdlog::string_view_t(buffer.data(), buffer.size()));
+    }
 
     /// The unique instance of this logging module
     static Logger::uptr s_Instance;  // NOLINT
@@ -164,6 +407,14 @@ class UTILS_API Logger {
     std::shared_ptr<spdlog::logger> m_CoreLogger = nullptr;
     /// The spdlog client logger (should be used for user/client traces)
     std::shared_ptr<spdlog::logger> m_ClientLogger = nullptr;
+    /// The policy used to handle failed assertions
+    eAssertPolicy m_AssertPolicy = eAssertPolicy::EXIT;
+    /// The encoding used for structured records (json-lines or binary)
+    eKvFormat m_KvFormat = eKvFormat::JSON_LINES;
+    /// The spdlog core logger used for structured (key-value) records
+    std::shared_ptr<spdlog::logger> m_CoreKvLogger = nullptr;
+    /// The spdlog client logger used for structured (key-value) records
+    std::shared_ptr<spdlog::logger> m_ClientKvLogger = nullptr;
 };
 
 }  // namespace utils
@@ -178,8 +429,20 @@ class UTILS_API Logger {
 #define LOG_CORE_ERROR(...) ::utils::Logger::CoreError(__VA_ARGS__)
 // NOLINTNEXTLINE
 #define LOG_CORE_CRITICAL(...) ::utils::Logger::CoreCritical(__VA_ARGS__)
+
+// Assertions can be compiled out by defining UTILS_DISABLE_ASSERTS (see the
+// UTILS_DISABLE_ASSERTS_IN_RELEASE cmake option). Otherwise, the condition is
+// the only thing evaluated in the (likely) success path
+#if defined(UTILS_DISABLE_ASSERTS)
 // NOLINTNEXTLINE
-#define LOG_CORE_ASSERT(x, ...) ::utils::Logger::CoreAssert(!(x), __VA_ARGS__)
+#define LOG_CORE_ASSERT(x, ...) static_cast<void>(sizeof(!(x)))
+#else
+// NOLINTNEXTLINE
+#define LOG_CORE_ASSERT(x, ...)                                       \
+    (UTILS_LIKELY(x) ? static_cast<void>(0)                           \
+                     : ::utils::Logger::CoreAssertFailed(              \
+                           #x, __FILE__, __LINE__, __VA_ARGS__))
+#endif
 
 // NOLINTNEXTLINE
 #define LOG_TRACE(...) ::utils::Logger::ClientTrace(__VA_ARGS__)
@@ -191,5 +454,155 @@ class UTILS_API Logger {
 #define LOG_ERROR(...) ::utils::Logger::ClientError(__VA_ARGS__)
 // NOLINTNEXTLINE
 #define LOG_CRITICAL(...) ::utils::Logger::ClientCritical(__VA_ARGS__)
+
+#if defined(UTILS_DISABLE_ASSERTS)
+// NOLINTNEXTLINE
+#define LOG_ASSERT(x, ...) static_cast<void>(sizeof(!(x)))
+#else
+// NOLINTNEXTLINE
+#define LOG_ASSERT(x, ...)                                            \
+    (UTILS_LIKELY(x) ? static_cast<void>(0)                           \
+                     : ::utils::Logger::ClientAssertFailed(            \
+                           #x, __FILE__, __LINE__, __VA_ARGS__))
+#endif
+
+// NOLINTNEXTLINE
+#define LOG_CORE_TRACE_KV(...) \
+    ::utils::Logger::CoreKv(spdlog::level::trace, __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_INFO_KV(...) \
+    ::utils::Logger::CoreKv(spdlog::level::info, __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_WARN_KV(...) \
+    ::utils::Logger::CoreKv(spdlog::level::warn, __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_ERROR_KV(...) \
+    ::utils::Logger::CoreKv(spdlog::level::err, __VA_ARGS__)
+
+// NOLINTNEXTLINE
+#define LOG_TRACE_KV(...) \
+    ::utils::Logger::ClientKv(spdlog::level::trace, __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_INFO_KV(...) \
+    ::utils::Logger::ClientKv(spdlog::level::info, __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_WARN_KV(...) \
+    ::utils::Logger::ClientKv(spdlog::level::warn, __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_ERROR_KV(...) \
+    ::utils::Logger::ClientKv(spdlog::level::err, __VA_ARGS__)
+
+// NOLINTNEXTLINE
+#define UTILS_LOG_RATE_LIMITED_(log_macro, is_core, level, check, ...)   \
+    do {                                                                 \
+        static ::utils::LogRateLimiter utils_log_limiter_;               \
+        if (utils_log_limiter_.check) {                                  \
+            log_macro(__VA_ARGS__);                                      \
+        }                                                                \
+        const uint64_t utils_log_suppressed_ =                           \
+            utils_log_limiter_.TakePendingSummary();                     \
+        if (utils_log_suppressed_ > 0) {                                 \
+            ::utils::Logger::LogSuppressed(is_core, level,               \
+                                           utils_log_suppressed_,        \
+                                           __FILE__, __LINE__);          \
+        }                                                                \
+    } while (false)
+
+// NOLINTNEXTLINE
+#define LOG_CORE_TRACE_EVERY_N(n, ...)                                     \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_TRACE, true, spdlog::level::trace, \
+                            EveryN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_INFO_EVERY_N(n, ...)                                    \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_INFO, true, spdlog::level::info, \
+                            EveryN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_WARN_EVERY_N(n, ...)                                    \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_WARN, true, spdlog::level::warn, \
+                            EveryN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_ERROR_EVERY_N(n, ...)                                  \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_ERROR, true, spdlog::level::err, \
+                            EveryN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_TRACE_EVERY_N(n, ...)                                      \
+    UTILS_LOG_RATE_LIMITED_(LOG_TRACE, false, spdlog::level::trace, \
+                            EveryN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_INFO_EVERY_N(n, ...)                                     \
+    UTILS_LOG_RATE_LIMITED_(LOG_INFO, false, spdlog::level::info, \
+                            EveryN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_WARN_EVERY_N(n, ...)                                     \
+    UTILS_LOG_RATE_LIMITED_(LOG_WARN, false, spdlog::level::warn, \
+                            EveryN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_ERROR_EVERY_N(n, ...)                                     \
+    UTILS_LOG_RATE_LIMITED_(LOG_ERROR, false, spdlog::level::err, \
+                            EveryN(n), __VA_ARGS__)
+
+// NOLINTNEXTLINE
+#define LOG_CORE_TRACE_EVERY_MS(ms, ...)                                   \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_TRACE, true, spdlog::level::trace, \
+                            EveryMs(ms), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_INFO_EVERY_MS(ms, ...)                                  \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_INFO, true, spdlog::level::info, \
+                            EveryMs(ms), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_WARN_EVERY_MS(ms, ...)                                  \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_WARN, true, spdlog::level::warn, \
+                            EveryMs(ms), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_ERROR_EVERY_MS(ms, ...)                                \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_ERROR, true, spdlog::level::err, \
+                            EveryMs(ms), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_TRACE_EVERY_MS(ms, ...)                                    \
+    UTILS_LOG_RATE_LIMITED_(LOG_TRACE, false, spdlog::level::trace, \
+                            EveryMs(ms), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_INFO_EVERY_MS(ms, ...)                                   \
+    UTILS_LOG_RATE_LIMITED_(LOG_INFO, false, spdlog::level::info, \
+                            EveryMs(ms), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_WARN_EVERY_MS(ms, ...)                                   \
+    UTILS_LOG_RATE_LIMITED_(LOG_WARN, false, spdlog::level::warn, \
+                            EveryMs(ms), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_ERROR_EVERY_MS(ms, ...)                                   \
+    UTILS_LOG_RATE_LIMITED_(LOG_ERROR, false, spdlog::level::err, \
+                            EveryMs(ms), __VA_ARGS__)
+
+// NOLINTNEXTLINE
+#define LOG_CORE_TRACE_FIRST_N(n, ...)                                     \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_TRACE, true, spdlog::level::trace, \
+                            FirstN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_INFO_FIRST_N(n, ...)                                    \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_INFO, true, spdlog::level::info, \
+                            FirstN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_WARN_FIRST_N(n, ...)                                    \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_WARN, true, spdlog::level::warn, \
+                            FirstN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_CORE_ERROR_FIRST_N(n, ...)                                  \
+    UTILS_LOG_RATE_LIMITED_(LOG_CORE_ERROR, true, spdlog::level::err, \
+                            FirstN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_TRACE_FIRST_N(n, ...)                                      \
+    UTILS_LOG_RATE_LIMITED_(LOG_TRACE, false, spdlog::level::trace, \
+                            FirstN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_INFO_FIRST_N(n, ...)                                     \
+    UTILS_LOG_RATE_LIMITED_(LOG_INFO, false, spdlog::level::info, \
+                            FirstN(n), __VA_ARGS__)
+// NOLINTNEXTLINE
+#define LOG_WARN_FIRST_N(n, ...)                                     \
+    UTILS_LOG_RATE_LIMITED_(LOG_WARN, false, spdlog::level::warn, \
+                            FirstN(n), __VA_ARGS__)
 // NOLINTNEXTLINE
-#define LOG_ASSERT(x, ...) ::utils::Logger::ClientAssert(!(x), __VA_ARGS__)
+#define LOG_ERROR_FIRST_N(n, ...)                                     \
+    UTILS_LOG_RATE_LIMITED_(LOG_ERROR, false, spdlog::level::err, \
+                            FirstN(n), __VA_ARGS__)
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+
+#include <spdlog/spdlog.h>
+
+#include <utils/common.hpp>
+
+namespace utils {
+
+/// Available encodings for structured (key-value) log records
+enum class eKvFormat : uint8_t {
+    /// One JSON object per line (fields are appended after the metadata)
+    JSON_LINES,
+    /// Compact length-prefixed binary records (only used for file loggers)
+    BINARY
+};
+
+/// Tags used to identify the type of each value in binary key-value records
+enum class eKvTag : uint8_t {
+    BOOL = 0,
+    INT64 = 1,
+    UINT64 = 2,
+    FLOAT64 = 3,
+    STRING = 4,
+};
+
+/// Buffer type used to encode key-value records
+using KvBuffer = fmt::memory_buffer;
+
+/// Returns a reusable scratch buffer used to encode the records of the calling
+/// thread (avoids allocations once the buffer has grown to its working size)
+UTILS_API auto GetThreadKvBuffer() -> KvBuffer&;
+
+namespace kv {
+
+/// Appends the raw bytes of a trivially copyable value to the buffer
+template <typename T>
+auto AppendRaw(KvBuffer& buffer, const T& value) -> void {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "kv::AppendRaw requires a trivially copyable type");
+    const auto* bytes = reinterpret_cast<const char*>(&value);  // NOLINT
+    buffer.append(bytes, bytes + sizeof(T));
+}
+
+/// Appends a string as-is (no escaping nor quotes)
+inline auto AppendText(KvBuffer& buffer, spdlog::string_view_t str) -> void {
+    buffer.append(str.data(), str.data() + str.size());
+}
+
+/// Appends a string escaped according to the JSON spec (with quotes)
+UTILS_API auto AppendJsonString(KvBuffer& buffer, spdlog::string_view_t str)
+    -> void;
+
+/// Appends a length-prefixed string (used for both keys and string values)
+inline auto AppendBinaryString(KvBuffer& buffer, spdlog::string_view_t str)
+    -> void {
+    AppendRaw(buffer, static_cast<uint32_t>(str.size()));
+    AppendText(buffer, str);
+}
+
+/// Appends the key part of a field (separator and name in JSON mode)
+inline auto AppendKey(KvBuffer& buffer, eKvFormat format,
+                      spdlog::string_view_t key) -> void {
+    if (format == eKvFormat::JSON_LINES) {
+        buffer.push_back(',');
+        AppendJsonString(buffer, key);
+        buffer.push_back(':');
+    } else {
+        AppendBinaryString(buffer, key);
+    }
+}
+
+inline auto AppendValue(KvBuffer& buffer, eKvFormat format, bool value)
+    -> void {
+    if (format == eKvFormat::JSON_LINES) {
+        AppendText(buffer, value ? "true" : "false");
+    } else {
+        AppendRaw(buffer, eKvTag::BOOL);
+        AppendRaw(buffer, static_cast<uint8_t>(value ? 1 : 0));
+    }
+}
+
+inline auto AppendValue(KvBuffer& buffer, eKvFormat format,
+                        spdlog::string_view_t value) -> void {
+    if (format == eKvFormat::JSON_LINES) {
+        AppendJsonString(buffer, value);
+    } else {
+        AppendRaw(buffer, eKvTag::STRING);
+        AppendBinaryString(buffer, value);
+    }
+}
+
+inline auto AppendValue(KvBuffer& buffer, eKvFormat format, const char* value)
+    -> void {
+    AppendValue(buffer, format, spdlog::string_view_t(value));
+}
+
+inline auto AppendValue(KvBuffer& buffer, eKvFormat format,
+                        const std::string& value) -> void {
+    AppendValue(buffer, format,
+                spdlog::string_view_t(value.data(), value.size()));
+}
+
+template <typename T, typename std::enable_if<
+                          std::is_integral<T>::value &&
+                              !std::is_same<T, bool>::value,
+                          int>::type = 0>
+auto AppendValue(KvBuffer& buffer, eKvFormat format, T value) -> void {
+    if (format == eKvFormat::JSON_LINES) {
+        fmt::format_to(std::back_inserter(buffer), "{}", value);
+    } else if (std::is_signed<T>::value) {
+        AppendRaw(buffer, eKvTag::INT64);
+        AppendRaw(buffer, static_cast<int64_t>(value));
+    } else {
+        AppendRaw(buffer, eKvTag::UINT64);
+        AppendRaw(buffer, static_cast<uint64_t>(value));
+    }
+}
+
+template <typename T, typename std::enable_if<
+                          std::is_floating_point<T>::value, int>::type = 0>
+auto AppendValue(KvBuffer& buffer, eKvFormat format, T value) -> void {
+    if (format == eKvFormat::JSON_LINES) {
+        // JSON has no representation for nan/inf, so we fallback to null
+        if (std::isfinite(value)) {
+            fmt::format_to(std::back_inserter(buffer), "{}", value);
+        } else {
+            AppendText(buffer, "null");
+        }
+    } else {
+        AppendRaw(buffer, eKvTag::FLOAT64);
+        AppendRaw(buffer, static_cast<double>(value));
+    }
+}
+
+/// Fallback for any other type that can be formatted by fmt (encoded as string)
+template <typename T,
+          typename std::enable_if<
+              !std::is_arithmetic<T>::value &&
+                  !std::is_convertible<T, spdlog::string_view_t>::value,
+              int>::type = 0>
+auto AppendValue(KvBuffer& buffer, eKvFormat format, const T& value) -> void {
+    fmt::basic_memory_buffer<char, 128> scratch;
+    fmt::format_to(std::back_inserter(scratch), "{}", value);
+    AppendValue(buffer, format,
+                spdlog::string_view_t(scratch.data(), scratch.size()));
+}
+
+inline auto AppendFields(KvBuffer& /*buffer*/, eKvFormat /*format*/)
+    -> uint8_t {
+    return 0;
+}
+
+template <typename V, typename... Rest>
+auto AppendFields(KvBuffer& buffer, eKvFormat format,
+                  spdlog::string_view_t key, const V& value,
+                  const Rest&... rest) -> uint8_t {
+    AppendKey(buffer, format, key);
+    AppendValue(buffer, format, value);
+    return static_cast<uint8_t>(1 + AppendFields(buffer, format, rest...));
+}
+
+/// Encodes a full record into the buffer, given a message and a list of
+/// alternating keys and values
+///
+/// In JSON mode the output is the body of an object without the braces (these
+/// are added by the pattern of the kv-sink, alongside the record metadata).
+/// In BINARY mode the output is a self-contained record with layout:
+/// [u32 size][i64 timestamp-ns][u8 level][u8 num-fields][msg][fields...]
+template <typename... Args>
+auto EncodeRecord(KvBuffer& buffer, eKvFormat format,
+                  spdlog::level::level_enum level, spdlog::string_view_t msg,
+                  const Args&... fields) -> void {
+    static_assert(sizeof...(Args) % 2 == 0,
+                  "Structured logs expect alternating keys and values");
+    buffer.clear();
+    if (format == eKvFormat::JSON_LINES) {
+        AppendText(buffer, "\"msg\":");
+        AppendJsonString(buffer, msg);
+        AppendFields(buffer, format, fields...);
+        return;
+    }
+
+    const auto time_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    AppendRaw(buffer, static_cast<uint32_t>(0));  // size placeholder
+    AppendRaw(buffer, static_cast<int64_t>(time_ns));
+    AppendRaw(buffer, static_cast<uint8_t>(level));
+    const auto num_fields_offset = buffer.size();
+    AppendRaw(buffer, static_cast<uint8_t>(0));  // num-fields placeholder
+    AppendBinaryString(buffer, msg);
+    const auto num_fields = AppendFields(buffer, format, fields...);
+    const auto record_size = static_cast<uint32_t>(buffer.size());
+    std::memcpy(buffer.data(), &record_size, sizeof(record_size));
+    std::memcpy(buffer.data() + num_fields_offset, &num_fields,
+                sizeof(num_fields));
+}
+
+}  // namespace kv
+
+}  // namespace utils
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <utils/perlin_noise.hpp>
+#include <utils/thread_pool.hpp>
+
+namespace utils {
+
+/// Noise sampled on a regular grid of unbounded extent, e.g. the heightmap of
+/// a streaming world. The grid is split into square chunks, which are
+/// generated on demand (with the batch API of the generator) and kept in a
+/// cache of bounded size, evicting the least recently used chunks first. So
+/// queries of regions that were already visited are just memory lookups, e.g.
+///
+///     NoiseField terrain(PerlinNoiseGenerator(42), 0.5F);
+///     terrain.Prefetch(player.x(), player.y());
+///     const auto height = terrain.Sample(player.x(), player.y());
+///
+/// All methods can be called concurrently from several threads
+class UTILS_API NoiseField {
+    DEFINE_SMART_POINTERS(NoiseField)
+
+    NO_COPY_NO_MOVE_NO_ASSIGN(NoiseField)
+
+ public:
+    /// Default number of cells per side of a chunk
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64;
+    /// Default maximum number of chunks kept in the cache
+    static constexpr size_t DEFAULT_MAX_CHUNKS = 256;
+
+    /// Creates a field that samples the given generator every spacing units,
+    /// generating chunks of chunk_size x chunk_size cells (prefetched chunks
+    /// are generated by the shared thread pool)
+    explicit NoiseField(const PerlinNoiseGenerator& generator,
+                        float spacing = 1.0F,
+                        size_t chunk_size = DEFAULT_CHUNK_SIZE,
+                        size_t max_chunks = DEFAULT_MAX_CHUNKS);
+
+    /// Same as above, but prefetched chunks are generated by the given pool
+    /// (which must outlive the field)
+    NoiseField(const PerlinNoiseGenerator& generator, float spacing,
+               size_t chunk_size, size_t max_chunks, ThreadPool& pool);
+
+    /// Returns the noise at the given position, interpolated (bilinearly)
+    /// from the samples of the cell that contains it. Generates the chunk of
+    /// the cell first if it's not cached (or waits for it, if prefetching)
+    auto Sample(float x, float y) -> float;
+
+    /// Returns the interpolated noise at the given position
+    auto Sample(const Vec2& xy) -> float;
+
+    /// Queues the generation of the chunks around the one that contains the
+    /// given position (up to radius chunks away along each axis) that aren't
+    /// cached yet, and returns without waiting for them
+    auto Prefetch(float x, float y, size_t radius = 1) -> void;
+
+    /// Drops all the cached chunks
+    auto Clear() -> void;
+
+    /// Returns the number of chunks in the cache (including the ones being
+    /// generated)
+    UTILS_NODISCARD auto num_cached_chunks() const -> size_t;
+
+    /// Returns the number of queries served from chunks already in the cache
+    UTILS_NODISCARD auto num_hits() const -> size_t {
+        return m_NumHits.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the number of queries whose chunk wasn't in the cache
+    UTILS_NODISCARD auto num_misses() const -> size_t {
+        return m_NumMisses.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the distance between the samples of the field
+    UTILS_NODISCARD auto spacing() const -> float { return m_Spacing; }
+
+    /// Returns the number of cells per side of a chunk
+    UTILS_NODISCARD auto chunk_size() const -> size_t { return m_ChunkSize; }
+
+    /// Returns the maximum number of chunks kept in the cache
+    UTILS_NODISCARD auto max_chunks() const -> size_t { return m_MaxChunks; }
+
+ private:
+    /// Chunk of the field, with (chunk_size + 1)^2 samples (neighboring
+    /// chunks share their border samples, so any cell can be interpolated
+    /// from a single chunk)
+    struct Chunk {
+        /// Coordinates of the chunk (in chunks)
+        int32_t x = 0;
+        int32_t y = 0;
+        /// Makes sure the chunk is generated just once (by whoever needs it
+        /// first, either a query or the prefetch task)
+        std::once_flag generated;
+        /// Samples of the chunk (row-major)
+        std::vector<float> values;
+    };
+
+    /// Settings used to generate the chunks (shared with the prefetch tasks,
+    /// which may outlive the field)
+    struct Source {
+        PerlinNoiseGenerator generator;
+        float spacing;
+        size_t chunk_size;
+    };
+
+    /// Returns the chunk at the given coordinates, adding it to the cache
+    /// (without generating it) if it's not there
+    auto _GetChunk(int32_t chunk_x, int32_t chunk_y, bool* is_new)
+        -> std::shared_ptr<Chunk>;
+
+    /// Generates the samples of the chunk (if not generated yet)
+    static auto _Generate(const Source& source, Chunk& chunk) -> void;
+
+    /// Returns the key of the chunk at the given coordinates
+    static auto _Key(int32_t chunk_x, int32_t chunk_y) -> uint64_t;
+
+    /// Returns floor(value / divisor), for a positive divisor
+    static auto _FloorDiv(int64_t value, int64_t divisor) -> int64_t;
+
+ private:
+    /// Distance between the samples of the field
+    float m_Spacing = 1.0F;
+    /// Number of cells per side of a chunk
+    size_t m_ChunkSize = DEFAULT_CHUNK_SIZE;
+    /// Maximum number of chunks kept in the cache
+    size_t m_MaxChunks = DEFAULT_MAX_CHUNKS;
+    /// Settings used to generate the chunks
+    std::shared_ptr<const Source> m_Source;
+    /// Pool used to generate the prefetched chunks
+    ThreadPool* m_Pool = nullptr;
+    /// Cached chunks, from the most to the least recently used
+    std::list<std::shared_ptr<Chunk>> m_Chunks;
+    /// Position in the list of each cached chunk
+    std::unordered_map<uint64_t, std::list<std::shared_ptr<Chunk>>::iterator>
+        m_ChunksIndex;
+    /// Lock protecting the cache
+    mutable std::mutex m_Mutex;
+    /// Statistics of the queries
+    std::atomic<size_t> m_NumHits{0};
+    std::atomic<size_t> m_NumMisses{0};
+};
+
+}  // namespace utils
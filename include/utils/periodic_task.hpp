@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <utils/timing.hpp>
+
+namespace utils {
+
+/// Histogram of durations (in seconds) with fixed-width buckets, plus an
+/// overflow bucket. Written by a single thread, readable from any thread
+class UTILS_API LatencyHistogram {
+    NO_COPY_NO_MOVE_NO_ASSIGN(LatencyHistogram)
+
+ public:
+    /// Default width of each bucket (in seconds)
+    static constexpr double DEFAULT_BUCKET_WIDTH = 10e-6;
+    /// Default number of buckets (not counting the overflow bucket)
+    static constexpr size_t DEFAULT_NUM_BUCKETS = 100;
+
+    explicit LatencyHistogram(double bucket_width = DEFAULT_BUCKET_WIDTH,
+                              size_t num_buckets = DEFAULT_NUM_BUCKETS);
+
+    /// Adds a sample (negative values are counted in the first bucket)
+    auto Push(double value) -> void;
+
+    /// Drops all samples
+    auto Reset() -> void;
+
+    /// Returns an upper bound of the given quantile (0 if there's no samples),
+    /// with the resolution of a bucket
+    UTILS_NODISCARD auto Quantile(double quantile) const -> double;
+
+    /// Returns the number of samples in the given bucket (the one at index
+    /// num_buckets() is the overflow bucket)
+    UTILS_NODISCARD auto bucket(size_t index) const -> uint64_t;
+
+    /// Returns the number of buckets (not counting the overflow bucket)
+    UTILS_NODISCARD auto num_buckets() const -> size_t { return m_NumBuckets; }
+
+    /// Returns the width of each bucket (in seconds)
+    UTILS_NODISCARD auto bucket_width() const -> double {
+        return m_BucketWidth;
+    }
+
+    /// Returns the total number of samples
+    UTILS_NODISCARD auto count() const -> uint64_t {
+        return m_Count.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the largest sample seen so far
+    UTILS_NODISCARD auto max() const -> double {
+        return m_Max.load(std::memory_order_relaxed);
+    }
+
+ private:
+    /// Width of each bucket (in seconds)
+    double m_BucketWidth = DEFAULT_BUCKET_WIDTH;
+    /// Number of buckets (not counting the overflow bucket)
+    size_t m_NumBuckets = DEFAULT_NUM_BUCKETS;
+    /// Counts of each bucket (plus the overflow bucket at the end)
+    std::unique_ptr<std::atomic<uint64_t>[]> m_Buckets;
+    /// Total number of samples
+    std::atomic<uint64_t> m_Count{0};
+    /// Largest sample seen so far
+    std::atomic<double> m_Max{0.0};
+};
+
+/// Options used to configure a periodic task
+struct UTILS_API PeriodicTaskOptions {
+    /// Name of the task (also used as the name of its clock-event)
+    std::string name = "periodic_task";
+    /// Period of the task (in seconds)
+    double period = 0.001;
+    /// CPU the thread of the task is pinned to (-1 to leave it unpinned)
+    int cpu = -1;
+    /// Real-time priority (SCHED_FIFO) of the thread (0 to keep the default)
+    int rt_priority = 0;
+    /// Width of the buckets of the latency and jitter histograms (in seconds)
+    double histogram_bucket_width = LatencyHistogram::DEFAULT_BUCKET_WIDTH;
+    /// Number of buckets of the latency and jitter histograms
+    size_t histogram_num_buckets = LatencyHistogram::DEFAULT_NUM_BUCKETS;
+};
+
+/// Runs a callback periodically on its own thread, waking up at absolute
+/// deadlines (clock_nanosleep with TIMER_ABSTIME on Linux) so that errors
+/// don't accumulate over time. Keeps track of the wake-up latency (time past
+/// the deadline), the jitter of the period, and of the deadlines that were
+/// missed because the callback overran its period.
+///
+/// Each run of the callback is recorded in the clock of the task (an event
+/// with the name of the task), so it shows up in Clock::Snapshot()
+class UTILS_API PeriodicTask {
+    DEFINE_SMART_POINTERS(PeriodicTask)
+
+    NO_COPY_NO_MOVE_NO_ASSIGN(PeriodicTask)
+
+ public:
+    /// Callback executed once every period
+    using Callback = std::function<void()>;
+
+    PeriodicTask(Callback callback, PeriodicTaskOptions options);
+
+    /// Stops the task (if running) and waits for its thread to finish
+    ~PeriodicTask();
+
+    /// Starts the thread of the task (no-op if it's running already)
+    auto Start() -> void;
+
+    /// Requests the task to stop, and waits for its thread to finish
+    auto Stop() -> void;
+
+    /// Returns whether or not the task is running
+    UTILS_NODISCARD auto running() const -> bool {
+        return m_Running.load(std::memory_order_acquire);
+    }
+
+    /// Returns the options the task was created with
+    UTILS_NODISCARD auto options() const -> const PeriodicTaskOptions& {
+        return m_Options;
+    }
+
+    /// Returns the number of periods executed so far
+    UTILS_NODISCARD auto num_periods() const -> uint64_t {
+        return m_NumPeriods.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the number of periods in which the callback overran
+    UTILS_NODISCARD auto num_overruns() const -> uint64_t {
+        return m_NumOverruns.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the number of deadlines skipped due to overruns
+    UTILS_NODISCARD auto num_missed_deadlines() const -> uint64_t {
+        return m_NumMissedDeadlines.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the histogram of the wake-up latency (time past the deadline)
+    UTILS_NODISCARD auto latency() const -> const LatencyHistogram& {
+        return m_Latency;
+    }
+
+    /// Returns the histogram of the jitter (deviation of the time in between
+    /// consecutive wake-ups from the period)
+    UTILS_NODISCARD auto jitter() const -> const LatencyHistogram& {
+        return m_Jitter;
+    }
+
+    /// Returns the clock where the runs of the callback are recorded
+    UTILS_NODISCARD auto clock() const -> const Clock& { return m_Clock; }
+
+    /// Returns the handle of the event of the task in its clock
+    UTILS_NODISCARD auto event() const -> ClockEventHandle { return m_Event; }
+
+ private:
+    /// Main loop executed by the thread of the task
+    auto _Run() -> void;
+
+    /// Applies the CPU affinity and real-time priority to the calling thread
+    auto _ConfigureThread() -> void;
+
+    /// Sleeps until the given deadline (in nanoseconds, monotonic clock)
+    static auto _SleepUntil(int64_t deadline_ns) -> void;
+
+ private:
+    /// Callback executed once every period
+    Callback m_Callback;
+    /// Options of the task
+    PeriodicTaskOptions m_Options;
+    /// Period of the task (in nanoseconds)
+    int64_t m_PeriodNs = 0;
+    /// Thread where the task runs
+    std::thread m_Thread;
+    /// Whether or not the task is running
+    std::atomic<bool> m_Running{false};
+    /// Number of periods executed so far
+    std::atomic<uint64_t> m_NumPeriods{0};
+    /// Number of periods in which the callback overran
+    std::atomic<uint64_t> m_NumOverruns{0};
+    /// Number of deadlines skipped due to overruns
+    std::atomic<uint64_t> m_NumMissedDeadlines{0};
+    /// Histogram of the wake-up latency
+    LatencyHistogram m_Latency;
+    /// Histogram of the jitter of the period
+    LatencyHistogram m_Jitter;
+    /// Clock where the runs of the callback are recorded (owned by the
+    /// thread of the task)
+    Clock m_Clock;
+    /// Handle of the event of the task
+    ClockEventHandle m_Event;
+};
+
+}  // namespace utils
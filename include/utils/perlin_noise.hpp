@@ -1,39 +1,56 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <memory>
-#include <random>
 #include <utility>
 #include <vector>
 
 #include <math/vec2_t.hpp>
+#include <math/vec3_t.hpp>
 
 #include <utils/logging.hpp>
+#include <utils/simd.hpp>
+#include <utils/thread_pool.hpp>
 
 namespace utils {
 
 using Vec2 = ::math::Vector2<float>;
+using Vec3 = ::math::Vector3<float>;
 
-class UTILS_API PerlinNoise {
- public:
-    /// Initializes the perlin-noise generator module(singleton)
-    static auto Init() -> void;
-
-    /// Releases perlin-noise generator module's resources
-    static auto Release() -> void;
-
-    /// Configures the noise-generator with the given settings
-    static auto Config(size_t num_octaves, float persistance, float lacunarity,
-                       float noise_scale) -> void;
-
-    /// Returns the noise value at a given 1d position
-    static auto Sample1d(float x_val) -> float;
+/// Kinds of gradient-noise that the generators can evaluate
+enum class eNoiseType {
+    /// Perlin-noise (ken perlin's improved noise), which blends the gradients
+    /// of the 2^N corners of a cell of a square lattice
+    PERLIN,
+    /// Simplex-noise, which blends the gradients of just the N + 1 corners of
+    /// a simplex (much cheaper in 3d and 4d, and without axis-aligned
+    /// artifacts)
+    SIMPLEX,
+};
 
-    /// Returns the noise value at a given 2d position
-    static auto Sample2d(float x, float y) -> float;
+/// Noise value at a given 2d position, along with its gradient (the partial
+/// derivatives of the noise with respect to x and y)
+struct NoiseSample2d {
+    /// Value of the noise
+    float value;
+    /// Gradient of the noise (e.g. to compute slopes and normals of terrain)
+    Vec2 gradient;
+};
 
-    /// Returns the noise value at the given 2d position
-    static auto Sample2d(const Vec2& xy) -> float;
+class DomainWarp;
 
+/// Perlin-noise generator with fixed settings. Generators are immutable (all
+/// of their state is set on construction) and copies don't share anything, so
+/// any number of threads can sample from the same generator concurrently. To
+/// use different settings, just create another generator, e.g.
+///
+///     const PerlinNoiseGenerator terrain(42, 6, 0.5F, 2.0F, 50.0F);
+///     const auto height = terrain.Sample2d(x, y);
+class UTILS_API PerlinNoiseGenerator {
+ public:
+    /// Default seed of the noise-generator
+    static constexpr uint32_t DEFAULT_SEED = 0;
     /// Default min-range for uniform distribution
     static constexpr float DEFAULT_RAND_MIN = -1e4F;
     /// Default max-range for uniform distribution
@@ -46,37 +63,266 @@ class UTILS_API PerlinNoise {
     static constexpr float DEFAULT_LACUNARITY = 2.0F;
     /// Default noise-scale setting of the noise generator
     static constexpr float DEFAULT_NOISE_SCALE = 10.0F;
+    /// Size (in samples per side) of the tiles used by the parallel batch API
+    static constexpr size_t GRID_TILE_SIZE = 128;
+    /// Number of entries of the permutation table (256 entries, doubled to
+    /// avoid wrapping the indices of the corners)
+    static constexpr size_t PERM_TABLE_SIZE = 512;
+    /// Number of points sampled per batch by SamplePoints2d (and per task of
+    /// its parallel version)
+    static constexpr size_t POINTS_BATCH_SIZE = 4096;
 
- private:
-    /// Configures the noise-generator with the given settings
-    auto _Config(size_t num_octaves, float persistance, float lacunarity,
-                 float noise_scale) -> void;
+    /// Creates a generator with the given settings. The seed selects both the
+    /// permutation table and the offsets of the octaves, and generators
+    /// created with the same settings produce exactly the same noise
+    explicit PerlinNoiseGenerator(uint32_t seed = DEFAULT_SEED,
+                                  size_t num_octaves = DEFAULT_NUM_OCTAVES,
+                                  float persistance = DEFAULT_PERSISTANCE,
+                                  float lacunarity = DEFAULT_LACUNARITY,
+                                  float noise_scale = DEFAULT_NOISE_SCALE);
+
+    /// Returns a copy of this generator whose 2d perlin-noise repeats every
+    /// period units along x and y (zero disables it along an axis), e.g. for
+    /// seamless textures. Each octave wraps its lattice after period * freq /
+    /// noise_scale cells, so the tiling is seamless when these are integers
+    /// (i.e. a period multiple of the noise-scale, and an integer lacunarity),
+    /// otherwise each octave is rounded to the nearest integer period. Only
+    /// the 2d perlin-noise is periodic (3d, 4d and simplex-noise aren't)
+    UTILS_NODISCARD auto WithPeriod(const Vec2& period) const
+        -> PerlinNoiseGenerator;
 
     /// Returns the noise value at a given 1d position
-    auto _Sample1d(float x) -> float;
+    UTILS_NODISCARD auto Sample1d(float x) const -> float;
 
     /// Returns the noise value at a given 2d position
-    auto _Sample2d(float x, float y) -> float;
+    UTILS_NODISCARD auto Sample2d(float x, float y,
+                                  eNoiseType type = eNoiseType::PERLIN) const
+        -> float;
+
+    /// Returns the noise value at the given 2d position
+    UTILS_NODISCARD auto Sample2d(const Vec2& xy,
+                                  eNoiseType type = eNoiseType::PERLIN) const
+        -> float;
+
+    /// Returns the perlin-noise value at a given 2d position, and its analytic
+    /// gradient (the derivative of the fade-interpolated noise, summed across
+    /// all the octaves). The value is the same as the one from Sample2d
+    UTILS_NODISCARD auto Sample2dWithGradient(float x, float y) const
+        -> NoiseSample2d;
+
+    /// Returns the perlin-noise value and its gradient at a given 2d position
+    UTILS_NODISCARD auto Sample2dWithGradient(const Vec2& xy) const
+        -> NoiseSample2d;
+
+    /// Returns the noise value at a given 3d position
+    UTILS_NODISCARD auto Sample3d(float x, float y, float z,
+                                  eNoiseType type = eNoiseType::PERLIN) const
+        -> float;
+
+    /// Returns the noise value at the given 3d position
+    UTILS_NODISCARD auto Sample3d(const Vec3& xyz,
+                                  eNoiseType type = eNoiseType::PERLIN) const
+        -> float;
+
+    /// Returns the noise value at a given 4d position (e.g. a 3d position and
+    /// time, for animated volumes)
+    UTILS_NODISCARD auto Sample4d(float x, float y, float z, float w,
+                                  eNoiseType type = eNoiseType::PERLIN) const
+        -> float;
+
+    /// Fills a row-major grid of width x height noise values, where the value
+    /// at row i and column j is sampled at origin + (j * spacing.x, i *
+    /// spacing.y). The output buffer must hold at least width * height values
+    auto SampleGrid2d(const Vec2& origin, const Vec2& spacing, size_t width,
+                      size_t height, float* out,
+                      eNoiseType type = eNoiseType::PERLIN) const -> void;
+
+    /// Same as above, but splits the grid into square tiles which are sampled
+    /// in parallel by the threads of the given pool (results are the same as
+    /// the ones of the sequential version)
+    auto SampleGrid2d(const Vec2& origin, const Vec2& spacing, size_t width,
+                      size_t height, float* out, ThreadPool& pool,
+                      eNoiseType type = eNoiseType::PERLIN) const -> void;
+
+    /// Fills the perlin-noise values of count arbitrary 2d points, given by
+    /// their coordinates xs and ys. Same values as Sample2d, but evaluated in
+    /// batches with the vectorized kernels. The output must not overlap xs or
+    /// ys, as samples are written while later coordinates are still being read
+    auto SamplePoints2d(size_t count, const float* xs, const float* ys,
+                        float* out) const -> void;
+
+    /// Same as above (with the same no-aliasing rule), sampling batches of
+    /// points in parallel
+    auto SamplePoints2d(size_t count, const float* xs, const float* ys,
+                        float* out, ThreadPool& pool) const -> void;
+
+    /// Same as SampleGrid2d (perlin-noise only), but the position of each
+    /// sample is displaced by the given domain-warp first. The warp and the
+    /// noise are evaluated for a whole row of the grid at once, with the same
+    /// vectorized kernels as SamplePoints2d
+    auto SampleGrid2dWarped(const DomainWarp& warp, const Vec2& origin,
+                            const Vec2& spacing, size_t width, size_t height,
+                            float* out) const -> void;
+
+    /// Same as above, sampling the tiles of the grid in parallel
+    auto SampleGrid2dWarped(const DomainWarp& warp, const Vec2& origin,
+                            const Vec2& spacing, size_t width, size_t height,
+                            float* out, ThreadPool& pool) const -> void;
+
+    /// Same as SampleGrid2d (perlin-noise only), but also fills the partial
+    /// derivatives of the noise along x and y (same layout as the values),
+    /// all of them computed in a single pass over the grid
+    auto SampleGrid2dWithGradient(const Vec2& origin, const Vec2& spacing,
+                                  size_t width, size_t height, float* out,
+                                  float* out_grad_x, float* out_grad_y) const
+        -> void;
+
+    /// Same as above, sampling the tiles of the grid in parallel
+    auto SampleGrid2dWithGradient(const Vec2& origin, const Vec2& spacing,
+                                  size_t width, size_t height, float* out,
+                                  float* out_grad_x, float* out_grad_y,
+                                  ThreadPool& pool) const -> void;
+
+    /// Fills a grid of width x height x depth noise values, stored as depth
+    /// consecutive 2d grids (slices). The value at slice k, row i and column j
+    /// is sampled at origin + (j * spacing.x, i * spacing.y, k * spacing.z)
+    auto SampleGrid3d(const Vec3& origin, const Vec3& spacing, size_t width,
+                      size_t height, size_t depth, float* out,
+                      eNoiseType type = eNoiseType::PERLIN) const -> void;
+
+    /// Same as above, sampling the tiles of each slice in parallel
+    auto SampleGrid3d(const Vec3& origin, const Vec3& spacing, size_t width,
+                      size_t height, size_t depth, float* out,
+                      ThreadPool& pool,
+                      eNoiseType type = eNoiseType::PERLIN) const -> void;
+
+    /// Fills a 3d grid (same layout as SampleGrid3d) with 4d noise, sampled at
+    /// the given fourth coordinate w (e.g. the time of an animated volume)
+    auto SampleGrid4d(const Vec3& origin, const Vec3& spacing, float w,
+                      size_t width, size_t height, size_t depth, float* out,
+                      eNoiseType type = eNoiseType::PERLIN) const -> void;
+
+    /// Same as above, sampling the tiles of each slice in parallel
+    auto SampleGrid4d(const Vec3& origin, const Vec3& spacing, float w,
+                      size_t width, size_t height, size_t depth, float* out,
+                      ThreadPool& pool,
+                      eNoiseType type = eNoiseType::PERLIN) const -> void;
+
+    /// Fills count noise values, sampled at origin + i * spacing
+    auto SampleGrid1d(float origin, float spacing, size_t count,
+                      float* out) const -> void;
+
+    /// Returns the seed used to create this generator
+    UTILS_NODISCARD auto seed() const -> uint32_t { return m_Seed; }
+
+    /// Returns the number of octaves of this generator
+    UTILS_NODISCARD auto num_octaves() const -> size_t { return m_NumOctaves; }
+
+    /// Returns the persistance setting of this generator
+    UTILS_NODISCARD auto persistance() const -> float { return m_Persistance; }
+
+    /// Returns the lacunarity setting of this generator
+    UTILS_NODISCARD auto lacunarity() const -> float { return m_Lacunarity; }
+
+    /// Returns the noise-scale setting of this generator
+    UTILS_NODISCARD auto noise_scale() const -> float { return m_NoiseScale; }
+
+    /// Returns the period of the 2d noise of this generator (zero if it isn't
+    /// periodic along an axis)
+    UTILS_NODISCARD auto period() const -> Vec2 { return m_Period; }
+
+    /// Returns the (doubled) permutation table drawn from the seed
+    UTILS_NODISCARD auto permutations() const
+        -> const std::array<uint8_t, PERM_TABLE_SIZE>& {
+        return m_Permutations;
+    }
+
+ private:
+    /// Batch of samples, laid out as a 3d grid (2d grids have a single slice)
+    /// at a fixed fourth coordinate
+    struct GridDesc {
+        /// Position of the first sample, along x, y, z and w
+        float origin[4];  // NOLINT
+        /// Distance between samples along x, y and z
+        float spacing[3];  // NOLINT
+        /// Number of samples along x, y and z
+        size_t width;
+        size_t height;
+        size_t depth;
+        /// Number of dimensions of the noise (2, 3 or 4)
+        size_t num_dims;
+        /// Kind of noise to evaluate
+        eNoiseType type;
+        /// Output buffer (width * height * depth values)
+        float* out;
+        /// Output buffers of the gradient (only for 2d perlin-noise, and
+        /// nullptr if the gradient isn't requested)
+        float* out_grad_x;
+        float* out_grad_y;
+        /// Domain-warp applied to the samples (only for 2d perlin-noise, and
+        /// nullptr if the grid isn't warped)
+        const DomainWarp* warp;
+    };
+
+    /// Period of the lattice of an octave, in cells (zero if not periodic)
+    struct OctavePeriod {
+        int32_t x;
+        int32_t y;
+    };
+
+    /// Fills the given grid, splitting it into tiles sampled by the threads of
+    /// the given pool (or sampled sequentially if there's no pool)
+    auto _SampleGrid(const GridDesc& grid, ThreadPool* pool) const -> void;
+
+    /// Fills the rows [row_begin, row_end) and columns [col_begin, col_end) of
+    /// the given slice of a grid
+    auto _SampleGridTile(const GridDesc& grid, size_t slice, size_t row_begin,
+                         size_t row_end, size_t col_begin,
+                         size_t col_end) const -> void;
+
+    /// Fills the rows [row_begin, row_end) and columns [col_begin, col_end) of
+    /// a warped grid, a row at a time
+    auto _SampleGridWarpedTile(const GridDesc& grid, size_t row_begin,
+                               size_t row_end, size_t col_begin,
+                               size_t col_end) const -> void;
+
+    /// Fills the values of a batch of (at most POINTS_BATCH_SIZE) points
+    auto _SamplePointsBatch(size_t count, const float* xs, const float* ys,
+                            float* out) const -> void;
+
+    /// Returns the period of the lattice of the given octave
+    auto _GetOctavePeriod(size_t octave) const -> OctavePeriod;
 
-    /// Computes the perlin-function at a given 2d position
-    auto _Perlin(float x, float y) -> float;
+    /// Computes the perlin-function at a given 2d position, for the given
+    /// octave (which selects the period of the lattice)
+    auto _Perlin(float x, float y, size_t octave) const -> float;
+
+    /// Computes the perlin-function and its gradient at a given 2d position
+    auto _PerlinWithGradient(float x, float y, size_t octave, float* grad_x,
+                             float* grad_y) const -> float;
+
+    /// Computes the lattice index of a cell and the one of the next cell,
+    /// wrapped by the given period (if any) and by the size of the table
+    static auto _LatticeIndex(float cell, int32_t period, int32_t* index,
+                              int32_t* index_next) -> void;
 
     /// Computes the product with the gradient at a given point (perlin-noise
     /// helper function)
-    static auto _DotGrad(size_t hash, float x, float y) -> float;
+    static auto _DotGrad(int32_t hash, float x, float y) -> float;
 
     /// Computes the fade-function (perlin-noise helper-function)
     static auto _Fade(float t) -> float;
 
+    /// Computes the derivative of the fade-function
+    static auto _FadeDerivative(float t) -> float;
+
     /// Computes the lerp-function (perlin-noise helper function)
     static auto _Lerp(float a, float b, float t) -> float;
 
  private:
-    // @todo(wilbert): The static-var below are not actually accessible, but
-    // could should think about it making it const? (will disable lint for now)
-
-    /// Handle to instance of the noise-generator module(singleton)
-    static std::unique_ptr<PerlinNoise> s_Instance;  // NOLINT
+    /// Seed used to shuffle the permutation table and to generate the random
+    /// offsets of the octaves
+    uint32_t m_Seed = DEFAULT_SEED;
     /// Number of octaves used for the noise generator
     size_t m_NumOctaves = DEFAULT_NUM_OCTAVES;
     /// Persistance parameter for the noise generator
@@ -85,14 +331,154 @@ class UTILS_API PerlinNoise {
     float m_Lacunarity = DEFAULT_LACUNARITY;
     /// Scaler for the generated noise
     float m_NoiseScale = DEFAULT_NOISE_SCALE;
-    /// Permutations used for noise generation
-    std::vector<size_t> m_Permutations;
+    /// Permutations used for noise generation. Stored inline as bytes, so the
+    /// whole table takes just a few cache lines (and copies of the generator
+    /// don't share it)
+    std::array<uint8_t, PERM_TABLE_SIZE> m_Permutations{};
+    /// Random offset of an octave, along each axis
+    struct OctaveOffset {
+        float x;
+        float y;
+        float z;
+        float w;
+    };
     /// Random offsets used for noise generation
-    std::vector<Vec2> m_OctavesOffsets;
-    /// Create C++ random-engine
-    std::default_random_engine m_RandEngine;
-    /// Create C++ uniform real distribution
-    std::uniform_real_distribution<float> m_RandUnifDist;
+    std::vector<OctaveOffset> m_OctavesOffsets;
+    /// Period of the 2d noise (zero if not periodic along an axis)
+    Vec2 m_Period = Vec2(0.0F, 0.0F);
+    /// Periods of the lattice of each octave (empty if not periodic)
+    std::vector<OctavePeriod> m_OctavesPeriods;
+};
+
+/// Domain-warp, i.e. a chain of stages that displace positions by noise before
+/// these are sampled (e.g. for the folds and ridges of eroded terrain). Each
+/// stage displaces a position p by amplitude * (n(p), n(p + WARP_SHIFT)),
+/// where n is the noise of the stage's generator. Warps are immutable, and
+/// stages are composed by chaining them, e.g.
+///
+///     const auto warp = DomainWarp().Then(coarse, 4.0F).Then(detail, 1.0F);
+///     terrain.SampleGrid2dWarped(warp, origin, spacing, width, height, out);
+class UTILS_API DomainWarp {
+ public:
+    /// Shift along x of the samples used for the displacement along y
+    static constexpr float WARP_SHIFT_X = 5.2F;
+    /// Shift along y of the samples used for the displacement along y
+    static constexpr float WARP_SHIFT_Y = 1.3F;
+
+    /// Returns a copy of this warp with an extra stage at the end, which uses
+    /// (a copy of) the given generator
+    UTILS_NODISCARD auto Then(const PerlinNoiseGenerator& generator,
+                              float amplitude) const -> DomainWarp;
+
+    /// Returns the warped position of a single point
+    UTILS_NODISCARD auto Warp(float x, float y) const -> Vec2;
+
+    /// Warps count points in place, evaluating each stage over the whole batch
+    /// with PerlinNoiseGenerator::SamplePoints2d
+    auto WarpPoints(size_t count, float* xs, float* ys) const -> void;
+
+    /// Returns the number of stages of this warp
+    UTILS_NODISCARD auto num_stages() const -> size_t {
+        return m_Stages.size();
+    }
+
+ private:
+    /// Stage of the warp: a generator, and the amplitude of its displacement
+    struct Stage {
+        PerlinNoiseGenerator generator;
+        float amplitude;
+    };
+
+    /// Stages of the warp, applied in order
+    std::vector<Stage> m_Stages;
+};
+
+/// Module-level perlin-noise API, which samples from a default generator
+/// (owned by the module). Reconfiguring the module replaces that generator,
+/// so it shouldn't be done while other threads are sampling from the module.
+/// Subsystems that need their own settings (or sample from several threads
+/// while others reconfigure) should use their own PerlinNoiseGenerator
+class UTILS_API PerlinNoise {
+ public:
+    /// Initializes the perlin-noise generator module(singleton)
+    static auto Init() -> void;
+
+    /// Releases perlin-noise generator module's resources
+    static auto Release() -> void;
+
+    /// Configures the noise-generator with the given settings (keeping the
+    /// current seed)
+    static auto Config(size_t num_octaves, float persistance, float lacunarity,
+                       float noise_scale) -> void;
+
+    /// Replaces the default generator of the module by a copy of the given one
+    static auto SetGenerator(const PerlinNoiseGenerator& generator) -> void;
+
+    /// Returns the default generator of the module
+    static auto GetGenerator() -> const PerlinNoiseGenerator&;
+
+    /// Returns the noise value at a given 1d position
+    static auto Sample1d(float x_val) -> float;
+
+    /// Returns the noise value at a given 2d position
+    static auto Sample2d(float x, float y) -> float;
+
+    /// Returns the noise value at the given 2d position
+    static auto Sample2d(const Vec2& xy) -> float;
+
+    /// Returns the noise value at a given 2d position, and its gradient
+    static auto Sample2dWithGradient(float x, float y) -> NoiseSample2d;
+
+    /// Fills a row-major grid of width x height noise values, where the value
+    /// at row i and column j is sampled at origin + (j * spacing.x, i *
+    /// spacing.y). The output buffer must hold at least width * height values
+    static auto SampleGrid2d(const Vec2& origin, const Vec2& spacing,
+                             size_t width, size_t height, float* out) -> void;
+
+    /// Same as above, but splits the grid into square tiles which are sampled
+    /// in parallel by the threads of the given pool (results are the same as
+    /// the ones of the sequential version)
+    static auto SampleGrid2d(const Vec2& origin, const Vec2& spacing,
+                             size_t width, size_t height, float* out,
+                             ThreadPool& pool) -> void;
+
+    /// Fills count noise values, sampled at origin + i * spacing
+    static auto SampleGrid1d(float origin, float spacing, size_t count,
+                             float* out) -> void;
+
+    /// Selects the instruction set used by the batch API of all generators
+    /// (defaults to the best one supported by the cpu). Unsupported ones fall
+    /// back to the default
+    static auto SetSimdLevel(eSimdLevel level) -> void;
+
+    /// Returns the instruction set used by the batch API
+    static auto GetSimdLevel() -> eSimdLevel;
+
+    /// Default min-range for uniform distribution
+    static constexpr float DEFAULT_RAND_MIN =
+        PerlinNoiseGenerator::DEFAULT_RAND_MIN;
+    /// Default max-range for uniform distribution
+    static constexpr float DEFAULT_RAND_MAX =
+        PerlinNoiseGenerator::DEFAULT_RAND_MAX;
+    /// Default number of octaves of the noise-generator
+    static constexpr size_t DEFAULT_NUM_OCTAVES =
+        PerlinNoiseGenerator::DEFAULT_NUM_OCTAVES;
+    /// Default persistance setting of the noise generator
+    static constexpr float DEFAULT_PERSISTANCE =
+        PerlinNoiseGenerator::DEFAULT_PERSISTANCE;
+    /// Default lacunarity setting of the noise generator
+    static constexpr float DEFAULT_LACUNARITY =
+        PerlinNoiseGenerator::DEFAULT_LACUNARITY;
+    /// Default noise-scale setting of the noise generator
+    static constexpr float DEFAULT_NOISE_SCALE =
+        PerlinNoiseGenerator::DEFAULT_NOISE_SCALE;
+
+ private:
+    // @todo(wilbert): The static-var below are not actually accessible, but
+    // could should think about it making it const? (will disable lint for now)
+
+    /// Handle to the default generator of the module(singleton)
+    static std::unique_ptr<PerlinNoiseGenerator> s_Instance;  // NOLINT
 };
 
 }  // namespace utils
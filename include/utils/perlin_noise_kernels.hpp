@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <utils/simd.hpp>
+
+// Row-kernels used by the batch API of the perlin-noise module. These are
+// internal building blocks (no argument validation), exposed in a separate
+// header so each instruction set can be tested against the scalar kernel
+
+namespace utils {
+namespace kernels {
+
+/// Lattice data of a row of a 2d grid, for a single octave. The data of each
+/// column is precomputed once per octave and shared by all the rows
+struct UTILS_API PerlinRowArgs {
+    /// Permutation table (512 entries, i.e. the 256-entry table twice)
+    const int32_t* perm;
+    /// Lattice index (wrapped to [0, 255]) of each column
+    const int32_t* cols_index;
+    /// Lattice index of the next cell of each column, i.e. cols_index + 1
+    /// (or wrapped to 0 at the end of the period, for periodic noise)
+    const int32_t* cols_index_next;
+    /// Position of each column relative to its lattice cell (in [0, 1))
+    const float* cols_frac;
+    /// Fade-curve evaluated at the relative position of each column
+    const float* cols_fade;
+    /// Lattice index (wrapped to [0, 255]) of the row
+    int32_t row_index;
+    /// Lattice index of the next cell of the row (same as cols_index_next)
+    int32_t row_index_next;
+    /// Position of the row relative to its lattice cell (in [0, 1))
+    float row_frac;
+    /// Fade-curve evaluated at the relative position of the row
+    float row_fade;
+    /// Amplitude of the octave
+    float ampl;
+    /// Number of columns
+    size_t width;
+    /// Output row, where ampl * noise is accumulated
+    float* out;
+};
+
+/// Accumulates one octave of 2d perlin-noise into a row (plain C++)
+UTILS_API auto PerlinRow2dScalar(const PerlinRowArgs& args) -> void;
+
+#if defined(UTILS_SIMD_X86)
+/// Accumulates one octave of 2d perlin-noise into a row (4 columns at once)
+UTILS_API auto PerlinRow2dSse2(const PerlinRowArgs& args) -> void;
+
+/// Accumulates one octave of 2d perlin-noise into a row (8 columns at once,
+/// using hardware gathers). Requires a cpu with AVX2
+UTILS_API auto PerlinRow2dAvx2(const PerlinRowArgs& args) -> void;
+#endif
+
+#if defined(UTILS_SIMD_NEON)
+/// Accumulates one octave of 2d perlin-noise into a row (4 columns at once)
+UTILS_API auto PerlinRow2dNeon(const PerlinRowArgs& args) -> void;
+#endif
+
+/// Accumulates one octave of 2d perlin-noise into a row, using the kernel of
+/// the given instruction set (which must be supported by the cpu)
+UTILS_API auto PerlinRow2d(eSimdLevel level, const PerlinRowArgs& args)
+    -> void;
+
+/// Lattice data of a batch of arbitrary 2d points (e.g. the warped positions
+/// of a grid), for a single octave. Same as PerlinRowArgs, but the data along
+/// y is given for each point too
+struct UTILS_API PerlinPointsArgs {
+    /// Permutation table (512 entries, i.e. the 256-entry table twice)
+    const int32_t* perm;
+    /// Lattice indices (wrapped to [0, 255]) of each point, along x and y
+    const int32_t* index_x;
+    const int32_t* index_y;
+    /// Lattice indices of the next cell of each point, along x and y
+    const int32_t* index_x_next;
+    const int32_t* index_y_next;
+    /// Position of each point relative to its lattice cell, along x and y
+    const float* frac_x;
+    const float* frac_y;
+    /// Fade-curve evaluated at the relative position of each point
+    const float* fade_x;
+    const float* fade_y;
+    /// Amplitude of the octave
+    float ampl;
+    /// Number of points
+    size_t count;
+    /// Output values, where ampl * noise is accumulated
+    float* out;
+};
+
+/// Accumulates one octave of 2d perlin-noise into a batch of points (plain
+/// C++)
+UTILS_API auto PerlinPoints2dScalar(const PerlinPointsArgs& args) -> void;
+
+#if defined(UTILS_SIMD_X86)
+/// Accumulates one octave of 2d perlin-noise into a batch of points (4 points
+/// at once)
+UTILS_API auto PerlinPoints2dSse2(const PerlinPointsArgs& args) -> void;
+
+/// Accumulates one octave of 2d perlin-noise into a batch of points (8 points
+/// at once, using hardware gathers). Requires a cpu with AVX2
+UTILS_API auto PerlinPoints2dAvx2(const PerlinPointsArgs& args) -> void;
+#endif
+
+#if defined(UTILS_SIMD_NEON)
+/// Accumulates one octave of 2d perlin-noise into a batch of points (4 points
+/// at once)
+UTILS_API auto PerlinPoints2dNeon(const PerlinPointsArgs& args) -> void;
+#endif
+
+/// Accumulates one octave of 2d perlin-noise into a batch of points, using the
+/// kernel of the given instruction set (which must be supported by the cpu)
+UTILS_API auto PerlinPoints2d(eSimdLevel level, const PerlinPointsArgs& args)
+    -> void;
+
+/// Lattice data of a row of a 2d grid for a single octave, extended with the
+/// data needed to also accumulate the analytic gradient of the noise
+struct UTILS_API PerlinRowGradArgs {
+    /// Lattice data of the row (the noise itself is accumulated into row.out)
+    PerlinRowArgs row;
+    /// Derivative of the fade-curve at the relative position of each column
+    const float* cols_fade_deriv;
+    /// Derivative of the fade-curve at the relative position of the row
+    float row_fade_deriv;
+    /// Derivative of the lattice position with respect to the sampled one,
+    /// i.e. the frequency of the octave over the noise-scale
+    float grad_scale;
+    /// Output rows, where ampl * grad_scale * d(noise)/dx (and dy) are
+    /// accumulated
+    float* out_grad_x;
+    float* out_grad_y;
+};
+
+/// Accumulates one octave of 2d perlin-noise and of its gradient into a row
+/// (plain C++, as it's meant to replace finite-differences, which need three
+/// or more full evaluations of the noise per sample)
+UTILS_API auto PerlinRow2dWithGradient(const PerlinRowGradArgs& args) -> void;
+
+/// Lattice data of a row of a 3d (or 4d) grid, for a single octave. The
+/// columns run along x, and the row is fixed along the remaining axes
+struct UTILS_API PerlinRowNdArgs {
+    /// Permutation table (512 entries, i.e. the 256-entry table twice)
+    const uint8_t* perm;
+    /// Lattice index (wrapped to [0, 255]) of each column
+    const int32_t* cols_index;
+    /// Position of each column relative to its lattice cell (in [0, 1))
+    const float* cols_frac;
+    /// Fade-curve evaluated at the relative position of each column
+    const float* cols_fade;
+    /// Lattice indices (wrapped to [0, 255]) of the row, along y, z and w
+    int32_t row_index[3];  // NOLINT
+    /// Position of the row relative to its lattice cell, along y, z and w
+    float row_frac[3];  // NOLINT
+    /// Fade-curve evaluated at the relative position of the row
+    float row_fade[3];  // NOLINT
+    /// Amplitude of the octave
+    float ampl;
+    /// Number of columns
+    size_t width;
+    /// Output row, where ampl * noise is accumulated
+    float* out;
+};
+
+/// Accumulates one octave of 3d perlin-noise into a row (w is ignored)
+UTILS_API auto PerlinRow3d(const PerlinRowNdArgs& args) -> void;
+
+/// Accumulates one octave of 4d perlin-noise into a row
+UTILS_API auto PerlinRow4d(const PerlinRowNdArgs& args) -> void;
+
+// Single-sample versions, used by the per-sample API (and by the batch API
+// for simplex-noise, as its skewed lattice can't be shared across a row)
+
+/// Returns 3d perlin-noise at the given position
+UTILS_API auto Perlin3d(const uint8_t* perm, float x, float y, float z)
+    -> float;
+
+/// Returns 4d perlin-noise at the given position
+UTILS_API auto Perlin4d(const uint8_t* perm, float x, float y, float z,
+                        float w) -> float;
+
+/// Returns 2d simplex-noise at the given position
+UTILS_API auto Simplex2d(const uint8_t* perm, float x, float y) -> float;
+
+/// Returns 3d simplex-noise at the given position
+UTILS_API auto Simplex3d(const uint8_t* perm, float x, float y, float z)
+    -> float;
+
+/// Returns 4d simplex-noise at the given position
+UTILS_API auto Simplex4d(const uint8_t* perm, float x, float y, float z,
+                         float w) -> float;
+
+}  // namespace kernels
+}  // namespace utils
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+
+#include <utils/timing.hpp>
+
+namespace utils {
+
+/// Default time (in nanoseconds) spent busy-waiting at the end of a precise
+/// sleep, to absorb the wake-up latency of the OS scheduler
+constexpr int64_t DEFAULT_SPIN_THRESHOLD_NS = 200000;
+
+/// Sleeps until the given time-stamp (as given by Clock::GetTimeStampNs()).
+/// Uses a coarse sleep for most of the interval, and spins during the last
+/// spin_threshold_ns nanoseconds to wake up as close as possible to deadline
+UTILS_API auto PreciseSleepUntil(
+    int64_t deadline_ns, int64_t spin_threshold_ns = DEFAULT_SPIN_THRESHOLD_NS)
+    -> void;
+
+/// Drives a simulation at a fixed time-step, decoupled from the rate at which
+/// the loop runs (accumulator approach). Usage:
+///
+///     FixedStepScheduler scheduler(0.001);
+///     while (running) {
+///         scheduler.Update([&](double dt) { sim.Step(dt); });
+///         render(scheduler.alpha());
+///         scheduler.WaitForNextStep();
+///     }
+class UTILS_API FixedStepScheduler {
+    DEFINE_SMART_POINTERS(FixedStepScheduler)
+
+ public:
+    /// Default maximum number of steps run in a single update
+    static constexpr size_t DEFAULT_MAX_CATCH_UP_STEPS = 5;
+
+    /// Creates a scheduler that runs steps of step_size seconds. If a clock is
+    /// given, each step is recorded in it as the event with the given name
+    explicit FixedStepScheduler(
+        double step_size,
+        size_t max_catch_up_steps = DEFAULT_MAX_CATCH_UP_STEPS,
+        Clock* clock = nullptr, const std::string& event_name = "fixed_step");
+
+    /// Runs as many fixed steps as the time elapsed since the last update
+    /// allows (at most max_catch_up_steps; the time for the rest is dropped).
+    /// Returns the number of steps that were run
+    template <typename StepFn>
+    auto Update(StepFn&& step_fn) -> size_t {
+        _Accumulate();
+        size_t num_steps = 0;
+        while (m_AccumulatorNs >= m_StepNs && num_steps < m_MaxCatchUpSteps) {
+            if (m_Clock != nullptr) {
+                m_Clock->Start(m_Event);
+            }
+            step_fn(m_StepSize);
+            if (m_Clock != nullptr) {
+                m_Clock->Stop(m_Event);
+            }
+            m_AccumulatorNs -= m_StepNs;
+            num_steps++;
+        }
+        _DropExcess();
+        m_NumSteps += num_steps;
+        return num_steps;
+    }
+
+    /// Sleeps until the next step is due, and records how late it woke up
+    auto WaitForNextStep() -> void;
+
+    /// Resets the accumulated time and the statistics
+    auto Reset() -> void;
+
+    /// Sets the time spent spinning at the end of each sleep
+    auto SetSpinThreshold(int64_t spin_threshold_ns) -> void {
+        m_SpinThresholdNs = spin_threshold_ns;
+    }
+
+    /// Returns the fixed time-step (in seconds)
+    UTILS_NODISCARD auto step_size() const -> double { return m_StepSize; }
+
+    /// Returns the fraction of a step left in the accumulator, in [0, 1), to
+    /// interpolate in between the last two states when rendering
+    UTILS_NODISCARD auto alpha() const -> double {
+        return static_cast<double>(m_AccumulatorNs) /
+               static_cast<double>(m_StepNs);
+    }
+
+    /// Returns the total number of steps run so far
+    UTILS_NODISCARD auto num_steps() const -> uint64_t { return m_NumSteps; }
+
+    /// Returns the number of steps skipped because of the catch-up limit
+    UTILS_NODISCARD auto num_dropped_steps() const -> uint64_t {
+        return m_NumDroppedSteps;
+    }
+
+    /// Returns the statistics of how late (in seconds) the scheduler woke up
+    /// with respect to the time the next step was due
+    UTILS_NODISCARD auto jitter() const -> const RollingStats& {
+        return m_Jitter;
+    }
+
+    /// Returns the maximum wake-up lateness (in seconds) seen so far
+    UTILS_NODISCARD auto max_jitter() const -> double { return m_MaxJitter; }
+
+ private:
+    /// Adds the time elapsed since the last update to the accumulator
+    auto _Accumulate() -> void;
+
+    /// Drops whole steps that couldn't be run due to the catch-up limit
+    auto _DropExcess() -> void;
+
+ private:
+    /// Fixed time-step (in seconds)
+    double m_StepSize = 0.0;
+    /// Fixed time-step (in nanoseconds)
+    int64_t m_StepNs = 0;
+    /// Maximum number of steps run in a single update
+    size_t m_MaxCatchUpSteps = DEFAULT_MAX_CATCH_UP_STEPS;
+    /// Time (in nanoseconds) not yet consumed by steps
+    int64_t m_AccumulatorNs = 0;
+    /// Time-stamp of the last update (in nanoseconds, 0 if none yet)
+    int64_t m_LastUpdateNs = 0;
+    /// Time spent spinning at the end of each sleep (in nanoseconds)
+    int64_t m_SpinThresholdNs = DEFAULT_SPIN_THRESHOLD_NS;
+    /// Total number of steps run so far
+    uint64_t m_NumSteps = 0;
+    /// Number of steps dropped due to the catch-up limit
+    uint64_t m_NumDroppedSteps = 0;
+    /// Statistics of the wake-up lateness (in seconds)
+    RollingStats m_Jitter;
+    /// Maximum wake-up lateness (in seconds)
+    double m_MaxJitter = 0.0;
+    /// Clock where the steps are recorded (optional)
+    Clock* m_Clock = nullptr;
+    /// Handle of the event used to record the steps
+    ClockEventHandle m_Event;
+};
+
+}  // namespace utils
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <utils/common.hpp>
+
+// Instruction sets the vectorized kernels can be compiled for. SSE2 and NEON
+// are part of the baseline of x86-64 and aarch64 respectively, whereas AVX2
+// kernels are compiled with per-function target attributes and selected at
+// runtime (so the library still runs on cpus without AVX2)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define UTILS_SIMD_X86
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+    #define UTILS_SIMD_NEON
+#endif
+
+#if defined(UTILS_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define UTILS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define UTILS_TARGET_AVX2
+#endif
+
+namespace utils {
+
+/// Instruction sets used by the vectorized kernels of the library
+enum class eSimdLevel : uint8_t {
+    /// Plain C++ (no intrinsics)
+    SCALAR,
+    /// 4-wide kernels (x86)
+    SSE2,
+    /// 8-wide kernels, with hardware gathers (x86)
+    AVX2,
+    /// 4-wide kernels (arm)
+    NEON,
+};
+
+/// Returns the best instruction set supported by the cpu we're running on
+UTILS_API auto GetSupportedSimdLevel() -> eSimdLevel;
+
+/// Returns whether or not the given instruction set can be used on this cpu
+UTILS_API auto IsSimdLevelSupported(eSimdLevel level) -> bool;
+
+/// Returns a readable name for the given instruction set
+UTILS_API auto ToString(eSimdLevel level) -> std::string;
+
+}  // namespace utils
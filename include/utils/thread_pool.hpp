@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <utils/common.hpp>
+
+namespace utils {
+
+/// Pool of worker threads with work-stealing. Each worker owns a queue of
+/// tasks: it takes tasks from the back of its own queue (the most recent ones,
+/// still hot in cache), and once it runs out of work it steals from the front
+/// of the queues of the other workers. The pool is meant to be created once
+/// and reused across calls, e.g.
+///
+///     ThreadPool pool(8);
+///     pool.ParallelFor(num_tiles, [&](size_t tile) { ProcessTile(tile); });
+///
+/// Tasks must not throw exceptions
+class UTILS_API ThreadPool {
+    DEFINE_SMART_POINTERS(ThreadPool)
+
+    NO_COPY_NO_MOVE_NO_ASSIGN(ThreadPool)
+
+ public:
+    /// Type of the tasks executed by the pool
+    using Task = std::function<void()>;
+
+    /// Creates a pool with the given number of workers. If zero, uses one
+    /// worker per hardware thread, minus one for the thread that calls
+    /// ParallelFor() (which also executes tasks while it waits)
+    explicit ThreadPool(size_t num_threads = 0);
+
+    /// Waits for the queued tasks to finish, and stops the workers
+    ~ThreadPool();
+
+    /// Queues a task to be executed by any of the workers
+    auto Submit(Task task) -> void;
+
+    /// Executes fn(i) for each i in [0, num_tasks), and returns once all of
+    /// them have finished. The calling thread executes tasks too
+    auto ParallelFor(size_t num_tasks, const std::function<void(size_t)>& fn)
+        -> void;
+
+    /// Returns the number of worker threads of the pool
+    UTILS_NODISCARD auto num_threads() const -> size_t {
+        return m_Workers.size();
+    }
+
+    /// Returns a pool shared by the whole process (created on first use, with
+    /// the default number of threads)
+    static auto GetDefault() -> ThreadPool&;
+
+ private:
+    /// Queue of tasks owned by a worker, and its thread
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    /// Adds a task to the queue of the given worker
+    auto _Push(size_t worker, Task task) -> void;
+
+    /// Takes the most recent task from the queue of the given worker
+    auto _PopLocal(size_t worker, Task& task) -> bool;
+
+    /// Takes the oldest task from the queue of any worker, starting with the
+    /// one after the given worker
+    auto _Steal(size_t start, Task& task) -> bool;
+
+    /// Wakes up the sleeping workers (after queueing tasks)
+    auto _WakeUp() -> void;
+
+    /// Loop of each worker thread
+    auto _Run(size_t worker) -> void;
+
+ private:
+    /// Workers of the pool
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+    /// Number of tasks queued (and not yet taken) across all workers
+    std::atomic<size_t> m_NumQueued{0};
+    /// Worker that receives the next submitted task (round-robin)
+    std::atomic<size_t> m_NextWorker{0};
+    /// Whether or not the workers should keep running
+    std::atomic<bool> m_Running{true};
+    /// Lock and condition variable used by the idle workers to sleep
+    std::mutex m_SleepMutex;
+    std::condition_variable m_SleepCondVar;
+};
+
+}  // namespace utils
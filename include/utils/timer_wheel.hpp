@@ -0,0 +1,210 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <utils/timing.hpp>
+
+namespace utils {
+
+/// Handle to a timer scheduled in a TimerWheel (used to cancel it)
+struct UTILS_API TimerHandle {
+    /// Index used to represent handles that don't point to any timer
+    static constexpr uint32_t INVALID_INDEX = 0xffffffff;
+
+    TimerHandle() = default;
+
+    TimerHandle(uint32_t p_index, uint32_t p_generation)
+        : index(p_index), generation(p_generation) {}
+
+    /// Index of the timer in the pool of the wheel
+    uint32_t index = INVALID_INDEX;
+    /// Generation of the slot in the pool (detects stale handles)
+    uint32_t generation = 0;
+
+    /// Returns whether or not this handle was returned by a wheel
+    UTILS_NODISCARD auto valid() const -> bool {
+        return index != INVALID_INDEX;
+    }
+};
+
+/// Hierarchical timer wheel used to schedule large amounts of delayed
+/// callbacks (timeouts, retries, watchdogs) with O(1) insertion and
+/// cancellation. Time is given in seconds and quantized into ticks of the
+/// given resolution; the wheel has 4 levels of 64 slots each, so it covers
+/// 64^4 ticks ahead (timers further away are re-inserted when they get closer)
+///
+/// The wheel can be driven either explicitly, e.g. with the wall time of the
+/// clock after each Tock():
+///
+///     wheel.Advance(Clock::GetWallTime());
+///
+/// or by its own thread (see StartThread()). Callbacks are stored inline in a
+/// pool of nodes (no heap allocation per timer), and are executed without
+/// holding the lock of the wheel, so they can schedule/cancel other timers
+class UTILS_API TimerWheel {
+    DEFINE_SMART_POINTERS(TimerWheel)
+
+    NO_COPY_NO_MOVE_NO_ASSIGN(TimerWheel)
+
+ public:
+    /// Default duration of a tick (in seconds)
+    static constexpr double DEFAULT_RESOLUTION = 0.001;
+    /// Maximum size (in bytes) of the callables stored in the wheel
+    static constexpr size_t MAX_CALLBACK_SIZE = 64;
+    /// Number of levels of the wheel
+    static constexpr size_t NUM_LEVELS = 4;
+    /// Number of bits used to index the slots of a level
+    static constexpr size_t SLOT_BITS = 6;
+    /// Number of slots per level
+    static constexpr size_t NUM_SLOTS = 1 << SLOT_BITS;
+
+    /// Creates a wheel whose current time is start_time (in seconds)
+    explicit TimerWheel(double resolution = DEFAULT_RESOLUTION,
+                        double start_time = 0.0);
+
+    /// Stops the thread of the wheel (if any), and drops all pending timers
+    ~TimerWheel();
+
+    /// Schedules a callback to be executed after the given delay (in seconds,
+    /// relative to the current time of the wheel)
+    template <typename F>
+    auto Schedule(double delay, F&& callback) -> TimerHandle {
+        return ScheduleAt(current_time() + delay, std::forward<F>(callback));
+    }
+
+    /// Schedules a callback to be executed at the given time (in seconds)
+    template <typename F>
+    auto ScheduleAt(double time, F&& callback) -> TimerHandle {
+        using Fn = typename std::decay<F>::type;
+        static_assert(sizeof(Fn) <= MAX_CALLBACK_SIZE,
+                      "TimerWheel >>> callback is too big to be stored inline "
+                      "(capture less state, or a pointer to it)");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t),
+                      "TimerWheel >>> callback is over-aligned");
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        const auto index = _AllocateNode();
+        auto& node = m_Nodes[index];
+        new (node.storage) Fn(std::forward<F>(callback));
+        node.invoke = [](void* storage) { (*static_cast<Fn*>(storage))(); };
+        node.destroy = [](void* storage) { static_cast<Fn*>(storage)->~Fn(); };
+        node.deadline = _ToTick(time);
+        _Insert(index);
+        return {index, node.generation};
+    }
+
+    /// Cancels a pending timer. Returns false if the timer already fired (or
+    /// is firing), was cancelled, or the handle is invalid
+    auto Cancel(TimerHandle handle) -> bool;
+
+    /// Moves the current time of the wheel forward to the given time (in
+    /// seconds), executing the callbacks of all the timers that expired
+    auto Advance(double time) -> void;
+
+    /// Starts a thread that advances the wheel using the monotonic clock,
+    /// continuing from the current time of the wheel
+    auto StartThread() -> void;
+
+    /// Stops the thread that advances the wheel (if running)
+    auto StopThread() -> void;
+
+    /// Returns the number of pending timers
+    UTILS_NODISCARD auto size() const -> size_t;
+
+    /// Returns the current time of the wheel (in seconds)
+    UTILS_NODISCARD auto current_time() const -> double;
+
+    /// Returns the duration of a tick (in seconds)
+    UTILS_NODISCARD auto resolution() const -> double { return m_Resolution; }
+
+ private:
+    /// Index used to represent the end of the lists of nodes
+    static constexpr uint32_t NIL = TimerHandle::INVALID_INDEX;
+    /// Index of the list of expired timers (after the lists of the slots)
+    static constexpr uint32_t EXPIRED_LIST = NUM_LEVELS * NUM_SLOTS;
+
+    /// State of the nodes of the pool
+    enum class eNodeState : uint8_t { FREE, PENDING, EXPIRED, RUNNING };
+
+    /// Node of the pool, storing a timer and its callback
+    struct Node {
+        /// Storage for the callable (constructed in place)
+        alignas(std::max_align_t) unsigned char storage[MAX_CALLBACK_SIZE];
+        /// Type-erased operations on the stored callable
+        void (*invoke)(void*) = nullptr;
+        void (*destroy)(void*) = nullptr;
+        /// Tick at which the timer expires
+        uint64_t deadline = 0;
+        /// Links of the (intrusive, doubly-linked) list the node is in
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        /// List the node is in (index of the slot, or the expired list)
+        uint32_t list = NIL;
+        /// Incremented each time the node is released
+        uint32_t generation = 0;
+        /// Current state of the node
+        eNodeState state = eNodeState::FREE;
+    };
+
+    /// Converts a time (in seconds) into the tick at which a timer expires
+    auto _ToTick(double time) const -> uint64_t;
+
+    /// Takes a node from the free list (growing the pool if needed)
+    auto _AllocateNode() -> uint32_t;
+
+    /// Destroys the callable of a node, and returns it to the free list
+    auto _ReleaseNode(uint32_t index) -> void;
+
+    /// Inserts a node into the slot that corresponds to its deadline
+    auto _Insert(uint32_t index) -> void;
+
+    /// Links a node at the back of the given list
+    auto _Link(uint32_t index, uint32_t list) -> void;
+
+    /// Unlinks a node from the list it's in
+    auto _Unlink(uint32_t index) -> void;
+
+    /// Re-inserts all the nodes of a slot of the given level into the lower
+    /// levels. Returns the index of the slot that was cascaded
+    auto _Cascade(size_t level) -> size_t;
+
+    /// Moves the wheel one tick forward, moving the timers that expire into
+    /// the list of expired timers
+    auto _Tick() -> void;
+
+    /// Executes the callbacks of the expired timers (releasing the lock while
+    /// each callback runs)
+    auto _RunExpired(std::unique_lock<std::mutex>& lock) -> void;
+
+ private:
+    /// Duration of a tick (in seconds)
+    double m_Resolution = DEFAULT_RESOLUTION;
+    /// Current tick of the wheel
+    uint64_t m_CurrentTick = 0;
+    /// Pool of nodes (a deque, so growing it doesn't move the callables)
+    std::deque<Node> m_Nodes;
+    /// Head of the list of free nodes
+    uint32_t m_FreeHead = NIL;
+    /// Heads and tails of the lists of each slot of each level, plus the list
+    /// of expired timers
+    std::array<uint32_t, EXPIRED_LIST + 1> m_Heads{};
+    std::array<uint32_t, EXPIRED_LIST + 1> m_Tails{};
+    /// Number of pending timers
+    size_t m_NumPending = 0;
+    /// Lock protecting the state of the wheel
+    mutable std::mutex m_Mutex;
+    /// Thread used to advance the wheel (if started)
+    std::thread m_Thread;
+    /// Whether or not the thread of the wheel should keep running
+    std::atomic<bool> m_ThreadRunning{false};
+};
+
+}  // namespace utils
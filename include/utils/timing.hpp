@@ -1,47 +1,341 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <utils/logging.hpp>
 
-/// Number of frames used for averaging-window
+/// Default number of samples used for the averaging-windows
 constexpr size_t NUM_FRAMES_FOR_AVG = 100;
 /// Name of the default event to keep track of (wall-time)
 constexpr const char* MAIN_EVENT = "walltime";
 
 namespace utils {
 
+/// Streaming estimator of a single quantile, using the P-square algorithm
+/// (Jain & Chlamtac, 1985). Keeps only five markers, so its memory usage and
+/// update cost are constant regardless of the number of samples
+class UTILS_API P2QuantileEstimator {
+ public:
+    /// Creates an estimator for the given quantile (in the range (0,1))
+    explicit P2QuantileEstimator(double quantile);
+
+    /// Adds a new sample to the estimator
+    auto Push(double value) -> void;
+
+    /// Drops all samples seen so far
+    auto Reset() -> void;
+
+    /// Returns the current estimate of the quantile (0 if there's no samples)
+    UTILS_NODISCARD auto value() const -> double;
+
+    /// Returns the quantile being estimated
+    UTILS_NODISCARD auto quantile() const -> double { return m_Quantile; }
+
+    /// Returns the number of samples seen so far
+    UTILS_NODISCARD auto count() const -> uint64_t { return m_Count; }
+
+ private:
+    /// Number of markers used by the algorithm
+    static constexpr size_t NUM_MARKERS = 5;
+
+    /// Quantile being estimated
+    double m_Quantile = 0.5;
+    /// Number of samples seen so far
+    uint64_t m_Count = 0;
+    /// Heights of the markers
+    std::array<double, NUM_MARKERS> m_Heights{};
+    /// Actual positions of the markers
+    std::array<double, NUM_MARKERS> m_Positions{};
+    /// Desired positions of the markers
+    std::array<double, NUM_MARKERS> m_DesiredPositions{};
+    /// Increments of the desired positions on each new sample
+    std::array<double, NUM_MARKERS> m_Increments{};
+};
+
+/// Statistics over a rolling window of samples, updated in amortized constant
+/// time and without allocations (the window is allocated on
+/// construction/resize). The extremes are tracked with monotonic queues, and
+/// the sums are recomputed once per lap around the window (to keep rounding
+/// errors from drifting)
+class UTILS_API RollingStats {
+ public:
+    /// Creates the statistics for a window of the given size (at least 1)
+    explicit RollingStats(size_t window_size = NUM_FRAMES_FOR_AVG);
+
+    /// Adds a new sample, evicting the oldest one if the window is full
+    auto Push(double value) -> void;
+
+    /// Drops all samples and changes the size of the window
+    auto Resize(size_t window_size) -> void;
+
+    /// Returns the number of samples currently in the window
+    UTILS_NODISCARD auto count() const -> size_t { return m_Count; }
+
+    /// Returns the size of the window
+    UTILS_NODISCARD auto window_size() const -> size_t {
+        return m_Window.size();
+    }
+
+    /// Returns the mean of the samples in the window
+    UTILS_NODISCARD auto mean() const -> double;
+
+    /// Returns the (population) standard deviation of the samples in the window
+    UTILS_NODISCARD auto stddev() const -> double;
+
+    /// Returns the minimum of the samples in the window
+    UTILS_NODISCARD auto min() const -> double { return m_Min; }
+
+    /// Returns the maximum of the samples in the window
+    UTILS_NODISCARD auto max() const -> double { return m_Max; }
+
+    /// Returns the exponentially weighted moving average of all samples, with
+    /// a smoothing factor of 2 / (window_size + 1)
+    UTILS_NODISCARD auto ewma() const -> double { return m_Ewma; }
+
+ private:
+    /// Fixed-capacity deque with the positions (in the stream of samples) of
+    /// the candidates to become the extreme of the window, oldest first
+    struct ExtremesQueue {
+        /// Ring buffer with the positions (as big as the window)
+        std::vector<uint64_t> positions;
+        /// Index of the oldest position in the ring buffer
+        size_t front = 0;
+        /// Number of positions in the queue
+        size_t size = 0;
+    };
+
+    /// Recomputes the sums from the samples in the window
+    auto _RecomputeSums() -> void;
+
+    /// Adds the sample at the given position (already written into the
+    /// window) to the queue, dropping the samples that left the window and
+    /// the ones that can't be the extreme anymore (i.e. for which
+    /// keep(sample, value) is false)
+    template <typename Compare>
+    auto _PushExtreme(ExtremesQueue& queue, uint64_t position, Compare keep)
+        -> void;
+
+ private:
+    /// Ring buffer with the samples of the window
+    std::vector<double> m_Window;
+    /// Index where the next sample will be written
+    size_t m_Index = 0;
+    /// Number of valid samples in the window
+    size_t m_Count = 0;
+    /// Number of samples pushed since the last resize
+    uint64_t m_NumPushed = 0;
+    /// Candidates for the minimum (in increasing order of value)
+    ExtremesQueue m_MinQueue;
+    /// Candidates for the maximum (in decreasing order of value)
+    ExtremesQueue m_MaxQueue;
+    /// Sum of the samples in the window
+    double m_Sum = 0.0;
+    /// Sum of the squares of the samples in the window
+    double m_SumSq = 0.0;
+    /// Minimum of the samples in the window
+    double m_Min = 0.0;
+    /// Maximum of the samples in the window
+    double m_Max = 0.0;
+    /// Exponentially weighted moving average
+    double m_Ewma = 0.0;
+    /// Smoothing factor of the moving average
+    double m_EwmaAlpha = 0.0;
+};
+
+/// Summary of the statistics of an event (all values in seconds)
+struct UTILS_API ClockEventStats {
+    /// Number of samples in the rolling window
+    uint64_t window_count = 0;
+    /// Mean duration over the rolling window
+    double mean = 0.0;
+    /// Standard deviation of the duration over the rolling window
+    double stddev = 0.0;
+    /// Minimum duration over the rolling window
+    double min = 0.0;
+    /// Maximum duration over the rolling window
+    double max = 0.0;
+    /// Exponentially weighted moving average of the duration
+    double ewma = 0.0;
+    /// Estimated median of the duration (over all samples)
+    double p50 = 0.0;
+    /// Estimated 99th percentile of the duration (over all samples)
+    double p99 = 0.0;
+    /// Estimated 99.9th percentile of the duration (over all samples)
+    double p999 = 0.0;
+};
+
 struct UTILS_API ClockEvent {
     /// Unique identifier of the event
     std::string name;
-    /// Starting time-stamp of the event
+    /// Starting time-stamp of the event (in seconds, monotonic clock)
     double time_start;
-    /// Finishing time-stamps of the event
+    /// Finishing time-stamps of the event (in seconds, monotonic clock)
     double time_stop;
     /// Total duration(in seconds) of the event
     double time_duration;
+    /// Starting time-stamp of the event (in nanoseconds, monotonic clock)
+    int64_t time_start_ns;
+    /// Finishing time-stamp of the event (in nanoseconds, monotonic clock)
+    int64_t time_stop_ns;
+    /// Total duration(in nanoseconds) of the event
+    int64_t duration_ns;
+    /// Number of completed tick-tock pairs of the event
+    uint64_t num_samples;
+    /// Accumulated duration (in nanoseconds) of all the samples of the event
+    int64_t total_duration_ns;
+    /// Streaming statistics of the duration of the event
+    ClockEventStats stats;
 
     /// Returns the string representation of the event
     UTILS_NODISCARD auto ToString() const -> std::string;
 };
 
+/// Lightweight handle to a registered clock-event (index into the arrays of
+/// events of the clocks)
+struct UTILS_API ClockEventHandle {
+    /// Index used to represent handles that don't point to any event
+    static constexpr uint32_t INVALID_INDEX = 0xffffffff;
+
+    ClockEventHandle() = default;
+
+    explicit constexpr ClockEventHandle(uint32_t p_index) : index(p_index) {}
+
+    /// Index of the event in the arrays of events of the clocks
+    uint32_t index = INVALID_INDEX;
+
+    /// Returns whether or not this handle points to a registered event
+    UTILS_NODISCARD auto valid() const -> bool {
+        return index != INVALID_INDEX;
+    }
+};
+
+/// Read-only, non-owning view of one of the ring buffers of a clock. It stays
+/// valid until the clock is resized or destroyed, and is updated in place by
+/// the owner of the clock (readers on other threads get no synchronization).
+/// Use the shared buffers of the clock to keep the storage alive instead
+struct UTILS_API BufferView {
+    /// Pointer to the first element of the ring buffer
+    const double* data;
+    /// Number of elements of the ring buffer
+    size_t size;
+    /// Index where the next sample will be written (the oldest sample)
+    size_t write_index;
+
+    UTILS_NODISCARD auto operator[](size_t index) const -> double {
+        return data[index];  // NOLINT
+    }
+
+    UTILS_NODISCARD auto begin() const -> const double* { return data; }
+
+    UTILS_NODISCARD auto end() const -> const double* {
+        return data + size;  // NOLINT
+    }
+
+    UTILS_NODISCARD auto empty() const -> bool { return size == 0; }
+};
+
+/// Callback that receives the intervals measured by ScopedClockEvent guards
+/// (time-stamps in nanoseconds, as given by Clock::GetTimeStampNs())
+using ClockScopeHook = void (*)(ClockEventHandle handle, int64_t start_ns,
+                                int64_t stop_ns);
+
+/// Copy of the state of the events tracked by a single clock instance
+struct UTILS_API ClockSnapshot {
+    /// Name of the clock instance the snapshot was taken from
+    std::string clock_name;
+    /// State of the events of the clock (indexed by the handle's index)
+    std::vector<ClockEvent> events;
+};
+
+/// Clock used to keep track of the duration of events
+///
+/// Clocks can be instantiated (e.g. one per subsystem), and the static API
+/// routes to a clock owned by the calling thread, so events can be timed from
+/// several threads at once. Each instance should only be ticked by a single
+/// thread, whereas snapshots can be taken from any thread: the hot paths only
+/// touch thread-local data and publish their updates through a sequence lock.
+///
+/// Handles come from a registry shared by all clocks, so a handle obtained
+/// once can be used with every instance and on every thread.
 class UTILS_API Clock {
     DEFINE_SMART_POINTERS(Clock)
 
+    NO_COPY_NO_MOVE_NO_ASSIGN(Clock)
+
  public:
     /// Buffer-type used for storing times used in averaging-window
-    using BufferArray = std::array<float, NUM_FRAMES_FOR_AVG>;
+    using BufferArray = std::vector<double>;
+    /// Shared ownership of one of the buffers of a clock
+    using SharedBuffer = std::shared_ptr<const BufferArray>;
 
-    /// Initialize the clock module(singleton)
+    /// Index of the main event (wall-time), which is always registered
+    static constexpr uint32_t MAIN_EVENT_INDEX = 0;
+
+    /// Initialize the clock module. Resets the clocks of all threads (handles
+    /// of registered events remain valid). Each thread resets its own clock
+    /// the next time it uses the static API, so references to the clocks of
+    /// threads that are still ticking them remain valid
     static auto Init() -> void;
 
-    /// Releases this module(singleton) and its resources
+    /// Releases this module, detaching the clocks of all threads from it (see
+    /// Init; the clocks themselves are freed when their threads finish)
     static auto Release() -> void;
 
+    /// Registers an event with the given name (if not registered already) and
+    /// returns a handle to it, to be used with the handle-based API
+    static auto RegisterEvent(const std::string& event_name)
+        -> ClockEventHandle;
+
+    /// Returns the current time-stamp (in nanoseconds) of the monotonic clock
+    /// used by all clocks
+    static auto GetTimeStampNs() -> int64_t { return _TimeStampNow(); }
+
+    /// Returns the name of the event with the given handle (empty if invalid)
+    static auto GetEventName(ClockEventHandle handle) -> std::string;
+
+    /// Returns the number of registered events (handles are in [0, n))
+    static auto GetNumEvents() -> uint32_t;
+
+    /// Sets the hook that receives the intervals measured by all the
+    /// ScopedClockEvent guards (nullptr to disable)
+    static auto SetScopeHook(ClockScopeHook hook) -> void;
+
+    /// Returns the hook that receives the intervals of the scoped guards
+    static auto GetScopeHook() -> ClockScopeHook {
+        return s_ScopeHook.load(std::memory_order_relaxed);
+    }
+
+    /// Forwards the intervals measured by the scoped guards to the profiler
+    /// (to its default session), or stops forwarding them
+    static auto ForwardScopesToProfiler(bool enabled) -> void;
+
+    /// Returns the handle to the main event (wall-time)
+    static auto GetMainEvent() -> ClockEventHandle {
+        return ClockEventHandle{MAIN_EVENT_INDEX};
+    }
+
+    /// Returns the clock owned by the calling thread (created on first use,
+    /// reset after the module is initialized or released, and dropped once
+    /// the thread finishes)
+    static auto GetThreadInstance() -> Clock&;
+
+    /// Starts tracking the time of the event with the given handle
+    static auto Tick(ClockEventHandle handle) -> void;
+
+    /// Stops tracking the time of the event with the given handle
+    static auto Tock(ClockEventHandle handle) -> void;
+
+    /// Returns the event with the given handle
+    static auto GetEvent(ClockEventHandle handle) -> ClockEvent;
+
     /// Starts tracking the time, until a Tock() is received
     static auto Tick(const std::string& event_name = MAIN_EVENT) -> void;
 
@@ -54,22 +348,23 @@ class UTILS_API Clock {
 
     /// Returns the current time (in seconds) since the initialization of the
     /// clock module
-    static auto GetWallTime() -> float;
+    static auto GetWallTime() -> double;
 
     /// Returns the time-step (delta-time in seconds) in between the last
     /// tick-tock request
-    static auto GetTimeStep() -> float;
+    static auto GetTimeStep() -> double;
 
     /// Returns the average time-step (average delta-time in seconds) so far
     /// (since the clock module initialization)
-    static auto GetAvgTimeStep() -> float;
+    static auto GetAvgTimeStep() -> double;
 
-    /// Returns the fps computed for the last tick-tock request
-    static auto GetFps() -> float;
+    /// Returns the fps computed for the last tick-tock request (0 if no time
+    /// has elapsed yet)
+    static auto GetFps() -> double;
 
     /// Returns the average fps recorded since the initialization of the clock
     /// module
-    static auto GetAvgFps() -> float;
+    static auto GetAvgFps() -> double;
 
     /// Returns the index of the current time-step in the times-buffer
     static auto GetTimeIndex() -> size_t;
@@ -80,38 +375,317 @@ class UTILS_API Clock {
     /// Returns all elements currently being processed in the fps window
     static auto GetFpsBuffer() -> BufferArray;
 
+    /// Returns a view (no copies) of the time-steps window of the calling
+    /// thread's clock
+    static auto GetTimesBufferView() -> BufferView;
+
+    /// Returns a view (no copies) of the fps window of the calling thread's
+    /// clock
+    static auto GetFpsBufferView() -> BufferView;
+
+    /// Returns shared ownership of the time-steps window of the calling
+    /// thread's clock (see shared_times_buffer())
+    static auto GetSharedTimesBuffer() -> SharedBuffer;
+
+    /// Returns shared ownership of the fps window of the calling thread's
+    /// clock (see shared_fps_buffer())
+    static auto GetSharedFpsBuffer() -> SharedBuffer;
+
+    /// Sets the size of the averaging-windows used by the clock of the calling
+    /// thread and by the clocks created from now on (resets the statistics)
+    static auto SetWindowSize(size_t window_size) -> void;
+
+    /// Returns the size of the averaging-windows of the calling thread's clock
+    static auto GetWindowSize() -> size_t;
+
+    /// Takes a snapshot of every live clock (all threads and all instances).
+    /// The events of threads that already finished are merged into a single
+    /// extra snapshot, named "retired-threads". The pending intervals of the
+    /// calling thread's clock are folded first (see RecordInterval)
+    static auto Snapshot() -> std::vector<ClockSnapshot>;
+
+    /// Merges the snapshots of several clocks into a single set of events,
+    /// indexed by handle (samples and total durations are accumulated, and
+    /// the most recent sample of each event is kept)
+    static auto Merge(const std::vector<ClockSnapshot>& snapshots)
+        -> std::vector<ClockEvent>;
+
  public:
-    Clock() = default;
+    /// Creates a clock instance (visible to Clock::Snapshot() while alive).
+    /// A window size of 0 uses the default set through SetWindowSize()
+    explicit Clock(std::string name = "", size_t window_size = 0);
+
+    ~Clock();
+
+    /// Starts tracking the time of the event with the given handle, and
+    /// returns the starting time-stamp (in nanoseconds)
+    auto Start(ClockEventHandle handle) -> int64_t;
+
+    /// Stops tracking the time of the event with the given handle, and
+    /// returns the finishing time-stamp (in nanoseconds). Events that were
+    /// never started on this clock are left untouched (with a warning). The
+    /// pending intervals of the clock are folded first
+    auto Stop(ClockEventHandle handle) -> int64_t;
+
+    /// Records an interval of the event with the given handle, measured by
+    /// the owner of the clock (e.g. by a ScopedClockEvent). Only the
+    /// time-stamps are stored here, and they're folded into the statistics of
+    /// the event by the next Stop(), by FlushIntervals(), or once the buffer
+    /// of pending intervals is full. Until then, readers don't see them
+    auto RecordInterval(ClockEventHandle handle, int64_t start_ns,
+                        int64_t stop_ns) -> void {
+        if (UTILS_UNLIKELY(m_NumPendingIntervals == MAX_PENDING_INTERVALS)) {
+            FlushIntervals();
+        }
+        auto& interval = m_PendingIntervals[m_NumPendingIntervals++];
+        interval.index = handle.index;
+        interval.start_ns = start_ns;
+        interval.stop_ns = stop_ns;
+    }
+
+    /// Folds the pending intervals (see RecordInterval) into the statistics
+    /// of their events (should be called by the owner)
+    auto FlushIntervals() -> void;
+
+    /// Returns a consistent copy of the event with the given handle (safe to
+    /// call from any thread)
+    UTILS_NODISCARD auto event(ClockEventHandle handle) const -> ClockEvent;
+
+    /// Returns a consistent copy of all the events of this clock (safe to call
+    /// from any thread)
+    UTILS_NODISCARD auto TakeSnapshot() const -> ClockSnapshot;
+
+    /// Reads the last duration and the number of samples of the first `count`
+    /// events in a single pass (events this clock hasn't seen yet are zeroed).
+    /// Cheaper than event() for per-frame polling, as no names are copied
+    auto ReadSamples(int64_t* durations_ns, uint64_t* num_samples,
+                     size_t count) const -> void;
+
+    /// Changes the size of the averaging-windows of this clock, and resets
+    /// the statistics of all its events, dropping the pending intervals
+    /// (should be called by the owner). New buffers are allocated, so the
+    /// shared ones are left untouched
+    auto Resize(size_t window_size) -> void;
+
+    /// Returns the size of the averaging-windows of this clock
+    UTILS_NODISCARD auto window_size() const -> size_t {
+        return m_TimesBuffer->size();
+    }
+
+    /// Returns the name of this clock
+    UTILS_NODISCARD auto name() const -> std::string { return m_Name; }
+
+    /// Returns the time (in seconds) accumulated by the main event
+    UTILS_NODISCARD auto wall_time() const -> double { return m_TimeCurrent; }
+
+    /// Returns the last time-step (in seconds) of the main event
+    UTILS_NODISCARD auto time_step() const -> double { return m_TimeStep; }
+
+    /// Returns the average time-step (in seconds) of the main event
+    UTILS_NODISCARD auto avg_time_step() const -> double {
+        return m_TimeStepAvg;
+    }
+
+    /// Returns the fps computed for the last main event (0 if none)
+    UTILS_NODISCARD auto fps() const -> double;
+
+    /// Returns the average fps of the main event (0 if none)
+    UTILS_NODISCARD auto avg_fps() const -> double;
+
+    /// Returns the index of the current time-step in the times-buffer
+    UTILS_NODISCARD auto time_index() const -> size_t { return m_TimeIndex; }
+
+    /// Returns the buffer of time-steps of the averaging window
+    UTILS_NODISCARD auto times_buffer() const -> const BufferArray& {
+        return *m_TimesBuffer;
+    }
+
+    /// Returns the buffer of fps-values of the averaging window
+    UTILS_NODISCARD auto fps_buffer() const -> const BufferArray& {
+        return *m_FpsBuffer;
+    }
+
+    /// Returns a view of the buffer of time-steps of the averaging window
+    UTILS_NODISCARD auto times_buffer_view() const -> BufferView {
+        return {m_TimesBuffer->data(), m_TimesBuffer->size(), m_TimeIndex};
+    }
+
+    /// Returns a view of the buffer of fps-values of the averaging window
+    UTILS_NODISCARD auto fps_buffer_view() const -> BufferView {
+        return {m_FpsBuffer->data(), m_FpsBuffer->size(), m_TimeIndex};
+    }
+
+    /// Returns shared ownership of the buffer of time-steps, which is updated
+    /// in place by the clock until it's resized, and stays valid even after
+    /// the clock is resized or destroyed
+    UTILS_NODISCARD auto shared_times_buffer() const -> SharedBuffer {
+        return m_TimesBuffer;
+    }
+
+    /// Returns shared ownership of the buffer of fps-values (see above)
+    UTILS_NODISCARD auto shared_fps_buffer() const -> SharedBuffer {
+        return m_FpsBuffer;
+    }
 
  private:
-    /// Starts tracking the time of a step
-    auto _Tick(const std::string& event) -> void;
+    /// Maximum number of intervals kept before folding them into the events
+    static constexpr size_t MAX_PENDING_INTERVALS = 64;
 
-    /// Stops the tracking of time of the current step, and updates internal
-    /// state
-    auto _Tock(const std::string& event) -> void;
+    /// Interval recorded through RecordInterval, not folded yet
+    struct PendingInterval {
+        uint32_t index;
+        int64_t start_ns;
+        int64_t stop_ns;
+    };
+
+    /// Timing data of an event. The atomics are written only by the owner of
+    /// the clock and read by any thread (guarded by the sequence lock of the
+    /// clock), whereas the estimators are only touched by the owner
+    struct EventRecord {
+        explicit EventRecord(size_t window_size) : window(window_size) {}
+
+        /// Resets the statistics, using a window of the given size
+        auto ResetStats(size_t window_size) -> void;
+
+        std::atomic<int64_t> time_start_ns{0};
+        std::atomic<int64_t> time_stop_ns{0};
+        std::atomic<int64_t> duration_ns{0};
+        std::atomic<int64_t> total_duration_ns{0};
+        std::atomic<uint64_t> num_samples{0};
+        /// Published statistics (see ClockEventStats)
+        std::atomic<uint64_t> window_count{0};
+        std::atomic<double> mean{0.0};
+        std::atomic<double> stddev{0.0};
+        std::atomic<double> min{0.0};
+        std::atomic<double> max{0.0};
+        std::atomic<double> ewma{0.0};
+        std::atomic<double> p50{0.0};
+        std::atomic<double> p99{0.0};
+        std::atomic<double> p999{0.0};
+        /// Estimators (owner only)
+        RollingStats window;
+        P2QuantileEstimator estimator_p50{0.5};
+        P2QuantileEstimator estimator_p99{0.99};
+        P2QuantileEstimator estimator_p999{0.999};
+    };
+
+    /// Drops all the events and time-steps, and starts over with windows of
+    /// the given size (owner only, while no other thread can read the clock)
+    auto _Reset(size_t window_size) -> void;
+
+    /// Adds a sample of the given event to its statistics, and publishes the
+    /// updated record through the sequence lock
+    auto _RecordSample(ClockEventHandle handle, EventRecord& record,
+                       int64_t start_ns, int64_t stop_ns) -> void;
+
+    /// Returns the record of the given event, growing the storage if the
+    /// event was registered after the last time this clock saw it
+    auto _GetRecord(ClockEventHandle handle) -> EventRecord&;
 
-    /// Returns the time-stamp in seconds since the start of the epoch
-    static auto _TimeStampNow() -> double;
+    /// Reads the data of an event into a ClockEvent (except for the name),
+    /// retrying until a consistent copy is obtained
+    auto _ReadRecord(const EventRecord& record, ClockEvent& dst) const -> void;
+
+    /// Returns the handle of the event with the given name, using a cache
+    /// local to this clock before falling back to the shared registry
+    auto _FindEvent(const std::string& event_name, bool register_if_missing)
+        -> ClockEventHandle;
+
+    /// Marks the start of a write into the records (sequence becomes odd)
+    auto _BeginWrite() -> void;
+
+    /// Marks the end of a write into the records (sequence becomes even)
+    auto _EndWrite() -> void;
+
+    /// Returns the time-stamp in nanoseconds of a monotonic clock
+    static auto _TimeStampNow() -> int64_t;
 
  private:
-    /// Handle to instance of clock module (singleton)
-    static Clock::uptr s_Instance;  // NOLINT
+    /// Name of this clock (used to identify it in snapshots)
+    std::string m_Name;
     /// Current wall time (in seconds)
-    float m_TimeCurrent = 0.0F;
+    double m_TimeCurrent = 0.0;
     /// Delta-time in between tick-tock calls (in seconds)
-    float m_TimeStep = 0.0F;
+    double m_TimeStep = 0.0;
     /// Average delta-time in between tick-tock calls (in seconds)
-    float m_TimeStepAvg = 0.0F;
+    double m_TimeStepAvg = 0.0;
     /// Index used for average calculation and indexing in the times and fps
     /// buffers
     size_t m_TimeIndex = 0;
-    /// Buffer of time values in the averaging window
-    BufferArray m_TimesBuffer{};
+    /// Buffer of time values in the averaging window (shared with the users
+    /// that need to keep it alive, e.g. numpy arrays)
+    std::shared_ptr<BufferArray> m_TimesBuffer;
     /// Buffer of fps-values in the averaging window
-    BufferArray m_FpsBuffer{};
-    /// Dictionary used to store the events by name
-    std::unordered_map<std::string, ClockEvent> m_ClockEvents;
+    std::shared_ptr<BufferArray> m_FpsBuffer;
+    /// Storage for the events of this clock, indexed by handle (a deque, so
+    /// growing it doesn't move the records that are being written)
+    std::deque<EventRecord> m_Records;
+    /// Lock used only when growing the records (and by readers)
+    mutable std::mutex m_RecordsMutex;
+    /// Sequence lock used to publish consistent updates to readers
+    std::atomic<uint32_t> m_Sequence{0};
+    /// Cache of name-to-index lookups (only used by the owner of the clock)
+    std::unordered_map<std::string, uint32_t> m_EventsIndices;
+    /// Intervals recorded by the owner, not folded into the events yet
+    std::array<PendingInterval, MAX_PENDING_INTERVALS> m_PendingIntervals{};
+    /// Number of pending intervals
+    size_t m_NumPendingIntervals = 0;
+
+    /// Hook that receives the intervals of the scoped guards
+    static std::atomic<ClockScopeHook> s_ScopeHook;  // NOLINT
+};
+
+/// RAII guard that times the enclosing scope as a clock-event. The event is
+/// resolved once into a handle (see CLOCK_SCOPE), and each pass only reads
+/// two time-stamps and stores them into the pending intervals of the clock
+/// (see Clock::RecordInterval), so the statistics are updated later in
+/// batches, off the timed scope
+class UTILS_API ScopedClockEvent {
+    NO_COPY_NO_MOVE_NO_ASSIGN(ScopedClockEvent)
+
+ public:
+    /// Starts timing the event on the clock of the calling thread
+    explicit ScopedClockEvent(ClockEventHandle handle)
+        : ScopedClockEvent(Clock::GetThreadInstance(), handle) {}
+
+    /// Starts timing the event on the given clock
+    ScopedClockEvent(Clock& clock, ClockEventHandle handle)
+        : m_Clock(clock),
+          m_Handle(handle),
+          m_StartNs(Clock::GetTimeStampNs()) {}
+
+    /// Stops timing the event, and forwards the interval to the scope hook
+    ~ScopedClockEvent() {
+        const auto stop_ns = Clock::GetTimeStampNs();
+        m_Clock.RecordInterval(m_Handle, m_StartNs, stop_ns);
+        const auto hook = Clock::GetScopeHook();
+        if (UTILS_UNLIKELY(hook != nullptr)) {
+            hook(m_Handle, m_StartNs, stop_ns);
+        }
+    }
+
+ private:
+    /// Clock where the event is recorded
+    Clock& m_Clock;
+    /// Handle of the event being timed
+    ClockEventHandle m_Handle;
+    /// Starting time-stamp of the scope (in nanoseconds)
+    int64_t m_StartNs = 0;
 };
 
 }  // namespace utils
+
+// The handle is registered once (thread-safe static initialization), so each
+// pass through the scope doesn't touch the name of the event at all
+// NOLINTNEXTLINE
+#define CLOCK_SCOPE(name)                                                     \
+    static const ::utils::ClockEventHandle UTILS_CONCAT(                      \
+        clock_scope_handle_, __LINE__) = ::utils::Clock::RegisterEvent(name); \
+    const ::utils::ScopedClockEvent UTILS_CONCAT(clock_scope_, __LINE__)(     \
+        UTILS_CONCAT(clock_scope_handle_, __LINE__))
+// NOLINTNEXTLINE
+#define CLOCK_SCOPE_IN(clock, name)                                           \
+    static const ::utils::ClockEventHandle UTILS_CONCAT(                      \
+        clock_scope_handle_, __LINE__) = ::utils::Clock::RegisterEvent(name); \
+    const ::utils::ScopedClockEvent UTILS_CONCAT(clock_scope_, __LINE__)(     \
+        clock, UTILS_CONCAT(clock_scope_handle_, __LINE__))
@@ -1,6 +1,9 @@
 from utils_bindings import (
     # logging module -----------
     LoggerType,
+    LogLevel,
+    AssertPolicy,
+    KvFormat,
     Logger,
     # paht handling module -----
     GetFilename,
@@ -8,27 +11,60 @@ from utils_bindings import (
     GetFolderpath,
     GetFilenameNoExtension,
     # timing module ------------
+    ClockEventStats,
     ClockEvent,
+    ClockEventHandle,
+    ClockSnapshot,
     Clock,
+    ClockExportFormat,
+    ClockExporter,
     # profiling module ---------
     SessionType,
     ProfilerTimer,
     Profiler,
     # noise module -------------
+    SimdLevel,
+    GetSupportedSimdLevel,
+    IsSimdLevelSupported,
+    NoiseType,
+    NoiseSample2d,
+    PerlinNoiseGenerator,
     PerlinNoise,
+    DomainWarp,
 )
 
+from .clock_export import load_clock_export
+from .log_handler import NativeLogHandler, to_native_level
+
 __all__ = [
     "LoggerType",
+    "LogLevel",
+    "AssertPolicy",
+    "KvFormat",
     "Logger",
+    "NativeLogHandler",
+    "to_native_level",
     "GetFilename",
     "GetFoldername",
     "GetFolderpath",
     "GetFilenameNoExtension",
+    "ClockEventStats",
     "ClockEvent",
+    "ClockEventHandle",
+    "ClockSnapshot",
     "Clock",
+    "ClockExportFormat",
+    "ClockExporter",
+    "load_clock_export",
     "SessionType",
     "ProfilerTimer",
     "Profiler",
+    "SimdLevel",
+    "GetSupportedSimdLevel",
+    "IsSimdLevelSupported",
+    "NoiseType",
+    "NoiseSample2d",
+    "PerlinNoiseGenerator",
     "PerlinNoise",
+    "DomainWarp",
 ]
@@ -1,11 +1,99 @@
 #include <pybind11/pybind11.h>
 
+#if defined(SPDLOG_FMT_EXTERNAL)
+#include <fmt/args.h>
+#else
+#include <spdlog/fmt/bundled/args.h>
+#endif
+
 #include <utils/logging.hpp>
 
 namespace py = pybind11;
 
 namespace utils {
 
+namespace {
+
+using FormatArgs = fmt::dynamic_format_arg_store<fmt::format_context>;
+
+/// Converts the python arguments into native values that fmt can format
+/// (should be called while holding the GIL)
+auto ToFormatArgs(const py::args& args) -> FormatArgs {
+    FormatArgs store;
+    store.reserve(args.size(), args.size());
+    for (const auto& arg : args) {
+        if (py::isinstance<py::bool_>(arg)) {
+            store.push_back(arg.cast<bool>());
+        } else if (py::isinstance<py::int_>(arg)) {
+            // Integers that don't fit into 64 bits are formatted by python
+            try {
+                store.push_back(arg.cast<int64_t>());
+            } catch (const py::cast_error&) {
+                store.push_back(py::str(arg).cast<std::string>());
+            }
+        } else if (py::isinstance<py::float_>(arg)) {
+            store.push_back(arg.cast<double>());
+        } else if (py::isinstance<py::str>(arg)) {
+            store.push_back(arg.cast<std::string>());
+        } else {
+            store.push_back(py::str(arg).cast<std::string>());
+        }
+    }
+    return store;
+}
+
+/// Returns whether or not the given level is enabled for a logger
+auto IsEnabled(spdlog::level::level_enum level, bool is_core) -> bool {
+    auto& instance = Logger::GetInstance();
+    return is_core ? instance.core_logger().should_log(level)
+                   : instance.client_logger().should_log(level);
+}
+
+/// Sends an already formatted message to the native loggers, releasing the
+/// GIL while the message goes through the sinks
+auto LogMessage(spdlog::level::level_enum level, const std::string& msg,
+                bool is_core) -> void {
+    py::gil_scoped_release release;
+    if (is_core) {
+        Logger::CoreLog(level, msg);
+    } else {
+        Logger::ClientLog(level, msg);
+    }
+}
+
+/// Formats the message natively (only if the level is enabled) and sends it
+/// to the native loggers, releasing the GIL while formatting and writing
+auto LogFormatted(spdlog::level::level_enum level, const std::string& fmt,
+                  const py::args& args, bool is_core) -> void {
+    if (!IsEnabled(level, is_core)) {
+        return;
+    }
+    if (args.empty()) {
+        LogMessage(level, fmt, is_core);
+        return;
+    }
+    const auto store = ToFormatArgs(args);
+    py::gil_scoped_release release;
+    fmt::memory_buffer msg;
+    fmt::vformat_to(std::back_inserter(msg), fmt, store);
+    const auto msg_view = spdlog::string_view_t(msg.data(), msg.size());
+    if (is_core) {
+        Logger::CoreLog(level, msg_view);
+    } else {
+        Logger::ClientLog(level, msg_view);
+    }
+}
+
+/// Formats a message natively (no level check), used for critical paths
+auto Format(const std::string& fmt, const py::args& args) -> std::string {
+    if (args.empty()) {
+        return fmt;
+    }
+    return fmt::vformat(fmt, ToFormatArgs(args));
+}
+
+}  // namespace
+
 // NOLINTNEXTLINE
 void bindings_logging_module(py::module m) {
     {
@@ -16,41 +104,140 @@ void bindings_logging_module(py::module m) {
             .value("FILE_LOGGER", Enum::FILE_LOGGER);
     }
 
+    {
+        using Enum = spdlog::level::level_enum;
+        constexpr auto EnumName = "LogLevel";  // NOLINT
+        py::enum_<Enum>(m, EnumName, py::arithmetic())
+            .value("TRACE", Enum::trace)
+            .value("DEBUG", Enum::debug)
+            .value("INFO", Enum::info)
+            .value("WARN", Enum::warn)
+            .value("ERROR", Enum::err)
+            .value("CRITICAL", Enum::critical)
+            .value("OFF", Enum::off);
+    }
+
+    {
+        using Enum = Logger::eAssertPolicy;
+        constexpr auto EnumName = "AssertPolicy";  // NOLINT
+        py::enum_<Enum>(m, EnumName, py::arithmetic())
+            .value("EXIT", Enum::EXIT)
+            .value("ABORT", Enum::ABORT)
+            .value("THROW", Enum::THROW)
+            .value("LOG_AND_CONTINUE", Enum::LOG_AND_CONTINUE)
+            .value("DEBUG_BREAK", Enum::DEBUG_BREAK);
+    }
+
+    {
+        using Enum = eKvFormat;
+        constexpr auto EnumName = "KvFormat";  // NOLINT
+        py::enum_<Enum>(m, EnumName, py::arithmetic())
+            .value("JSON_LINES", Enum::JSON_LINES)
+            .value("BINARY", Enum::BINARY);
+    }
+
+    // Failed assertions (with the THROW policy) show up as AssertionError
+    py::register_exception<AssertionError>(m, "AssertionError",
+                                           PyExc_AssertionError);
+
     {
         using Class = Logger;
         constexpr auto ClassName = "Logger";  // NOLINT
+        using Level = spdlog::level::level_enum;
         py::class_<Class>(m, ClassName)
             .def_property_readonly("ready", &Class::ready)
             .def_property_readonly("type", &Class::type)
+            .def_property_readonly("kv_format", &Class::kv_format)
+            .def_property_readonly("assert_policy", &Class::assert_policy)
             .def_static("Init", &Class::Init,
-                        py::arg("type") = Logger::eType::CONSOLE_LOGGER)
+                        py::arg("type") = Logger::eType::CONSOLE_LOGGER,
+                        py::arg("kv_format") = eKvFormat::JSON_LINES,
+                        py::arg("assert_policy") = Logger::eAssertPolicy::EXIT)
             .def_static("Release", &Class::Release)
             .def_static("GetInstance", &Class::GetInstance,
                         py::return_value_policy::reference)
-            .def_static("CoreTrace",
-                        [](const std::string& msg) { LOG_CORE_TRACE(msg); })
-            .def_static("CoreInfo",
-                        [](const std::string& msg) { LOG_CORE_INFO(msg); })
-            .def_static("CoreWarn",
-                        [](const std::string& msg) { LOG_CORE_WARN(msg); })
-            .def_static("CoreError",
-                        [](const std::string& msg) { LOG_CORE_ERROR(msg); })
-            .def_static("CoreCritical",
-                        [](const std::string& msg) { LOG_CORE_CRITICAL(msg); })
-            .def_static("CoreAssert",
-                        [](bool is_ok, const std::string& msg) {
-                            LOG_CORE_ASSERT(is_ok, msg);
-                        })
-            .def_static("Trace", [](const std::string& msg) { LOG_TRACE(msg); })
-            .def_static("Info", [](const std::string& msg) { LOG_INFO(msg); })
-            .def_static("Warn", [](const std::string& msg) { LOG_WARN(msg); })
-            .def_static("Error", [](const std::string& msg) { LOG_ERROR(msg); })
-            .def_static("Critical",
-                        [](const std::string& msg) { LOG_CRITICAL(msg); })
-            .def_static("Assert",
-                        [](const bool& is_ok, const std::string& msg) {
-                            LOG_ASSERT(is_ok, msg);
-                        });
+            .def_static("IsEnabled", &IsEnabled, py::arg("level"),
+                        py::arg("core") = false)
+            .def_static("LogMessage", &LogMessage, py::arg("level"),
+                        py::arg("msg"), py::arg("core") = false)
+            .def_static(
+                "CoreTrace",
+                [](const std::string& fmt, const py::args& args) {
+                    LogFormatted(Level::trace, fmt, args, true);
+                },
+                py::arg("fmt"))
+            .def_static(
+                "CoreInfo",
+                [](const std::string& fmt, const py::args& args) {
+                    LogFormatted(Level::info, fmt, args, true);
+                },
+                py::arg("fmt"))
+            .def_static(
+                "CoreWarn",
+                [](const std::string& fmt, const py::args& args) {
+                    LogFormatted(Level::warn, fmt, args, true);
+                },
+                py::arg("fmt"))
+            .def_static(
+                "CoreError",
+                [](const std::string& fmt, const py::args& args) {
+                    LogFormatted(Level::err, fmt, args, true);
+                },
+                py::arg("fmt"))
+            .def_static(
+                "CoreCritical",
+                [](const std::string& fmt, const py::args& args) {
+                    LOG_CORE_CRITICAL("{0}", Format(fmt, args));
+                },
+                py::arg("fmt"))
+            .def_static(
+                "CoreAssert",
+                [](bool is_ok, const std::string& fmt, const py::args& args) {
+                    if (!is_ok) {
+                        Logger::CoreAssertFailed("", "", 0, "{0}",
+                                                 Format(fmt, args));
+                    }
+                },
+                py::arg("is_ok"), py::arg("fmt"))
+            .def_static(
+                "Trace",
+                [](const std::string& fmt, const py::args& args) {
+                    LogFormatted(Level::trace, fmt, args, false);
+                },
+                py::arg("fmt"))
+            .def_static(
+                "Info",
+                [](const std::string& fmt, const py::args& args) {
+                    LogFormatted(Level::info, fmt, args, false);
+                },
+                py::arg("fmt"))
+            .def_static(
+                "Warn",
+                [](const std::string& fmt, const py::args& args) {
+                    LogFormatted(Level::warn, fmt, args, false);
+                },
+                py::arg("fmt"))
+            .def_static(
+                "Error",
+                [](const std::string& fmt, const py::args& args) {
+                    LogFormatted(Level::err, fmt, args, false);
+                },
+                py::arg("fmt"))
+            .def_static(
+                "Critical",
+                [](const std::string& fmt, const py::args& args) {
+                    LOG_CRITICAL("{0}", Format(fmt, args));
+                },
+                py::arg("fmt"))
+            .def_static(
+                "Assert",
+                [](bool is_ok, const std::string& fmt, const py::args& args) {
+                    if (!is_ok) {
+                        Logger::ClientAssertFailed("", "", 0, "{0}",
+                                                   Format(fmt, args));
+                    }
+                },
+                py::arg("is_ok"), py::arg("fmt"));
     }
 }
 
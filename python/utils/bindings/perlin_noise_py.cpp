@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
 #include <utils/perlin_noise.hpp>
@@ -6,8 +11,228 @@ namespace py = pybind11;
 
 namespace utils {
 
+namespace {
+
+/// Coordinates given from python (float32 contiguous arrays are used as they
+/// are, anything else is converted first)
+using InputArray =
+    py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+/// Samples written back to python (always float32 and contiguous, so the
+/// native kernels write into its memory directly)
+using OutputArray = py::array_t<float, py::array::c_style>;
+
+/// Returns the array where the samples should be written: the given one, if
+/// any (which must match the expected shape and layout, as converting it
+/// would write the samples into a copy), or a new one otherwise
+auto GetOutputArray(const py::object& out,
+                    const std::vector<py::ssize_t>& shape) -> OutputArray {
+    if (out.is_none()) {
+        return OutputArray(shape);
+    }
+    if (!py::isinstance<OutputArray>(out)) {
+        throw py::type_error("out must be a c-contiguous float32 array");
+    }
+    auto array = py::reinterpret_borrow<OutputArray>(out);
+    if (!array.writeable()) {
+        throw py::value_error("out must be writeable");
+    }
+    if (static_cast<size_t>(array.ndim()) != shape.size() ||
+        !std::equal(shape.begin(), shape.end(), array.shape())) {
+        throw py::value_error("out doesn't have the shape of the samples");
+    }
+    return array;
+}
+
+/// Whether the given (contiguous) arrays share any of their memory
+auto Overlaps(const float* lhs, const float* rhs, size_t count) -> bool {
+    const auto lhs_begin = reinterpret_cast<std::uintptr_t>(lhs);  // NOLINT
+    const auto rhs_begin = reinterpret_cast<std::uintptr_t>(rhs);  // NOLINT
+    const auto num_bytes = count * sizeof(float);
+    return count > 0 && lhs_begin < rhs_begin + num_bytes &&
+           rhs_begin < lhs_begin + num_bytes;
+}
+
+/// Samples the noise at the points given by the arrays of coordinates xs and
+/// ys (of any, but the same, shape)
+auto SamplePointsToArray(const PerlinNoiseGenerator& generator,
+                         const InputArray& xs, const InputArray& ys,
+                         const py::object& out, bool parallel) -> OutputArray {
+    const std::vector<py::ssize_t> shape(xs.shape(), xs.shape() + xs.ndim());
+    if (ys.ndim() != xs.ndim() ||
+        !std::equal(shape.begin(), shape.end(), ys.shape())) {
+        throw py::value_error("xs and ys must have the same shape");
+    }
+    auto samples = GetOutputArray(out, shape);
+    const auto count = static_cast<size_t>(xs.size());
+    const float* xs_data = xs.data();
+    const float* ys_data = ys.data();
+    float* out_data = samples.mutable_data();
+    // The samples are written while the coordinates are still being read
+    if (Overlaps(out_data, xs_data, count) ||
+        Overlaps(out_data, ys_data, count)) {
+        throw py::value_error("out must not overlap xs or ys");
+    }
+    {
+        py::gil_scoped_release release;
+        if (parallel) {
+            generator.SamplePoints2d(count, xs_data, ys_data, out_data,
+                                     ThreadPool::GetDefault());
+        } else {
+            generator.SamplePoints2d(count, xs_data, ys_data, out_data);
+        }
+    }
+    return samples;
+}
+
+/// Samples a grid of height x width values (see SampleGrid2d)
+auto SampleGridToArray(const PerlinNoiseGenerator& generator,
+                       const Vec2& origin, const Vec2& spacing, size_t width,
+                       size_t height, const py::object& out, eNoiseType type,
+                       bool parallel) -> OutputArray {
+    auto samples = GetOutputArray(out, {static_cast<py::ssize_t>(height),
+                                        static_cast<py::ssize_t>(width)});
+    float* out_data = samples.mutable_data();
+    {
+        py::gil_scoped_release release;
+        if (parallel) {
+            generator.SampleGrid2d(origin, spacing, width, height, out_data,
+                                   ThreadPool::GetDefault(), type);
+        } else {
+            generator.SampleGrid2d(origin, spacing, width, height, out_data,
+                                   type);
+        }
+    }
+    return samples;
+}
+
+/// Samples a domain-warped grid of height x width values (see
+/// SampleGrid2dWarped)
+auto SampleGridWarpedToArray(const PerlinNoiseGenerator& generator,
+                             const DomainWarp& warp, const Vec2& origin,
+                             const Vec2& spacing, size_t width, size_t height,
+                             const py::object& out, bool parallel)
+    -> OutputArray {
+    auto samples = GetOutputArray(out, {static_cast<py::ssize_t>(height),
+                                        static_cast<py::ssize_t>(width)});
+    float* out_data = samples.mutable_data();
+    {
+        py::gil_scoped_release release;
+        if (parallel) {
+            generator.SampleGrid2dWarped(warp, origin, spacing, width, height,
+                                         out_data, ThreadPool::GetDefault());
+        } else {
+            generator.SampleGrid2dWarped(warp, origin, spacing, width, height,
+                                         out_data);
+        }
+    }
+    return samples;
+}
+
+}  // namespace
+
 // NOLINTNEXTLINE
 void bindings_perlin_noise_module(py::module m) {
+    {
+        using Enum = eSimdLevel;
+        constexpr auto EnumName = "SimdLevel";  // NOLINT
+        py::enum_<Enum>(m, EnumName, py::arithmetic())
+            .value("SCALAR", Enum::SCALAR)
+            .value("SSE2", Enum::SSE2)
+            .value("AVX2", Enum::AVX2)
+            .value("NEON", Enum::NEON);
+    }
+
+    m.def("GetSupportedSimdLevel", &GetSupportedSimdLevel);
+    m.def("IsSimdLevelSupported", &IsSimdLevelSupported);
+
+    {
+        using Enum = eNoiseType;
+        constexpr auto EnumName = "NoiseType";  // NOLINT
+        py::enum_<Enum>(m, EnumName, py::arithmetic())
+            .value("PERLIN", Enum::PERLIN)
+            .value("SIMPLEX", Enum::SIMPLEX);
+    }
+
+    {
+        using Class = NoiseSample2d;
+        // NOLINTNEXTLINE
+        py::class_<Class>(m, "NoiseSample2d")
+            .def_readonly("value", &Class::value)
+            .def_readonly("gradient", &Class::gradient);
+    }
+
+    {
+        using Class = PerlinNoiseGenerator;
+        // NOLINTNEXTLINE
+        py::class_<Class>(m, "PerlinNoiseGenerator")
+            .def(py::init<uint32_t, size_t, float, float, float>(),
+                 py::arg("seed") = static_cast<uint32_t>(Class::DEFAULT_SEED),
+                 py::arg("num_octaves") =
+                     static_cast<size_t>(Class::DEFAULT_NUM_OCTAVES),
+                 py::arg("persistance") =
+                     static_cast<float>(Class::DEFAULT_PERSISTANCE),
+                 py::arg("lacunarity") =
+                     static_cast<float>(Class::DEFAULT_LACUNARITY),
+                 py::arg("noise_scale") =
+                     static_cast<float>(Class::DEFAULT_NOISE_SCALE))
+            .def("WithPeriod", &Class::WithPeriod)
+            .def("Sample1d", &Class::Sample1d)
+            .def("Sample2d",
+                 static_cast<float (Class::*)(float, float, eNoiseType) const>(
+                     &Class::Sample2d),
+                 py::arg("x"), py::arg("y"),
+                 py::arg("type") = eNoiseType::PERLIN)
+            .def("Sample2d",
+                 static_cast<float (Class::*)(const Vec2&, eNoiseType) const>(
+                     &Class::Sample2d),
+                 py::arg("xy"), py::arg("type") = eNoiseType::PERLIN)
+            .def("Sample2dWithGradient",
+                 static_cast<NoiseSample2d (Class::*)(float, float) const>(
+                     &Class::Sample2dWithGradient))
+            .def("Sample2dWithGradient",
+                 static_cast<NoiseSample2d (Class::*)(const Vec2&) const>(
+                     &Class::Sample2dWithGradient))
+            .def("Sample3d",
+                 static_cast<float (Class::*)(float, float, float, eNoiseType)
+                                 const>(&Class::Sample3d),
+                 py::arg("x"), py::arg("y"), py::arg("z"),
+                 py::arg("type") = eNoiseType::PERLIN)
+            .def("Sample4d", &Class::Sample4d, py::arg("x"), py::arg("y"),
+                 py::arg("z"), py::arg("w"),
+                 py::arg("type") = eNoiseType::PERLIN)
+            // Batch API: samples are written into numpy arrays (without
+            // copies), with the GIL released while sampling
+            .def("SamplePoints2d", &SamplePointsToArray, py::arg("xs"),
+                 py::arg("ys"), py::arg("out") = py::none(),
+                 py::arg("parallel") = true)
+            .def("SampleGrid2d", &SampleGridToArray, py::arg("origin"),
+                 py::arg("spacing"), py::arg("width"), py::arg("height"),
+                 py::arg("out") = py::none(),
+                 py::arg("type") = eNoiseType::PERLIN,
+                 py::arg("parallel") = true)
+            .def("SampleGrid2dWarped", &SampleGridWarpedToArray,
+                 py::arg("warp"), py::arg("origin"), py::arg("spacing"),
+                 py::arg("width"), py::arg("height"),
+                 py::arg("out") = py::none(), py::arg("parallel") = true)
+            .def_property_readonly("seed", &Class::seed)
+            .def_property_readonly("num_octaves", &Class::num_octaves)
+            .def_property_readonly("persistance", &Class::persistance)
+            .def_property_readonly("lacunarity", &Class::lacunarity)
+            .def_property_readonly("noise_scale", &Class::noise_scale)
+            .def_property_readonly("period", &Class::period);
+    }
+
+    {
+        using Class = DomainWarp;
+        // NOLINTNEXTLINE
+        py::class_<Class>(m, "DomainWarp")
+            .def(py::init<>())
+            .def("Then", &Class::Then)
+            .def("Warp", &Class::Warp)
+            .def_property_readonly("num_stages", &Class::num_stages);
+    }
+
     {
         using Class = PerlinNoise;
         // NOLINTNEXTLINE
@@ -15,11 +240,17 @@ void bindings_perlin_noise_module(py::module m) {
             .def_static("Init", &Class::Init)
             .def_static("Release", &Class::Release)
             .def_static("Config", &Class::Config)
+            .def_static("SetGenerator", &Class::SetGenerator)
+            .def_static("GetGenerator", &Class::GetGenerator,
+                        py::return_value_policy::copy)
             .def_static("Sample1d", &Class::Sample1d)
             .def_static("Sample2d",
                         static_cast<float (*)(float, float)>(&Class::Sample2d))
             .def_static("Sample2d",
-                        static_cast<float (*)(const Vec2&)>(&Class::Sample2d));
+                        static_cast<float (*)(const Vec2&)>(&Class::Sample2d))
+            .def_static("Sample2dWithGradient", &Class::Sample2dWithGradient)
+            .def_static("SetSimdLevel", &Class::SetSimdLevel)
+            .def_static("GetSimdLevel", &Class::GetSimdLevel);
     }
 }
 
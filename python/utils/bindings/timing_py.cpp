@@ -1,35 +1,189 @@
+#include <utility>
+
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
+#include <utils/clock_exporter.hpp>
 #include <utils/timing.hpp>
 
 namespace py = pybind11;
 
 namespace utils {
 
+namespace {
+
+/// Wraps a ring buffer of a clock into a read-only numpy array that shares
+/// its memory. The array holds a reference to the buffer, so it stays valid
+/// after the clock is resized (which swaps in new buffers) or destroyed
+auto MakeBufferArray(Clock::SharedBuffer buffer) -> py::array {
+    const auto* data = buffer->data();
+    const auto size = buffer->size();
+    py::capsule base(new Clock::SharedBuffer(std::move(buffer)),
+                     [](void* owner) {
+                         delete static_cast<Clock::SharedBuffer*>(owner);
+                     });
+    py::array_t<double> array({size}, {sizeof(double)}, data, base);
+    array.attr("setflags")(py::arg("write") = false);
+    return array;
+}
+
+}  // namespace
+
 // NOLINTNEXTLINE
 void bindings_timing_module(py::module m) {
+    {
+        using Class = ClockEventStats;
+        py::class_<Class>(m, "ClockEventStats")
+            .def_readonly("window_count", &Class::window_count)
+            .def_readonly("mean", &Class::mean)
+            .def_readonly("stddev", &Class::stddev)
+            .def_readonly("min", &Class::min)
+            .def_readonly("max", &Class::max)
+            .def_readonly("ewma", &Class::ewma)
+            .def_readonly("p50", &Class::p50)
+            .def_readonly("p99", &Class::p99)
+            .def_readonly("p999", &Class::p999);
+    }
+
     {
         using Class = ClockEvent;
         py::class_<Class>(m, "ClockEvent")
             .def_readwrite("name", &Class::name)
             .def_readwrite("time_start", &Class::time_start)
             .def_readwrite("time_stop", &Class::time_stop)
-            .def_readwrite("time_duration", &Class::time_duration);
+            .def_readwrite("time_duration", &Class::time_duration)
+            .def_readwrite("time_start_ns", &Class::time_start_ns)
+            .def_readwrite("time_stop_ns", &Class::time_stop_ns)
+            .def_readwrite("duration_ns", &Class::duration_ns)
+            .def_readwrite("num_samples", &Class::num_samples)
+            .def_readwrite("total_duration_ns", &Class::total_duration_ns)
+            .def_readonly("stats", &Class::stats);
+    }
+
+    {
+        using Class = ClockSnapshot;
+        py::class_<Class>(m, "ClockSnapshot")
+            .def_readonly("clock_name", &Class::clock_name)
+            .def_readonly("events", &Class::events);
+    }
+
+    {
+        using Class = ClockEventHandle;
+        py::class_<Class>(m, "ClockEventHandle")
+            .def(py::init<>())
+            .def_readonly("index", &Class::index)
+            .def_property_readonly("valid", &Class::valid)
+            .def("__repr__", [](const Class& self) -> py::str {
+                return py::str("ClockEventHandle(index={})").format(self.index);
+            });
     }
 
     {
         using Class = Clock;
+        using Handle = ClockEventHandle;
         py::class_<Class>(m, "Clock")
+            .def(py::init<std::string, size_t>(), py::arg("name") = "",
+                 py::arg("window_size") = 0)
+            .def("Start", &Class::Start, py::arg("handle"))
+            .def("Stop", &Class::Stop, py::arg("handle"))
+            .def("FlushIntervals", &Class::FlushIntervals)
+            .def("event", &Class::event, py::arg("handle"))
+            .def("TakeSnapshot", &Class::TakeSnapshot)
+            .def("Resize", &Class::Resize, py::arg("window_size"))
+            .def_property_readonly("window_size", &Class::window_size)
+            .def_property_readonly("name", &Class::name)
+            .def_property_readonly("wall_time", &Class::wall_time)
+            .def_property_readonly("time_step", &Class::time_step)
+            .def_property_readonly("avg_time_step", &Class::avg_time_step)
+            .def_property_readonly("fps", &Class::fps)
+            .def_property_readonly("avg_fps", &Class::avg_fps)
+            .def_property_readonly("time_index", &Class::time_index)
+            .def_property_readonly("times_buffer",
+                                   [](const Class& self) {
+                                       return MakeBufferArray(
+                                           self.shared_times_buffer());
+                                   })
+            .def_property_readonly("fps_buffer",
+                                   [](const Class& self) {
+                                       return MakeBufferArray(
+                                           self.shared_fps_buffer());
+                                   })
             .def_static("Init", &Class::Init)
             .def_static("Release", &Class::Release)
-            .def_static("Tick", &Class::Tick, py::arg("event_name"))
-            .def_static("Tock", &Class::Tock, py::arg("event_name"))
-            .def_static("GetEvent", &Class::GetEvent, py::arg("event_name"))
+            .def_static("RegisterEvent", &Class::RegisterEvent,
+                        py::arg("event_name"))
+            .def_static("GetMainEvent", &Class::GetMainEvent)
+            .def_static("GetEventName", &Class::GetEventName, py::arg("handle"))
+            .def_static("GetNumEvents", &Class::GetNumEvents)
+            .def_static("ForwardScopesToProfiler",
+                        &Class::ForwardScopesToProfiler, py::arg("enabled"))
+            .def_static("Tick", static_cast<void (*)(Handle)>(&Class::Tick),
+                        py::arg("handle"))
+            .def_static("Tick",
+                        static_cast<void (*)(const std::string&)>(&Class::Tick),
+                        py::arg("event_name"))
+            .def_static("Tock", static_cast<void (*)(Handle)>(&Class::Tock),
+                        py::arg("handle"))
+            .def_static("Tock",
+                        static_cast<void (*)(const std::string&)>(&Class::Tock),
+                        py::arg("event_name"))
+            .def_static("GetEvent",
+                        static_cast<ClockEvent (*)(Handle)>(&Class::GetEvent),
+                        py::arg("handle"))
+            .def_static("GetEvent",
+                        static_cast<ClockEvent (*)(const std::string&)>(
+                            &Class::GetEvent),
+                        py::arg("event_name"))
             .def_static("GetWallTime", &Class::GetWallTime)
             .def_static("GetTimeStep", &Class::GetTimeStep)
             .def_static("GetAvgTimeStep", &Class::GetAvgTimeStep)
             .def_static("GetFps", &Class::GetFps)
-            .def_static("GetAvgFps", &Class::GetAvgFps);
+            .def_static("GetAvgFps", &Class::GetAvgFps)
+            .def_static("GetTimeIndex", &Class::GetTimeIndex)
+            .def_static("GetTimesBuffer",
+                        []() {
+                            return MakeBufferArray(
+                                Clock::GetSharedTimesBuffer());
+                        })
+            .def_static("GetFpsBuffer",
+                        []() {
+                            return MakeBufferArray(Clock::GetSharedFpsBuffer());
+                        })
+            .def_static("SetWindowSize", &Class::SetWindowSize,
+                        py::arg("window_size"))
+            .def_static("GetWindowSize", &Class::GetWindowSize)
+            .def_static("Snapshot", &Class::Snapshot)
+            .def_static("Merge", &Class::Merge, py::arg("snapshots"));
+    }
+
+    {
+        using Enum = eClockExportFormat;
+        constexpr auto EnumName = "ClockExportFormat";  // NOLINT
+        py::enum_<Enum>(m, EnumName, py::arithmetic())
+            .value("BINARY", Enum::BINARY)
+            .value("CSV", Enum::CSV);
+    }
+
+    {
+        using Class = ClockExporter;
+        py::class_<Class>(m, "ClockExporter")
+            // The exporter keeps a pointer to the clock, so keep it alive
+            .def(py::init<std::string, eClockExportFormat, size_t, Clock*>(),
+                 py::arg("filepath"),
+                 py::arg("format") = eClockExportFormat::BINARY,
+                 py::arg("block_size") =
+                     static_cast<size_t>(ClockExporter::DEFAULT_BLOCK_SIZE),
+                 py::arg("clock") = nullptr, py::keep_alive<1, 5>())
+            .def("Record", &Class::Record)
+            .def("Flush", &Class::Flush,
+                 py::call_guard<py::gil_scoped_release>())
+            .def("Close", &Class::Close,
+                 py::call_guard<py::gil_scoped_release>())
+            .def_property_readonly("ok", &Class::ok)
+            .def_property_readonly("num_frames", &Class::num_frames)
+            .def_property_readonly("filepath", &Class::filepath)
+            .def_property_readonly("format", &Class::format);
     }
 }
 
@@ -0,0 +1,93 @@
+"""
+Loader for the per-frame timing traces written by the native ClockExporter
+(binary columnar files, or CSV files).
+"""
+import csv
+import struct
+from typing import Dict, List
+
+import numpy as np
+
+BINARY_MAGIC = b"LOCOCLK1"
+
+# Marker used for frames in which an event wasn't sampled
+NOT_SAMPLED = -1
+
+
+def _load_binary(data: bytes) -> Dict[str, np.ndarray]:
+    frames: List[np.ndarray] = []
+    wall_times: List[np.ndarray] = []
+    # Columns of each event, per block (events can show up mid-run)
+    blocks: List[Dict[str, np.ndarray]] = []
+    names: List[str] = []
+
+    offset = len(BINARY_MAGIC)
+    while offset < len(data):
+        num_frames, num_events = struct.unpack_from("=II", data, offset)
+        offset += 8
+        block_names = []
+        for _ in range(num_events):
+            (size,) = struct.unpack_from("=I", data, offset)
+            offset += 4
+            block_names.append(data[offset : offset + size].decode("utf-8"))
+            offset += size
+        frames.append(
+            np.frombuffer(data, dtype=np.int64, count=num_frames, offset=offset)
+        )
+        offset += 8 * num_frames
+        wall_times.append(
+            np.frombuffer(
+                data, dtype=np.float64, count=num_frames, offset=offset
+            )
+        )
+        offset += 8 * num_frames
+        columns = {}
+        for name in block_names:
+            columns[name] = np.frombuffer(
+                data, dtype=np.int64, count=num_frames, offset=offset
+            )
+            offset += 8 * num_frames
+            if name not in names:
+                names.append(name)
+        blocks.append(columns)
+
+    result = {
+        "frame": np.concatenate(frames) if frames else np.empty(0, np.int64),
+        "wall_time": (
+            np.concatenate(wall_times) if wall_times else np.empty(0)
+        ),
+    }
+    for name in names:
+        result[name] = np.concatenate(
+            [
+                block.get(name, np.full(len(frames[i]), NOT_SAMPLED, np.int64))
+                for i, block in enumerate(blocks)
+            ]
+        )
+    return result
+
+
+def _load_csv(filepath: str) -> Dict[str, np.ndarray]:
+    with open(filepath, "r", newline="") as file:
+        reader = csv.reader(file)
+        header = next(reader, [])
+        rows = list(reader)
+    result = {}
+    for i, name in enumerate(header):
+        dtype = np.float64 if name == "wall_time" else np.int64
+        result[name] = np.array([row[i] for row in rows], dtype=dtype)
+    return result
+
+
+def load_clock_export(filepath: str) -> Dict[str, np.ndarray]:
+    """
+    Loads a file written by a ClockExporter, and returns a dictionary with the
+    arrays "frame" (int64), "wall_time" (float64, in seconds), and one array
+    per event with its duration at each frame (int64, in nanoseconds, and -1
+    in the frames in which the event wasn't sampled)
+    """
+    with open(filepath, "rb") as file:
+        data = file.read()
+    if data.startswith(BINARY_MAGIC):
+        return _load_binary(data)
+    return _load_csv(filepath)
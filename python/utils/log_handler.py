@@ -0,0 +1,46 @@
+"""
+Adapter that routes records from Python's standard logging module into the
+native loggers of this library (same sinks, same crash-log).
+"""
+import logging
+
+from utils_bindings import Logger, LogLevel
+
+_LEVELS_MAP = (
+    (logging.CRITICAL, LogLevel.CRITICAL),
+    (logging.ERROR, LogLevel.ERROR),
+    (logging.WARNING, LogLevel.WARN),
+    (logging.INFO, LogLevel.INFO),
+    (logging.DEBUG, LogLevel.DEBUG),
+)
+
+
+def to_native_level(levelno: int) -> LogLevel:
+    """Maps a level from Python's logging module into a native level"""
+    for py_level, native_level in _LEVELS_MAP:
+        if levelno >= py_level:
+            return native_level
+    return LogLevel.TRACE
+
+
+class NativeLogHandler(logging.Handler):
+    """
+    A logging.Handler that sends the records to the native loggers. Records
+    whose level is disabled natively are dropped before being formatted, and
+    the GIL is released while the message goes through the native sinks
+    """
+
+    def __init__(self, level: int = logging.NOTSET, core: bool = False):
+        super().__init__(level)
+        self._core = core
+
+    def emit(self, record: logging.LogRecord) -> None:
+        native_level = to_native_level(record.levelno)
+        if not Logger.IsEnabled(native_level, self._core):
+            return
+        try:
+            msg = self.format(record)
+        except Exception:  # pylint: disable=broad-except
+            self.handleError(record)
+            return
+        Logger.LogMessage(native_level, msg, self._core)
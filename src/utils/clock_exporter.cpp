@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include <utils/clock_exporter.hpp>
+
+namespace utils {
+
+namespace {
+
+/// Marker used for events that weren't sampled during a frame
+constexpr int64_t NOT_SAMPLED = -1;
+
+template <typename T>
+auto WriteRaw(std::ofstream& file, const T* data, size_t count) -> void {
+    file.write(reinterpret_cast<const char*>(data),  // NOLINT
+               static_cast<std::streamsize>(sizeof(T) * count));
+}
+
+}  // namespace
+
+ClockExporter::ClockExporter(std::string filepath, eClockExportFormat format,
+                             size_t block_size, Clock* clock)
+    : m_Filepath(std::move(filepath)),
+      m_Format(format),
+      m_BlockSize(std::max<size_t>(block_size, 1)),
+      m_Clock(clock) {
+    m_File.open(m_Filepath, std::ofstream::out | std::ofstream::binary |
+                                std::ofstream::trunc);
+    if (!m_File.is_open()) {
+        LOG_CORE_ERROR(
+            "ClockExporter >>> couldn't open file {0}, frames won't be "
+            "recorded",
+            m_Filepath);
+        return;
+    }
+    if (m_Format == eClockExportFormat::BINARY) {
+        m_File.write(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+    }
+    m_Running = true;
+    m_Thread = std::thread([this]() { _Run(); });
+}
+
+ClockExporter::~ClockExporter() { Close(); }
+
+auto ClockExporter::Record() -> void {
+    if (!m_Running) {
+        return;
+    }
+    auto& clock = (m_Clock != nullptr) ? *m_Clock : Clock::GetThreadInstance();
+    size_t num_events = Clock::GetNumEvents();
+    if (m_Format == eClockExportFormat::CSV) {
+        if (m_NumCsvColumns == 0) {
+            m_NumCsvColumns = num_events;
+        } else if (num_events > m_NumCsvColumns && !m_WarnedCsvColumns) {
+            LOG_CORE_WARN(
+                "ClockExporter >>> events registered after the first frame "
+                "aren't exported to CSV file {0} (use the binary format)",
+                m_Filepath);
+            m_WarnedCsvColumns = true;
+        }
+        num_events = m_NumCsvColumns;
+    }
+
+    m_Durations.resize(num_events);
+    m_NumSamples.resize(num_events);
+    m_LastNumSamples.resize(num_events, 0);
+    // Record() is called by the owner of the clock, which can fold the
+    // intervals of the scoped guards of this frame
+    clock.FlushIntervals();
+    clock.ReadSamples(m_Durations.data(), m_NumSamples.data(), num_events);
+
+    // Events registered in the middle of a block start a new block
+    if (m_Current != nullptr && m_Current->names.size() != num_events) {
+        _Submit();
+    }
+    if (m_Current == nullptr) {
+        m_Current = _AcquireBlock(num_events);
+    }
+
+    auto& block = *m_Current;
+    const auto frame = block.num_frames;
+    block.frames[frame] = static_cast<int64_t>(m_NumFrames);
+    block.wall_times[frame] = clock.wall_time();
+    for (size_t i = 0; i < num_events; i++) {
+        const auto sampled = (m_NumSamples[i] != m_LastNumSamples[i]);
+        block.durations[i * m_BlockSize + frame] =
+            sampled ? m_Durations[i] : NOT_SAMPLED;
+        m_LastNumSamples[i] = m_NumSamples[i];
+    }
+    block.num_frames++;
+    m_NumFrames++;
+    if (block.num_frames == m_BlockSize) {
+        _Submit();
+    }
+}
+
+auto ClockExporter::Flush() -> void {
+    if (!m_Running) {
+        return;
+    }
+    _Submit();
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_IdleCondVar.wait(lock,
+                       [this]() { return m_Pending.empty() && !m_Writing; });
+    m_File.flush();
+}
+
+auto ClockExporter::Close() -> void {
+    if (!m_Running) {
+        return;
+    }
+    _Submit();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Running = false;
+    }
+    m_WorkCondVar.notify_one();
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+    m_File.close();
+}
+
+auto ClockExporter::_AcquireBlock(size_t num_events)
+    -> std::unique_ptr<Block> {
+    std::unique_ptr<Block> block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Spare.empty()) {
+            block = std::move(m_Spare.back());
+            m_Spare.pop_back();
+        }
+    }
+    if (block == nullptr) {
+        block = std::unique_ptr<Block>(new Block());
+        block->frames.resize(m_BlockSize);
+        block->wall_times.resize(m_BlockSize);
+    }
+    // Look up the names of the new events only once
+    for (auto i = m_Names.size(); i < num_events; i++) {
+        m_Names.push_back(
+            Clock::GetEventName(ClockEventHandle{static_cast<uint32_t>(i)}));
+    }
+    const auto names_end =
+        m_Names.begin() + static_cast<std::ptrdiff_t>(num_events);
+    block->names.assign(m_Names.begin(), names_end);
+    block->durations.resize(num_events * m_BlockSize);
+    block->num_frames = 0;
+    return block;
+}
+
+auto ClockExporter::_Submit() -> void {
+    if (m_Current == nullptr || m_Current->num_frames == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Pending.push_back(std::move(m_Current));
+    }
+    m_Current = nullptr;
+    m_WorkCondVar.notify_one();
+}
+
+auto ClockExporter::_Run() -> void {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true) {
+        m_WorkCondVar.wait(
+            lock, [this]() { return !m_Pending.empty() || !m_Running; });
+        if (m_Pending.empty()) {
+            // Only exit once all the pending blocks were written
+            break;
+        }
+        auto block = std::move(m_Pending.front());
+        m_Pending.pop_front();
+        m_Writing = true;
+        lock.unlock();
+        _WriteBlock(*block);
+        lock.lock();
+        m_Writing = false;
+        m_Spare.push_back(std::move(block));
+        m_IdleCondVar.notify_all();
+    }
+}
+
+auto ClockExporter::_WriteBlock(const Block& block) -> void {
+    const auto num_frames = block.num_frames;
+    const auto num_events = block.names.size();
+    if (m_Format == eClockExportFormat::BINARY) {
+        const uint32_t sizes[] = {static_cast<uint32_t>(num_frames),  // NOLINT
+                                  static_cast<uint32_t>(num_events)};
+        WriteRaw(m_File, sizes, 2);
+        for (const auto& name : block.names) {
+            const auto name_size = static_cast<uint32_t>(name.size());
+            WriteRaw(m_File, &name_size, 1);
+            WriteRaw(m_File, name.data(), name.size());
+        }
+        WriteRaw(m_File, block.frames.data(), num_frames);
+        WriteRaw(m_File, block.wall_times.data(), num_frames);
+        for (size_t i = 0; i < num_events; i++) {
+            WriteRaw(m_File, block.durations.data() + i * m_BlockSize,
+                     num_frames);
+        }
+        return;
+    }
+
+    fmt::memory_buffer buffer;
+    auto out = std::back_inserter(buffer);
+    if (!m_CsvHeaderWritten) {
+        fmt::format_to(out, "frame,wall_time");
+        for (const auto& name : block.names) {
+            fmt::format_to(out, ",{0}", name);
+        }
+        fmt::format_to(out, "\n");
+        m_CsvHeaderWritten = true;
+    }
+    for (size_t frame = 0; frame < num_frames; frame++) {
+        fmt::format_to(out, "{0},{1:.9f}", block.frames[frame],
+                       block.wall_times[frame]);
+        for (size_t i = 0; i < num_events; i++) {
+            fmt::format_to(out, ",{0}",
+                           block.durations[i * m_BlockSize + frame]);
+        }
+        fmt::format_to(out, "\n");
+    }
+    WriteRaw(m_File, buffer.data(), buffer.size());
+}
+
+}  // namespace utils
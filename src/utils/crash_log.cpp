@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <utils/crash_log.hpp>
+
+namespace utils {
+
+namespace {
+
+/// Fixed-size ring of records owned by a single thread
+struct CrashLogRing {
+    CrashLogRing(size_t capacity, uint64_t ring_generation)
+        : records(std::max<size_t>(capacity, 1)),
+          thread_id(std::hash<std::thread::id>()(std::this_thread::get_id())),
+          generation(ring_generation) {}
+
+    /// Storage for the records (allocated once, when the ring is created)
+    std::vector<CrashLogRecord> records;
+    /// Total number of records written into this ring so far
+    std::atomic<uint64_t> num_written{0};
+    /// Hashed identifier of the thread that owns this ring
+    size_t thread_id = 0;
+    /// Generation of the crash log in which this ring was created
+    uint64_t generation = 0;
+};
+
+/// Maximum size of the path to the crash-log file (kept in a static buffer
+/// so the signal handlers don't have to touch the heap)
+constexpr size_t MAX_FILEPATH_SIZE = 512;
+
+/// Signals for which we dump the crash log before terminating
+constexpr int FATAL_SIGNALS[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL};  // NOLINT
+constexpr size_t NUM_FATAL_SIGNALS = sizeof(FATAL_SIGNALS) / sizeof(int);
+
+// NOLINTNEXTLINE : internal state of the crash-log module
+struct CrashLogState {
+    std::atomic<bool> enabled{false};
+    std::atomic<size_t> capacity{CrashLog::DEFAULT_CAPACITY};
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool> dumping{false};
+    char filepath[MAX_FILEPATH_SIZE] = {};  // NOLINT
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<CrashLogRing>> rings;
+    bool handlers_installed = false;
+#if defined(_WIN32)
+    using SignalHandler = void (*)(int);
+    SignalHandler prev_handlers[NUM_FATAL_SIGNALS] = {};  // NOLINT
+#else
+    struct sigaction prev_handlers[NUM_FATAL_SIGNALS] = {};  // NOLINT
+#endif
+};
+
+auto GetState() -> CrashLogState& {
+    static CrashLogState s_State;  // NOLINT
+    return s_State;
+}
+
+/// Ring of the calling thread, if it has one already. Unlike the handle below,
+/// a plain pointer is constant-initialized, so it can be read from a signal
+/// handler without allocating or registering anything
+thread_local CrashLogRing* s_ThreadRing = nullptr;  // NOLINT
+
+/// Thread-local handle to the ring of the calling thread. Unregisters the
+/// ring once the thread finishes
+struct CrashLogRingHandle {
+    CrashLogRingHandle() = default;
+    CrashLogRingHandle(const CrashLogRingHandle&) = delete;
+    CrashLogRingHandle(CrashLogRingHandle&&) = delete;
+    auto operator=(const CrashLogRingHandle&) -> CrashLogRingHandle& = delete;
+    auto operator=(CrashLogRingHandle&&) -> CrashLogRingHandle& = delete;
+
+    ~CrashLogRingHandle() {
+        if (ring == nullptr) {
+            return;
+        }
+        s_ThreadRing = nullptr;
+        auto& state = GetState();
+        std::lock_guard<std::mutex> lock(state.rings_mutex);
+        state.rings.erase(
+            std::remove(state.rings.begin(), state.rings.end(), ring),
+            state.rings.end());
+    }
+
+    std::shared_ptr<CrashLogRing> ring = nullptr;
+    uint64_t generation = 0;
+};
+
+auto GetThreadRing() -> CrashLogRing& {
+    static thread_local CrashLogRingHandle s_Handle;  // NOLINT
+    auto& state = GetState();
+    const auto generation = state.generation.load(std::memory_order_acquire);
+    if (s_Handle.ring == nullptr || s_Handle.generation != generation) {
+        s_Handle.ring = std::make_shared<CrashLogRing>(
+            state.capacity.load(std::memory_order_relaxed), generation);
+        s_Handle.generation = generation;
+        s_ThreadRing = s_Handle.ring.get();
+        std::lock_guard<std::mutex> lock(state.rings_mutex);
+        state.rings.push_back(s_Handle.ring);
+    }
+    return *s_Handle.ring;
+}
+
+/// Minimal writer based on raw file descriptors, which (unlike stdio) can be
+/// used from within a signal handler
+class CrashLogWriter {
+ public:
+    explicit CrashLogWriter(const char* filepath) {
+#if defined(_WIN32)
+        m_Fd = _open(filepath, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY,
+                     _S_IREAD | _S_IWRITE);
+#else
+        // NOLINTNEXTLINE
+        m_Fd = open(filepath, O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+    }
+
+    CrashLogWriter(const CrashLogWriter&) = delete;
+    CrashLogWriter(CrashLogWriter&&) = delete;
+    auto operator=(const CrashLogWriter&) -> CrashLogWriter& = delete;
+    auto operator=(CrashLogWriter&&) -> CrashLogWriter& = delete;
+
+    ~CrashLogWriter() {
+        if (m_Fd < 0) {
+            return;
+        }
+#if defined(_WIN32)
+        _close(m_Fd);
+#else
+        close(m_Fd);
+#endif
+    }
+
+    UTILS_NODISCARD auto ok() const -> bool { return m_Fd >= 0; }
+
+    auto Write(const char* data, size_t size) -> void {
+#if defined(_WIN32)
+        _write(m_Fd, data, static_cast<unsigned int>(size));
+#else
+        while (size > 0) {
+            const auto written = write(m_Fd, data, size);
+            if (written <= 0) {
+                return;
+            }
+            data += written;  // NOLINT
+            size -= static_cast<size_t>(written);
+        }
+#endif
+    }
+
+    /// Formats into a stack buffer (no heap usage) and writes it to the file
+    template <typename... Args>
+    auto Print(fmt::basic_string_view<char> fmt, const Args&... args) -> void {
+        constexpr size_t LINE_SIZE = 128;
+        char line[LINE_SIZE];  // NOLINT
+        auto result = fmt::vformat_to_n(line, LINE_SIZE, fmt,
+                                        fmt::make_format_args(args...));
+        Write(line, std::min<size_t>(result.size, LINE_SIZE));  // NOLINT
+    }
+
+ private:
+    int m_Fd = -1;
+};
+
+auto DumpRing(CrashLogWriter& writer, const CrashLogRing& ring) -> void {
+    constexpr int64_t NS_PER_SECOND = 1000000000;
+    const auto capacity = ring.records.size();
+    const auto num_written = ring.num_written.load(std::memory_order_acquire);
+    const auto num_records = std::min<uint64_t>(num_written, capacity);
+    writer.Print("---- thread {0} ({1} records) ----\n", ring.thread_id,
+                 num_records);
+    for (uint64_t i = num_written - num_records; i < num_written; i++) {
+        const auto& record = ring.records[i % capacity];
+        const auto level_name = spdlog::level::to_string_view(
+            static_cast<spdlog::level::level_enum>(record.level));
+        writer.Print("[{0}.{1:09d}] [{2}] [{3}] ",
+                     record.time_ns / NS_PER_SECOND,
+                     record.time_ns % NS_PER_SECOND,
+                     record.is_core ? "CORE" : "USER",
+                     fmt::string_view(level_name.data(), level_name.size()));
+        writer.Write(record.text, record.size);
+        writer.Write(record.truncated ? "...\n" : "\n",
+                     record.truncated ? 4 : 1);
+    }
+}
+
+auto CrashLogSignalHandler(int signal_id) -> void {
+    CrashLog::Dump(signal_id == SIGSEGV   ? "fatal signal SIGSEGV"
+                   : signal_id == SIGABRT ? "fatal signal SIGABRT"
+                   : signal_id == SIGFPE  ? "fatal signal SIGFPE"
+                                          : "fatal signal SIGILL");
+    // Restore the previous handlers and re-raise, so the default behaviour
+    // (core dump, debugger, other handlers) is preserved
+    auto& state = GetState();
+    for (size_t i = 0; i < NUM_FATAL_SIGNALS; i++) {
+        if (FATAL_SIGNALS[i] != signal_id) {  // NOLINT
+            continue;
+        }
+#if defined(_WIN32)
+        std::signal(signal_id, state.prev_handlers[i]);  // NOLINT
+#else
+        sigaction(signal_id, &state.prev_handlers[i], nullptr);  // NOLINT
+#endif
+    }
+    std::raise(signal_id);
+}
+
+}  // namespace
+
+auto CrashLog::Init(const char* filepath, size_t capacity) -> void {
+    auto& state = GetState();
+    std::strncpy(state.filepath, filepath, MAX_FILEPATH_SIZE - 1);
+    state.capacity.store(capacity, std::memory_order_relaxed);
+    if (!state.handlers_installed) {
+        for (size_t i = 0; i < NUM_FATAL_SIGNALS; i++) {
+#if defined(_WIN32)
+            state.prev_handlers[i] =  // NOLINT
+                std::signal(FATAL_SIGNALS[i], CrashLogSignalHandler);
+#else
+            struct sigaction action = {};
+            action.sa_handler = CrashLogSignalHandler;  // NOLINT
+            sigemptyset(&action.sa_mask);
+            sigaction(FATAL_SIGNALS[i], &action,         // NOLINT
+                      &state.prev_handlers[i]);          // NOLINT
+#endif
+        }
+        state.handlers_installed = true;
+    }
+    state.enabled.store(true, std::memory_order_release);
+}
+
+auto CrashLog::Release() -> void {
+    auto& state = GetState();
+    state.enabled.store(false, std::memory_order_release);
+    if (state.handlers_installed) {
+        for (size_t i = 0; i < NUM_FATAL_SIGNALS; i++) {
+#if defined(_WIN32)
+            std::signal(FATAL_SIGNALS[i], state.prev_handlers[i]);  // NOLINT
+#else
+            sigaction(FATAL_SIGNALS[i], &state.prev_handlers[i],  // NOLINT
+                      nullptr);
+#endif
+        }
+        state.handlers_installed = false;
+    }
+    // Threads will lazily create a new ring if recording is enabled again
+    state.generation.fetch_add(1, std::memory_order_acq_rel);
+    std::lock_guard<std::mutex> lock(state.rings_mutex);
+    state.rings.clear();
+}
+
+auto CrashLog::IsEnabled() -> bool {
+    return GetState().enabled.load(std::memory_order_relaxed);
+}
+
+auto CrashLog::Dump(const char* reason) -> void {
+    auto& state = GetState();
+    // Avoid re-entrancy (e.g. a fatal signal raised while dumping)
+    if (!state.enabled.load() || state.dumping.exchange(true)) {
+        return;
+    }
+    CrashLogWriter writer(state.filepath);
+    if (writer.ok()) {
+        writer.Print("==== crash log: {0} ====\n", fmt::string_view(reason));
+        // The registry might be locked by the crashing thread, in which case
+        // we can only dump the ring of the calling thread (if it has a ring of
+        // the current session; creating one here isn't signal-safe)
+        std::unique_lock<std::mutex> lock(state.rings_mutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            for (const auto& ring : state.rings) {
+                DumpRing(writer, *ring);
+            }
+        } else if (s_ThreadRing != nullptr &&
+                   s_ThreadRing->generation ==
+                       state.generation.load(std::memory_order_acquire)) {
+            DumpRing(writer, *s_ThreadRing);
+        }
+    }
+    state.dumping.store(false);
+}
+
+auto CrashLog::_AcquireRecord(bool is_core, spdlog::level::level_enum level)
+    -> CrashLogRecord* {
+    if (!GetState().enabled.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    auto& ring = GetThreadRing();
+    const auto index = ring.num_written.load(std::memory_order_relaxed);
+    auto& record = ring.records[index % ring.records.size()];
+    record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    record.level = static_cast<uint8_t>(level);
+    record.is_core = is_core;
+    record.truncated = false;
+    record.size = 0;
+    ring.num_written.store(index + 1, std::memory_order_release);
+    return &record;
+}
+
+}  // namespace utils
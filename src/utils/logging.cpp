@@ -1,14 +1,86 @@
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
 #include <stdexcept>
 
+#include <spdlog/pattern_formatter.h>
+
 #include <utils/logging.hpp>
 
 namespace utils {
 
+namespace {
+
+/// Pattern used by json-lines sinks (the record's fields are placed at %v)
+constexpr const char* KV_JSON_PATTERN =
+    R"({"time":"%Y-%m-%dT%H:%M:%S.%f","logger":"%n","level":"%l",%v})";
+
+/// Configures the given kv-logger to emit the encoded records as they are
+auto SetupKvLogger(spdlog::logger& logger, eKvFormat kv_format) -> void {
+    if (kv_format == eKvFormat::JSON_LINES) {
+        logger.set_formatter(std::unique_ptr<spdlog::formatter>(
+            new spdlog::pattern_formatter(KV_JSON_PATTERN)));
+    } else {
+        // Binary records are self-contained (no metadata, no line-endings)
+        logger.set_formatter(
+            std::unique_ptr<spdlog::formatter>(new spdlog::pattern_formatter(
+                "%v", spdlog::pattern_time_type::local, "")));
+    }
+    logger.set_level(spdlog::level::trace);
+}
+
+}  // namespace
+
+auto GetThreadKvBuffer() -> KvBuffer& {
+    static thread_local KvBuffer s_KvBuffer;  // NOLINT
+    return s_KvBuffer;
+}
+
+namespace kv {
+
+auto AppendJsonString(KvBuffer& buffer, spdlog::string_view_t str) -> void {
+    constexpr const char* HEX_DIGITS = "0123456789abcdef";
+    constexpr unsigned char FIRST_PRINTABLE = 0x20;
+    buffer.push_back('"');
+    for (const char ch : str) {
+        switch (ch) {
+            case '"':
+                AppendText(buffer, "\\\"");
+                break;
+            case '\\':
+                AppendText(buffer, "\\\\");
+                break;
+            case '\n':
+                AppendText(buffer, "\\n");
+                break;
+            case '\r':
+                AppendText(buffer, "\\r");
+                break;
+            case '\t':
+                AppendText(buffer, "\\t");
+                break;
+            default: {
+                const auto code = static_cast<unsigned char>(ch);
+                if (code < FIRST_PRINTABLE) {
+                    AppendText(buffer, "\\u00");
+                    buffer.push_back(HEX_DIGITS[code >> 4U]);    // NOLINT
+                    buffer.push_back(HEX_DIGITS[code & 0x0fU]);  // NOLINT
+                } else {
+                    buffer.push_back(ch);
+                }
+            }
+        }
+    }
+    buffer.push_back('"');
+}
+
+}  // namespace kv
+
 // NOLINTNEXTLINE
 Logger::uptr Logger::s_Instance = nullptr;
 
-Logger::Logger(eType type) : m_Type(type) {
+Logger::Logger(eType type, eKvFormat kv_format, eAssertPolicy assert_policy)
+    : m_Type(type), m_AssertPolicy(assert_policy), m_KvFormat(kv_format) {
     spdlog::set_pattern("%^[%T] %n: %v%$");
     switch (m_Type) {
         case ::utils::Logger::eType::CONSOLE_LOGGER: {
@@ -16,6 +88,13 @@ Logger::Logger(eType type) : m_Type(type) {
             m_CoreLogger->set_level(spdlog::level::trace);
             m_ClientLogger = spdlog::stdout_color_mt("USER");
             m_ClientLogger->set_level(spdlog::level::trace);
+            if (m_KvFormat == eKvFormat::BINARY) {
+                std::cout << "Logger >>> binary key-value records are not "
+                             "supported on the console. Using json-lines\n";
+                m_KvFormat = eKvFormat::JSON_LINES;
+            }
+            m_CoreKvLogger = spdlog::stdout_logger_mt("CORE_KV");
+            m_ClientKvLogger = spdlog::stdout_logger_mt("USER_KV");
             break;
         }
         case ::utils::Logger::eType::FILE_LOGGER: {
@@ -26,6 +105,13 @@ Logger::Logger(eType type) : m_Type(type) {
                 m_ClientLogger =
                     spdlog::basic_logger_mt("USER", "./user_logs.txt");
                 m_ClientLogger->set_level(spdlog::level::trace);
+                const bool IS_BINARY = (m_KvFormat == eKvFormat::BINARY);
+                m_CoreKvLogger = spdlog::basic_logger_mt(
+                    "CORE_KV",
+                    IS_BINARY ? "./core_logs.bin" : "./core_logs.jsonl");
+                m_ClientKvLogger = spdlog::basic_logger_mt(
+                    "USER_KV",
+                    IS_BINARY ? "./user_logs.bin" : "./user_logs.jsonl");
             } catch (const spdlog::spdlog_ex& ex) {
                 std::cout << "Logger initialization FAILED: " << ex.what()
                           << '\n';
@@ -33,6 +119,12 @@ Logger::Logger(eType type) : m_Type(type) {
             break;
         }
     }
+    if (m_CoreKvLogger != nullptr && m_ClientKvLogger != nullptr) {
+        SetupKvLogger(*m_CoreKvLogger, m_KvFormat);
+        SetupKvLogger(*m_ClientKvLogger, m_KvFormat);
+    }
+    // Keep the last messages of each thread around, in case we crash
+    CrashLog::Init();
     m_Ready = true;
 
     std::cout << "Initialized Logging module :)\n";
@@ -42,19 +134,24 @@ auto Logger::GetInstance() -> Logger& {
     if (Logger::s_Instance == nullptr) {
         // By default, if not initialized, use a console logger
         Logger::s_Instance =
-            std::unique_ptr<Logger>(new Logger(Logger::eType::CONSOLE_LOGGER));
+            std::unique_ptr<Logger>(new Logger(Logger::eType::CONSOLE_LOGGER,
+                                               eKvFormat::JSON_LINES,
+                                               eAssertPolicy::EXIT));
     }
     return *Logger::s_Instance;
 }
 
-auto Logger::Init(eType logger_type) -> void {
+auto Logger::Init(eType logger_type, eKvFormat kv_format,
+                  eAssertPolicy assert_policy) -> void {
     if (Logger::s_Instance == nullptr) {
-        Logger::s_Instance = std::unique_ptr<Logger>(new Logger(logger_type));
+        Logger::s_Instance = std::unique_ptr<Logger>(
+            new Logger(logger_type, kv_format, assert_policy));
     }
 }
 
 auto Logger::Release() -> void {
     Logger::s_Instance = nullptr;
+    CrashLog::Release();
     spdlog::drop_all();
 }
 
@@ -94,4 +191,84 @@ auto Logger::client_logger() const -> const spdlog::logger& {
     return *m_ClientLogger;
 }
 
+auto Logger::_OnAssertFailed(bool is_core, const char* expr, const char* file,
+                             int line, spdlog::string_view_t msg) -> void {
+    auto& instance = Logger::GetInstance();
+    auto& logger = is_core ? instance.core_logger() : instance.client_logger();
+    fmt::memory_buffer text;
+    if (expr != nullptr && expr[0] != '\0') {
+        fmt::format_to(std::back_inserter(text),
+                       "Assertion `{0}` failed at {1}:{2} >>> ", expr, file,
+                       line);
+    }
+    text.append(msg.data(), msg.data() + msg.size());
+    _Log(logger, is_core, spdlog::level::critical, "{0}",
+         spdlog::string_view_t(text.data(), text.size()));
+
+    switch (instance.assert_policy()) {
+        case eAssertPolicy::EXIT: {
+            logger.flush();
+            CrashLog::Dump("failed assertion");
+            exit(EXIT_FAILURE);
+        }
+        case eAssertPolicy::ABORT: {
+            logger.flush();
+            std::abort();
+        }
+        case eAssertPolicy::THROW:
+            throw AssertionError(std::string(text.data(), text.size()));
+        case eAssertPolicy::DEBUG_BREAK: {
+#if defined(_MSC_VER)
+            __debugbreak();
+#elif defined(SIGTRAP)
+            std::raise(SIGTRAP);
+#else
+            std::abort();
+#endif
+            break;
+        }
+        case eAssertPolicy::LOG_AND_CONTINUE:
+            break;
+    }
+}
+
+auto Logger::CoreLog(spdlog::level::level_enum level,
+                     spdlog::string_view_t msg) -> void {
+    _Log(Logger::GetInstance().core_logger(), true, level, "{0}", msg);
+}
+
+auto Logger::ClientLog(spdlog::level::level_enum level,
+                       spdlog::string_view_t msg) -> void {
+    _Log(Logger::GetInstance().client_logger(), false, level, "{0}", msg);
+}
+
+auto Logger::LogSuppressed(bool is_core, spdlog::level::level_enum level,
+                           uint64_t num_suppressed, const char* file,
+                           int line) -> void {
+    auto& logger = is_core ? Logger::GetInstance().core_logger()
+                           : Logger::GetInstance().client_logger();
+    logger.log(level,
+               "{0}:{1} >>> suppressed {2} message(s) from this call-site "
+               "(rate-limited)",
+               file, line, num_suppressed);
+}
+
+auto Logger::core_kv_logger() -> spdlog::logger& {
+    if (m_CoreKvLogger == nullptr) {
+        throw std::runtime_error(
+            "Logger::core_kv_logger >>> Should initialize the logger before "
+            "using the internal spdlog capabilities");
+    }
+    return *m_CoreKvLogger;
+}
+
+auto Logger::client_kv_logger() -> spdlog::logger& {
+    if (m_ClientKvLogger == nullptr) {
+        throw std::runtime_error(
+            "Logger::client_kv_logger >>> Should initialize the logger before "
+            "using the internal spdlog capabilities");
+    }
+    return *m_ClientKvLogger;
+}
+
 }  // namespace utils
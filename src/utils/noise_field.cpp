@@ -0,0 +1,168 @@
+#include <cmath>
+
+#include <utils/noise_field.hpp>
+
+namespace utils {
+
+NoiseField::NoiseField(const PerlinNoiseGenerator& generator, float spacing,
+                       size_t chunk_size, size_t max_chunks)
+    : NoiseField(generator, spacing, chunk_size, max_chunks,
+                 ThreadPool::GetDefault()) {}
+
+NoiseField::NoiseField(const PerlinNoiseGenerator& generator, float spacing,
+                       size_t chunk_size, size_t max_chunks, ThreadPool& pool)
+    : m_Spacing(spacing),
+      m_ChunkSize(chunk_size),
+      m_MaxChunks(max_chunks),
+      m_Source(std::make_shared<const Source>(
+          Source{generator, spacing, chunk_size})),
+      m_Pool(&pool) {
+    LOG_CORE_ASSERT(m_Spacing > 0.0F,
+                    "NoiseField >>> spacing must be positive, got {0}",
+                    m_Spacing);
+    LOG_CORE_ASSERT(m_ChunkSize > 0 && m_MaxChunks > 0,
+                    "NoiseField >>> chunk size ({0}) and max number of "
+                    "chunks ({1}) must be positive",
+                    m_ChunkSize, m_MaxChunks);
+}
+
+auto NoiseField::Sample(float x, float y) -> float {
+    // Cell of the grid that contains the position, and the chunk of the cell
+    const float grid_x = x / m_Spacing;
+    const float grid_y = y / m_Spacing;
+    const float floor_x = std::floor(grid_x);
+    const float floor_y = std::floor(grid_y);
+    const auto cell_x = static_cast<int64_t>(floor_x);
+    const auto cell_y = static_cast<int64_t>(floor_y);
+    const auto size = static_cast<int64_t>(m_ChunkSize);
+    const auto chunk_x = _FloorDiv(cell_x, size);
+    const auto chunk_y = _FloorDiv(cell_y, size);
+
+    bool is_new = false;
+    const auto chunk = _GetChunk(static_cast<int32_t>(chunk_x),
+                                 static_cast<int32_t>(chunk_y), &is_new);
+    (is_new ? m_NumMisses : m_NumHits).fetch_add(1, std::memory_order_relaxed);
+    _Generate(*m_Source, *chunk);
+
+    const auto local_x = static_cast<size_t>(cell_x - chunk_x * size);
+    const auto local_y = static_cast<size_t>(cell_y - chunk_y * size);
+    const size_t stride = m_ChunkSize + 1;
+    const float* row_0 =
+        chunk->values.data() + local_y * stride + local_x;  // NOLINT
+    const float* row_1 = row_0 + stride;                    // NOLINT
+
+    const float t_x = grid_x - floor_x;
+    const float t_y = grid_y - floor_y;
+    const float value_0 = row_0[0] + t_x * (row_0[1] - row_0[0]);  // NOLINT
+    const float value_1 = row_1[0] + t_x * (row_1[1] - row_1[0]);  // NOLINT
+    return value_0 + t_y * (value_1 - value_0);
+}
+
+auto NoiseField::Sample(const Vec2& xy) -> float {
+    return Sample(xy.x(), xy.y());
+}
+
+auto NoiseField::Prefetch(float x, float y, size_t radius) -> void {
+    const auto size = static_cast<int64_t>(m_ChunkSize);
+    const auto center_x = static_cast<int32_t>(
+        _FloorDiv(static_cast<int64_t>(std::floor(x / m_Spacing)), size));
+    const auto center_y = static_cast<int32_t>(
+        _FloorDiv(static_cast<int64_t>(std::floor(y / m_Spacing)), size));
+    const auto extent = static_cast<int32_t>(radius);
+
+    // The center goes last, so it's the most recently used of the chunks
+    // (and the last one to be evicted)
+    std::vector<std::shared_ptr<Chunk>> new_chunks;
+    for (int32_t dy = -extent; dy <= extent; dy++) {
+        for (int32_t dx = -extent; dx <= extent; dx++) {
+            if (dx == 0 && dy == 0) {
+                continue;
+            }
+            bool is_new = false;
+            auto chunk = _GetChunk(center_x + dx, center_y + dy, &is_new);
+            if (is_new) {
+                new_chunks.push_back(std::move(chunk));
+            }
+        }
+    }
+    bool is_new = false;
+    auto center = _GetChunk(center_x, center_y, &is_new);
+    if (is_new) {
+        new_chunks.push_back(std::move(center));
+    }
+
+    // The tasks only hold the chunk and the settings, so they don't depend on
+    // the field being alive (or the chunk being still cached)
+    for (auto& chunk : new_chunks) {
+        const auto source = m_Source;
+        m_Pool->Submit([source, chunk]() { _Generate(*source, *chunk); });
+    }
+}
+
+auto NoiseField::Clear() -> void {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_ChunksIndex.clear();
+    m_Chunks.clear();
+}
+
+auto NoiseField::num_cached_chunks() const -> size_t {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Chunks.size();
+}
+
+auto NoiseField::_GetChunk(int32_t chunk_x, int32_t chunk_y, bool* is_new)
+    -> std::shared_ptr<Chunk> {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const auto key = _Key(chunk_x, chunk_y);
+    const auto it = m_ChunksIndex.find(key);
+    if (it != m_ChunksIndex.end()) {
+        // Move it to the front of the list (most recently used)
+        m_Chunks.splice(m_Chunks.begin(), m_Chunks, it->second);
+        *is_new = false;
+        return *it->second;
+    }
+
+    auto chunk = std::make_shared<Chunk>();
+    chunk->x = chunk_x;
+    chunk->y = chunk_y;
+    m_Chunks.push_front(chunk);
+    m_ChunksIndex[key] = m_Chunks.begin();
+    while (m_Chunks.size() > m_MaxChunks) {
+        // Chunks still in use (or being generated) are kept alive by their
+        // users, and are just dropped from the cache
+        const auto& last = m_Chunks.back();
+        m_ChunksIndex.erase(_Key(last->x, last->y));
+        m_Chunks.pop_back();
+    }
+    *is_new = true;
+    return chunk;
+}
+
+auto NoiseField::_Generate(const Source& source, Chunk& chunk) -> void {
+    std::call_once(chunk.generated, [&source, &chunk]() {
+        const size_t num_samples = source.chunk_size + 1;
+        const auto size = static_cast<int64_t>(source.chunk_size);
+        const auto first_cell_x = static_cast<int64_t>(chunk.x) * size;
+        const auto first_cell_y = static_cast<int64_t>(chunk.y) * size;
+        const Vec2 origin(static_cast<float>(first_cell_x) * source.spacing,
+                          static_cast<float>(first_cell_y) * source.spacing);
+        chunk.values.resize(num_samples * num_samples);
+        source.generator.SampleGrid2d(origin,
+                                      Vec2(source.spacing, source.spacing),
+                                      num_samples, num_samples,
+                                      chunk.values.data());
+    });
+}
+
+auto NoiseField::_Key(int32_t chunk_x, int32_t chunk_y) -> uint64_t {
+    constexpr uint64_t SHIFT = 32;
+    return (static_cast<uint64_t>(static_cast<uint32_t>(chunk_x)) << SHIFT) |
+           static_cast<uint64_t>(static_cast<uint32_t>(chunk_y));
+}
+
+auto NoiseField::_FloorDiv(int64_t value, int64_t divisor) -> int64_t {
+    const int64_t quotient = value / divisor;
+    return (value % divisor < 0) ? quotient - 1 : quotient;
+}
+
+}  // namespace utils
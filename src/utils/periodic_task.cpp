@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+#include <utils/periodic_task.hpp>
+#include <utils/scheduler.hpp>
+
+namespace utils {
+
+namespace {
+
+constexpr double NS_TO_SECONDS = 1e-9;
+constexpr double SECONDS_TO_NS = 1e9;
+constexpr int64_t NS_PER_SECOND = 1000000000;
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram(double bucket_width, size_t num_buckets)
+    : m_BucketWidth(bucket_width > 0.0 ? bucket_width : DEFAULT_BUCKET_WIDTH),
+      m_NumBuckets(std::max<size_t>(num_buckets, 1)),
+      m_Buckets(new std::atomic<uint64_t>[m_NumBuckets + 1]) {
+    Reset();
+}
+
+auto LatencyHistogram::Push(double value) -> void {
+    auto index = size_t{0};
+    if (value > 0.0) {
+        index = std::min(static_cast<size_t>(value / m_BucketWidth),
+                         m_NumBuckets);
+    }
+    // Single writer, so there's no need for read-modify-write operations
+    auto& bucket = m_Buckets[index];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+    m_Count.store(m_Count.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+    if (value > m_Max.load(std::memory_order_relaxed)) {
+        m_Max.store(value, std::memory_order_relaxed);
+    }
+}
+
+auto LatencyHistogram::Reset() -> void {
+    for (size_t i = 0; i <= m_NumBuckets; i++) {
+        m_Buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_Count.store(0, std::memory_order_relaxed);
+    m_Max.store(0.0, std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::Quantile(double quantile) const -> double {
+    const auto count = this->count();
+    if (count == 0) {
+        return 0.0;
+    }
+    const auto target = static_cast<uint64_t>(
+        std::ceil(std::min(std::max(quantile, 0.0), 1.0) *
+                  static_cast<double>(count)));
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < m_NumBuckets; i++) {
+        accumulated += bucket(i);
+        if (accumulated >= target) {
+            return static_cast<double>(i + 1) * m_BucketWidth;
+        }
+    }
+    // The quantile lies in the overflow bucket
+    return max();
+}
+
+auto LatencyHistogram::bucket(size_t index) const -> uint64_t {
+    return (index <= m_NumBuckets)
+               ? m_Buckets[index].load(std::memory_order_relaxed)
+               : 0;
+}
+
+PeriodicTask::PeriodicTask(Callback callback, PeriodicTaskOptions options)
+    : m_Callback(std::move(callback)),
+      m_Options(std::move(options)),
+      m_PeriodNs(static_cast<int64_t>(
+          std::llround(m_Options.period * SECONDS_TO_NS))),
+      m_Latency(m_Options.histogram_bucket_width,
+                m_Options.histogram_num_buckets),
+      m_Jitter(m_Options.histogram_bucket_width,
+               m_Options.histogram_num_buckets),
+      m_Clock(m_Options.name),
+      m_Event(Clock::RegisterEvent(m_Options.name)) {
+    LOG_CORE_ASSERT(
+        m_PeriodNs > 0,
+        "PeriodicTask >>> period of task {0} must be positive, got {1}",
+        m_Options.name, m_Options.period);
+}
+
+PeriodicTask::~PeriodicTask() { Stop(); }
+
+auto PeriodicTask::Start() -> void {
+    if (m_Running.exchange(true)) {
+        return;
+    }
+    m_Thread = std::thread([this]() { _Run(); });
+}
+
+auto PeriodicTask::Stop() -> void {
+    m_Running.store(false, std::memory_order_release);
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+}
+
+auto PeriodicTask::_Run() -> void {
+    _ConfigureThread();
+    auto deadline_ns = Clock::GetTimeStampNs() + m_PeriodNs;
+    int64_t last_wakeup_ns = 0;
+    while (m_Running.load(std::memory_order_acquire)) {
+        _SleepUntil(deadline_ns);
+        const auto wakeup_ns = Clock::GetTimeStampNs();
+        m_Latency.Push(static_cast<double>(wakeup_ns - deadline_ns) *
+                       NS_TO_SECONDS);
+        if (last_wakeup_ns != 0) {
+            const auto deviation_ns =
+                std::abs((wakeup_ns - last_wakeup_ns) - m_PeriodNs);
+            m_Jitter.Push(static_cast<double>(deviation_ns) * NS_TO_SECONDS);
+        }
+        last_wakeup_ns = wakeup_ns;
+
+        m_Clock.Start(m_Event);
+        m_Callback();
+        m_Clock.Stop(m_Event);
+        m_NumPeriods.fetch_add(1, std::memory_order_relaxed);
+
+        // If the callback ran past the next deadline, skip the deadlines we
+        // missed (rather than running back-to-back to catch up)
+        deadline_ns += m_PeriodNs;
+        const auto now_ns = Clock::GetTimeStampNs();
+        if (now_ns > deadline_ns) {
+            const auto num_missed = (now_ns - deadline_ns) / m_PeriodNs + 1;
+            deadline_ns += num_missed * m_PeriodNs;
+            m_NumOverruns.fetch_add(1, std::memory_order_relaxed);
+            m_NumMissedDeadlines.fetch_add(static_cast<uint64_t>(num_missed),
+                                           std::memory_order_relaxed);
+        }
+    }
+}
+
+auto PeriodicTask::_ConfigureThread() -> void {
+#if defined(__linux__)
+    if (m_Options.cpu >= 0) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(m_Options.cpu, &cpu_set);  // NOLINT
+        const auto ret =
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (ret != 0) {
+            LOG_CORE_WARN(
+                "PeriodicTask >>> couldn't pin task {0} to cpu {1}: {2}",
+                m_Options.name, m_Options.cpu, std::strerror(ret));
+        }
+    }
+    if (m_Options.rt_priority > 0) {
+        sched_param param{};
+        param.sched_priority = m_Options.rt_priority;
+        const auto ret =
+            pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        // Usually fails with EPERM (requires CAP_SYS_NICE or an rtprio limit)
+        if (ret != 0) {
+            LOG_CORE_WARN(
+                "PeriodicTask >>> couldn't set real-time priority {0} for task "
+                "{1}: {2}",
+                m_Options.rt_priority, m_Options.name, std::strerror(ret));
+        }
+    }
+#else
+    if (m_Options.cpu >= 0 || m_Options.rt_priority > 0) {
+        LOG_CORE_WARN(
+            "PeriodicTask >>> cpu pinning and real-time priorities are only "
+            "supported on Linux (task {0})",
+            m_Options.name);
+    }
+#endif
+}
+
+auto PeriodicTask::_SleepUntil(int64_t deadline_ns) -> void {
+#if defined(__linux__)
+    // The clock used by Clock (steady_clock) is CLOCK_MONOTONIC on Linux, so
+    // the deadline can be used as an absolute time for clock_nanosleep
+    timespec deadline{};
+    deadline.tv_sec = static_cast<time_t>(deadline_ns / NS_PER_SECOND);
+    deadline.tv_nsec = static_cast<long>(deadline_ns % NS_PER_SECOND);  // NOLINT
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline,
+                           nullptr) == EINTR) {
+        // Interrupted by a signal, so keep sleeping until the deadline
+    }
+#else
+    PreciseSleepUntil(deadline_ns);
+#endif
+}
+
+}  // namespace utils
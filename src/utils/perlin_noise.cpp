@@ -1,60 +1,783 @@
+#include <algorithm>
+#include <cmath>
+
+#include <atomic>
+#include <random>
+
 #include <utils/perlin_noise.hpp>
+#include <utils/perlin_noise_kernels.hpp>
 
 namespace utils {
 
+namespace {
+
+/// Instruction set used by the batch API (shared by all generators)
+auto GetSimdLevelState() -> std::atomic<eSimdLevel>& {
+    static std::atomic<eSimdLevel> s_Level{GetSupportedSimdLevel()};  // NOLINT
+    return s_Level;
+}
+
+/// Returns a random number in [DEFAULT_RAND_MIN, DEFAULT_RAND_MAX]. Unlike the
+/// std distributions, its output is fully specified, so generators created
+/// with the same seed match across platforms
+auto RandomUniform(std::mt19937& rand_engine) -> float {
+    constexpr double MIN = PerlinNoiseGenerator::DEFAULT_RAND_MIN;
+    constexpr double MAX = PerlinNoiseGenerator::DEFAULT_RAND_MAX;
+    constexpr double RANGE = 4294967295.0;  // 2^32 - 1
+    const double t = static_cast<double>(rand_engine()) / RANGE;
+    return static_cast<float>(MIN + t * (MAX - MIN));
+}
+
+}  // namespace
+
+PerlinNoiseGenerator::PerlinNoiseGenerator(uint32_t seed, size_t num_octaves,
+                                           float persistance, float lacunarity,
+                                           float noise_scale)
+    : m_Seed(seed),
+      m_NumOctaves(num_octaves),
+      m_Persistance(persistance),
+      m_Lacunarity(lacunarity),
+      m_NoiseScale(noise_scale) {
+    std::mt19937 rand_engine(m_Seed);
+
+    // Shuffle the identity permutation (Fisher-Yates) and double it to avoid
+    // wrapping the indices of the corners
+    constexpr size_t NUM_PERMUTATIONS = PERM_TABLE_SIZE / 2;
+    for (size_t i = 0; i < NUM_PERMUTATIONS; i++) {
+        m_Permutations[i] = static_cast<uint8_t>(i);
+    }
+    for (size_t i = NUM_PERMUTATIONS - 1; i > 0; i--) {
+        const size_t k = rand_engine() % (i + 1);
+        std::swap(m_Permutations[i], m_Permutations[k]);
+    }
+    for (size_t i = 0; i < NUM_PERMUTATIONS; i++) {
+        m_Permutations[i + NUM_PERMUTATIONS] = m_Permutations[i];
+    }
+
+    // Offsets along x and y are drawn first, so adding the offsets of the
+    // other axes didn't change the 2d noise of a given seed
+    m_OctavesOffsets.resize(m_NumOctaves);
+    for (auto& offset : m_OctavesOffsets) {
+        offset.x = RandomUniform(rand_engine);
+        offset.y = RandomUniform(rand_engine);
+    }
+    for (auto& offset : m_OctavesOffsets) {
+        offset.z = RandomUniform(rand_engine);
+        offset.w = RandomUniform(rand_engine);
+    }
+}
+
+auto PerlinNoiseGenerator::WithPeriod(const Vec2& period) const
+    -> PerlinNoiseGenerator {
+    auto generator = *this;
+    generator.m_Period = period;
+    generator.m_OctavesPeriods.clear();
+    if (period.x() <= 0.0F && period.y() <= 0.0F) {
+        return generator;
+    }
+
+    // Number of cells of the lattice of each octave within a period
+    const auto num_cells = [](float period_octave) -> int32_t {
+        if (period_octave <= 0.0F) {
+            return 0;
+        }
+        return std::max(static_cast<int32_t>(std::round(period_octave)), 1);
+    };
+    float freq = 1.0F;
+    generator.m_OctavesPeriods.resize(m_NumOctaves);
+    for (auto& octave_period : generator.m_OctavesPeriods) {
+        octave_period.x = num_cells(period.x() * freq / m_NoiseScale);
+        octave_period.y = num_cells(period.y() * freq / m_NoiseScale);
+        freq *= m_Lacunarity;
+    }
+    return generator;
+}
+
+auto PerlinNoiseGenerator::Sample1d(float x) const -> float {
+    return Sample2d(x, 0.0F);
+}
+
+auto PerlinNoiseGenerator::Sample2d(float x, float y, eNoiseType type) const
+    -> float {
+    float ampl = 1.0F;
+    float freq = 1.0F;
+    float noise_value = 0.0F;
+
+    for (size_t i = 0; i < m_NumOctaves; i++) {
+        float sample_x = freq * (x / m_NoiseScale) + m_OctavesOffsets[i].x;
+        float sample_y = freq * (y / m_NoiseScale) + m_OctavesOffsets[i].y;
+        noise_value += ampl * (type == eNoiseType::SIMPLEX
+                                   ? kernels::Simplex2d(m_Permutations.data(),
+                                                        sample_x, sample_y)
+                                   : _Perlin(sample_x, sample_y, i));
+        ampl *= m_Persistance;
+        freq *= m_Lacunarity;
+    }
+    return noise_value;
+}
+
+auto PerlinNoiseGenerator::Sample2d(const Vec2& xy, eNoiseType type) const
+    -> float {
+    return Sample2d(xy.x(), xy.y(), type);
+}
+
+auto PerlinNoiseGenerator::Sample2dWithGradient(float x, float y) const
+    -> NoiseSample2d {
+    float ampl = 1.0F;
+    float freq = 1.0F;
+    float noise_value = 0.0F;
+    float noise_grad_x = 0.0F;
+    float noise_grad_y = 0.0F;
+
+    for (size_t i = 0; i < m_NumOctaves; i++) {
+        const auto& offset = m_OctavesOffsets[i];
+        const float sample_x = freq * (x / m_NoiseScale) + offset.x;
+        const float sample_y = freq * (y / m_NoiseScale) + offset.y;
+        float grad_x = 0.0F;
+        float grad_y = 0.0F;
+        noise_value += ampl * _PerlinWithGradient(sample_x, sample_y, i,
+                                                  &grad_x, &grad_y);
+        // Chain rule, as the octave is sampled at freq * (x / noise_scale)
+        const float grad_ampl = ampl * freq / m_NoiseScale;
+        noise_grad_x += grad_ampl * grad_x;
+        noise_grad_y += grad_ampl * grad_y;
+        ampl *= m_Persistance;
+        freq *= m_Lacunarity;
+    }
+    return {noise_value, Vec2(noise_grad_x, noise_grad_y)};
+}
+
+auto PerlinNoiseGenerator::Sample2dWithGradient(const Vec2& xy) const
+    -> NoiseSample2d {
+    return Sample2dWithGradient(xy.x(), xy.y());
+}
+
+auto PerlinNoiseGenerator::Sample3d(float x, float y, float z,
+                                    eNoiseType type) const -> float {
+    const auto* perm = m_Permutations.data();
+    float ampl = 1.0F;
+    float freq = 1.0F;
+    float noise_value = 0.0F;
+
+    for (const auto& offset : m_OctavesOffsets) {
+        const float sample_x = freq * (x / m_NoiseScale) + offset.x;
+        const float sample_y = freq * (y / m_NoiseScale) + offset.y;
+        const float sample_z = freq * (z / m_NoiseScale) + offset.z;
+        noise_value += ampl * (type == eNoiseType::SIMPLEX
+                                   ? kernels::Simplex3d(perm, sample_x,
+                                                        sample_y, sample_z)
+                                   : kernels::Perlin3d(perm, sample_x,
+                                                       sample_y, sample_z));
+        ampl *= m_Persistance;
+        freq *= m_Lacunarity;
+    }
+    return noise_value;
+}
+
+auto PerlinNoiseGenerator::Sample3d(const Vec3& xyz, eNoiseType type) const
+    -> float {
+    return Sample3d(xyz.x(), xyz.y(), xyz.z(), type);
+}
+
+auto PerlinNoiseGenerator::Sample4d(float x, float y, float z, float w,
+                                    eNoiseType type) const -> float {
+    const auto* perm = m_Permutations.data();
+    float ampl = 1.0F;
+    float freq = 1.0F;
+    float noise_value = 0.0F;
+
+    for (const auto& offset : m_OctavesOffsets) {
+        const float sample_x = freq * (x / m_NoiseScale) + offset.x;
+        const float sample_y = freq * (y / m_NoiseScale) + offset.y;
+        const float sample_z = freq * (z / m_NoiseScale) + offset.z;
+        const float sample_w = freq * (w / m_NoiseScale) + offset.w;
+        noise_value += ampl * (type == eNoiseType::SIMPLEX
+                                   ? kernels::Simplex4d(perm, sample_x,
+                                                        sample_y, sample_z,
+                                                        sample_w)
+                                   : kernels::Perlin4d(perm, sample_x,
+                                                       sample_y, sample_z,
+                                                       sample_w));
+        ampl *= m_Persistance;
+        freq *= m_Lacunarity;
+    }
+    return noise_value;
+}
+
+auto PerlinNoiseGenerator::SampleGrid2d(const Vec2& origin,
+                                        const Vec2& spacing, size_t width,
+                                        size_t height, float* out,
+                                        eNoiseType type) const -> void {
+    const GridDesc grid{{origin.x(), origin.y(), 0.0F, 0.0F},
+                        {spacing.x(), spacing.y(), 0.0F},
+                        width,
+                        height,
+                        1,
+                        2,
+                        type,
+                        out,
+                        nullptr,
+                        nullptr,
+                        nullptr};
+    _SampleGrid(grid, nullptr);
+}
+
+auto PerlinNoiseGenerator::SampleGrid2d(const Vec2& origin,
+                                        const Vec2& spacing, size_t width,
+                                        size_t height, float* out,
+                                        ThreadPool& pool,
+                                        eNoiseType type) const -> void {
+    const GridDesc grid{{origin.x(), origin.y(), 0.0F, 0.0F},
+                        {spacing.x(), spacing.y(), 0.0F},
+                        width,
+                        height,
+                        1,
+                        2,
+                        type,
+                        out,
+                        nullptr,
+                        nullptr,
+                        nullptr};
+    _SampleGrid(grid, &pool);
+}
+
+auto PerlinNoiseGenerator::SamplePoints2d(size_t count, const float* xs,
+                                          const float* ys, float* out) const
+    -> void {
+    for (size_t start = 0; start < count; start += POINTS_BATCH_SIZE) {
+        const size_t batch = std::min(POINTS_BATCH_SIZE, count - start);
+        _SamplePointsBatch(batch, xs + start, ys + start,  // NOLINT
+                           out + start);                   // NOLINT
+    }
+}
+
+auto PerlinNoiseGenerator::SamplePoints2d(size_t count, const float* xs,
+                                          const float* ys, float* out,
+                                          ThreadPool& pool) const -> void {
+    const size_t num_batches =
+        (count + POINTS_BATCH_SIZE - 1) / POINTS_BATCH_SIZE;
+    pool.ParallelFor(num_batches, [&](size_t batch_index) {
+        const size_t start = batch_index * POINTS_BATCH_SIZE;
+        const size_t batch = std::min(POINTS_BATCH_SIZE, count - start);
+        _SamplePointsBatch(batch, xs + start, ys + start,  // NOLINT
+                           out + start);                   // NOLINT
+    });
+}
+
+auto PerlinNoiseGenerator::SampleGrid2dWarped(const DomainWarp& warp,
+                                              const Vec2& origin,
+                                              const Vec2& spacing,
+                                              size_t width, size_t height,
+                                              float* out) const -> void {
+    const GridDesc grid{{origin.x(), origin.y(), 0.0F, 0.0F},
+                        {spacing.x(), spacing.y(), 0.0F},
+                        width,
+                        height,
+                        1,
+                        2,
+                        eNoiseType::PERLIN,
+                        out,
+                        nullptr,
+                        nullptr,
+                        &warp};
+    _SampleGrid(grid, nullptr);
+}
+
+auto PerlinNoiseGenerator::SampleGrid2dWarped(const DomainWarp& warp,
+                                              const Vec2& origin,
+                                              const Vec2& spacing,
+                                              size_t width, size_t height,
+                                              float* out,
+                                              ThreadPool& pool) const -> void {
+    const GridDesc grid{{origin.x(), origin.y(), 0.0F, 0.0F},
+                        {spacing.x(), spacing.y(), 0.0F},
+                        width,
+                        height,
+                        1,
+                        2,
+                        eNoiseType::PERLIN,
+                        out,
+                        nullptr,
+                        nullptr,
+                        &warp};
+    _SampleGrid(grid, &pool);
+}
+
+auto PerlinNoiseGenerator::SampleGrid2dWithGradient(
+    const Vec2& origin, const Vec2& spacing, size_t width, size_t height,
+    float* out, float* out_grad_x, float* out_grad_y) const -> void {
+    const GridDesc grid{{origin.x(), origin.y(), 0.0F, 0.0F},
+                        {spacing.x(), spacing.y(), 0.0F},
+                        width,
+                        height,
+                        1,
+                        2,
+                        eNoiseType::PERLIN,
+                        out,
+                        out_grad_x,
+                        out_grad_y,
+                        nullptr};
+    _SampleGrid(grid, nullptr);
+}
+
+auto PerlinNoiseGenerator::SampleGrid2dWithGradient(
+    const Vec2& origin, const Vec2& spacing, size_t width, size_t height,
+    float* out, float* out_grad_x, float* out_grad_y, ThreadPool& pool) const
+    -> void {
+    const GridDesc grid{{origin.x(), origin.y(), 0.0F, 0.0F},
+                        {spacing.x(), spacing.y(), 0.0F},
+                        width,
+                        height,
+                        1,
+                        2,
+                        eNoiseType::PERLIN,
+                        out,
+                        out_grad_x,
+                        out_grad_y,
+                        nullptr};
+    _SampleGrid(grid, &pool);
+}
+
+auto PerlinNoiseGenerator::SampleGrid3d(const Vec3& origin,
+                                        const Vec3& spacing, size_t width,
+                                        size_t height, size_t depth,
+                                        float* out, eNoiseType type) const
+    -> void {
+    const GridDesc grid{{origin.x(), origin.y(), origin.z(), 0.0F},
+                        {spacing.x(), spacing.y(), spacing.z()},
+                        width,
+                        height,
+                        depth,
+                        3,
+                        type,
+                        out,
+                        nullptr,
+                        nullptr,
+                        nullptr};
+    _SampleGrid(grid, nullptr);
+}
+
+auto PerlinNoiseGenerator::SampleGrid3d(const Vec3& origin,
+                                        const Vec3& spacing, size_t width,
+                                        size_t height, size_t depth,
+                                        float* out, ThreadPool& pool,
+                                        eNoiseType type) const -> void {
+    const GridDesc grid{{origin.x(), origin.y(), origin.z(), 0.0F},
+                        {spacing.x(), spacing.y(), spacing.z()},
+                        width,
+                        height,
+                        depth,
+                        3,
+                        type,
+                        out,
+                        nullptr,
+                        nullptr,
+                        nullptr};
+    _SampleGrid(grid, &pool);
+}
+
+auto PerlinNoiseGenerator::SampleGrid4d(const Vec3& origin,
+                                        const Vec3& spacing, float w,
+                                        size_t width, size_t height,
+                                        size_t depth, float* out,
+                                        eNoiseType type) const -> void {
+    const GridDesc grid{{origin.x(), origin.y(), origin.z(), w},
+                        {spacing.x(), spacing.y(), spacing.z()},
+                        width,
+                        height,
+                        depth,
+                        4,
+                        type,
+                        out,
+                        nullptr,
+                        nullptr,
+                        nullptr};
+    _SampleGrid(grid, nullptr);
+}
+
+auto PerlinNoiseGenerator::SampleGrid4d(const Vec3& origin,
+                                        const Vec3& spacing, float w,
+                                        size_t width, size_t height,
+                                        size_t depth, float* out,
+                                        ThreadPool& pool,
+                                        eNoiseType type) const -> void {
+    const GridDesc grid{{origin.x(), origin.y(), origin.z(), w},
+                        {spacing.x(), spacing.y(), spacing.z()},
+                        width,
+                        height,
+                        depth,
+                        4,
+                        type,
+                        out,
+                        nullptr,
+                        nullptr,
+                        nullptr};
+    _SampleGrid(grid, &pool);
+}
+
+auto PerlinNoiseGenerator::SampleGrid1d(float origin, float spacing,
+                                        size_t count, float* out) const
+    -> void {
+    // Same as Sample1d, i.e. a single row of the 2d grid at y = 0
+    SampleGrid2d(Vec2(origin, 0.0F), Vec2(spacing, 0.0F), count, 1, out);
+}
+
+auto PerlinNoiseGenerator::_SampleGrid(const GridDesc& grid,
+                                       ThreadPool* pool) const -> void {
+    if (pool == nullptr) {
+        for (size_t k = 0; k < grid.depth; k++) {
+            if (grid.warp != nullptr) {
+                _SampleGridWarpedTile(grid, 0, grid.height, 0, grid.width);
+            } else {
+                _SampleGridTile(grid, k, 0, grid.height, 0, grid.width);
+            }
+        }
+        return;
+    }
+
+    const size_t tiles_x = (grid.width + GRID_TILE_SIZE - 1) / GRID_TILE_SIZE;
+    const size_t tiles_y = (grid.height + GRID_TILE_SIZE - 1) / GRID_TILE_SIZE;
+    const size_t tiles_per_slice = tiles_x * tiles_y;
+    pool->ParallelFor(tiles_per_slice * grid.depth, [&](size_t tile) {
+        const size_t slice = tile / tiles_per_slice;
+        const size_t tile_y = (tile % tiles_per_slice) / tiles_x;
+        const size_t tile_x = (tile % tiles_per_slice) % tiles_x;
+        const size_t row_begin = tile_y * GRID_TILE_SIZE;
+        const size_t col_begin = tile_x * GRID_TILE_SIZE;
+        const size_t row_end =
+            std::min(row_begin + GRID_TILE_SIZE, grid.height);
+        const size_t col_end = std::min(col_begin + GRID_TILE_SIZE, grid.width);
+        if (grid.warp != nullptr) {
+            _SampleGridWarpedTile(grid, row_begin, row_end, col_begin, col_end);
+        } else {
+            _SampleGridTile(grid, slice, row_begin, row_end, col_begin,
+                            col_end);
+        }
+    });
+}
+
+auto PerlinNoiseGenerator::_SampleGridTile(const GridDesc& grid, size_t slice,
+                                           size_t row_begin, size_t row_end,
+                                           size_t col_begin,
+                                           size_t col_end) const -> void {
+    float* out = grid.out + slice * grid.width * grid.height;  // NOLINT
+    const size_t num_cols = col_end - col_begin;
+    const bool with_gradient = (grid.out_grad_x != nullptr);
+    for (size_t i = row_begin; i < row_end; i++) {
+        auto* row = out + i * grid.width + col_begin;  // NOLINT
+        std::fill(row, row + num_cols, 0.0F);          // NOLINT
+        if (with_gradient) {
+            std::fill(grid.out_grad_x + i * grid.width + col_begin,  // NOLINT
+                      grid.out_grad_x + i * grid.width + col_end,    // NOLINT
+                      0.0F);
+            std::fill(grid.out_grad_y + i * grid.width + col_begin,  // NOLINT
+                      grid.out_grad_y + i * grid.width + col_end,    // NOLINT
+                      0.0F);
+        }
+    }
+
+    // Position of each column, and its lattice data (shared by all the rows
+    // of an octave)
+    std::vector<float> cols_sample(num_cols);
+    std::vector<int32_t> cols_index(num_cols);
+    std::vector<int32_t> cols_index_next(num_cols);
+    std::vector<float> cols_frac(num_cols);
+    std::vector<float> cols_fade(num_cols);
+    std::vector<float> cols_fade_deriv(with_gradient ? num_cols : 0);
+
+    // The vectorized kernels gather 32-bit words, so they work on a widened
+    // copy of the table (cheap compared to sampling a tile, and it stays in
+    // L1 while the tile is sampled)
+    std::array<int32_t, PERM_TABLE_SIZE> perm;  // NOLINT
+    std::copy(m_Permutations.begin(), m_Permutations.end(), perm.begin());
+
+    kernels::PerlinRowArgs args{};
+    args.perm = perm.data();
+    args.cols_index = cols_index.data();
+    args.cols_index_next = cols_index_next.data();
+    args.cols_frac = cols_frac.data();
+    args.cols_fade = cols_fade.data();
+    args.width = num_cols;
+    kernels::PerlinRowNdArgs args_nd{};
+    args_nd.perm = m_Permutations.data();
+    args_nd.cols_index = cols_index.data();
+    args_nd.cols_frac = cols_frac.data();
+    args_nd.cols_fade = cols_fade.data();
+    args_nd.width = num_cols;
+    kernels::PerlinRowGradArgs args_grad{};
+    args_grad.row = args;
+    args_grad.cols_fade_deriv = cols_fade_deriv.data();
+    const auto simd_level = PerlinNoise::GetSimdLevel();
+
+    // Same operations (and order) as the per-sample API, so results match
+    // exactly (samples are placed using the indices in the whole grid, so
+    // tiles match the sequential version too)
+    const float z =
+        grid.origin[2] + static_cast<float>(slice) * grid.spacing[2];
+    const float w = grid.origin[3];
+    float ampl = 1.0F;
+    float freq = 1.0F;
+    for (size_t octave = 0; octave < m_NumOctaves; octave++) {
+        const auto& offset = m_OctavesOffsets[octave];
+        // Only the 2d perlin-noise is periodic (the 3d and 4d kernels always
+        // use the next index of the table)
+        const auto period = (grid.num_dims == 2) ? _GetOctavePeriod(octave)
+                                                 : OctavePeriod{0, 0};
+        for (size_t j = col_begin; j < col_end; j++) {
+            const float x =
+                grid.origin[0] + static_cast<float>(j) * grid.spacing[0];
+            const size_t k = j - col_begin;
+            cols_sample[k] = freq * (x / m_NoiseScale) + offset.x;
+            const float floor_x = std::floor(cols_sample[k]);
+            _LatticeIndex(floor_x, period.x, &cols_index[k],
+                          &cols_index_next[k]);
+            cols_frac[k] = cols_sample[k] - floor_x;
+            cols_fade[k] = _Fade(cols_frac[k]);
+            if (with_gradient) {
+                cols_fade_deriv[k] = _FadeDerivative(cols_frac[k]);
+            }
+        }
+        const float sample_z = freq * (z / m_NoiseScale) + offset.z;
+        const float sample_w = freq * (w / m_NoiseScale) + offset.w;
+
+        args.ampl = ampl;
+        args_nd.ampl = ampl;
+        args_grad.row.ampl = ampl;
+        args_grad.grad_scale = freq / m_NoiseScale;
+        for (size_t i = row_begin; i < row_end; i++) {
+            const float y =
+                grid.origin[1] + static_cast<float>(i) * grid.spacing[1];
+            const float sample_y = freq * (y / m_NoiseScale) + offset.y;
+            float* row = out + i * grid.width + col_begin;  // NOLINT
+
+            if (grid.type == eNoiseType::SIMPLEX) {
+                // The lattice of simplex-noise is skewed, so its cells can't
+                // be shared across a row, and each sample is evaluated alone
+                const auto* table = m_Permutations.data();
+                for (size_t k = 0; k < num_cols; k++) {
+                    const float sample_x = cols_sample[k];
+                    float noise = 0.0F;
+                    if (grid.num_dims == 2) {
+                        noise = kernels::Simplex2d(table, sample_x, sample_y);
+                    } else if (grid.num_dims == 3) {
+                        noise = kernels::Simplex3d(table, sample_x, sample_y,
+                                                   sample_z);
+                    } else {
+                        noise = kernels::Simplex4d(table, sample_x, sample_y,
+                                                   sample_z, sample_w);
+                    }
+                    row[k] += ampl * noise;  // NOLINT
+                }
+                continue;
+            }
+
+            const float floor_y = std::floor(sample_y);
+            int32_t index_y = 0;
+            int32_t index_y_next = 0;
+            _LatticeIndex(floor_y, period.y, &index_y, &index_y_next);
+            const float frac_y = sample_y - floor_y;
+            if (with_gradient) {
+                const size_t row_offset = i * grid.width + col_begin;
+                args_grad.row.row_index = index_y;
+                args_grad.row.row_index_next = index_y_next;
+                args_grad.row.row_frac = frac_y;
+                args_grad.row.row_fade = _Fade(frac_y);
+                args_grad.row.out = row;
+                args_grad.row_fade_deriv = _FadeDerivative(frac_y);
+                args_grad.out_grad_x = grid.out_grad_x + row_offset;  // NOLINT
+                args_grad.out_grad_y = grid.out_grad_y + row_offset;  // NOLINT
+                kernels::PerlinRow2dWithGradient(args_grad);
+                continue;
+            }
+            if (grid.num_dims == 2) {
+                args.row_index = index_y;
+                args.row_index_next = index_y_next;
+                args.row_frac = frac_y;
+                args.row_fade = _Fade(frac_y);
+                args.out = row;
+                kernels::PerlinRow2d(simd_level, args);
+                continue;
+            }
+
+            const float floor_z = std::floor(sample_z);
+            const float floor_w = std::floor(sample_w);
+            args_nd.row_index[0] = index_y;
+            args_nd.row_index[1] = static_cast<int32_t>(floor_z) & 255;
+            args_nd.row_index[2] = static_cast<int32_t>(floor_w) & 255;
+            args_nd.row_frac[0] = frac_y;
+            args_nd.row_frac[1] = sample_z - floor_z;
+            args_nd.row_frac[2] = sample_w - floor_w;
+            for (size_t a = 0; a < 3; a++) {
+                args_nd.row_fade[a] = _Fade(args_nd.row_frac[a]);  // NOLINT
+            }
+            args_nd.out = row;
+            if (grid.num_dims == 3) {
+                kernels::PerlinRow3d(args_nd);
+            } else {
+                kernels::PerlinRow4d(args_nd);
+            }
+        }
+        ampl *= m_Persistance;
+        freq *= m_Lacunarity;
+    }
+}
+
+auto PerlinNoiseGenerator::_SampleGridWarpedTile(const GridDesc& grid,
+                                                 size_t row_begin,
+                                                 size_t row_end,
+                                                 size_t col_begin,
+                                                 size_t col_end) const
+    -> void {
+    const size_t num_cols = col_end - col_begin;
+    std::vector<float> xs(num_cols);
+    std::vector<float> ys(num_cols);
+    for (size_t i = row_begin; i < row_end; i++) {
+        const float y =
+            grid.origin[1] + static_cast<float>(i) * grid.spacing[1];
+        for (size_t j = col_begin; j < col_end; j++) {
+            xs[j - col_begin] =
+                grid.origin[0] + static_cast<float>(j) * grid.spacing[0];
+            ys[j - col_begin] = y;
+        }
+        grid.warp->WarpPoints(num_cols, xs.data(), ys.data());
+        SamplePoints2d(num_cols, xs.data(), ys.data(),
+                       grid.out + i * grid.width + col_begin);  // NOLINT
+    }
+}
+
+auto PerlinNoiseGenerator::_SamplePointsBatch(size_t count, const float* xs,
+                                              const float* ys,
+                                              float* out) const -> void {
+    std::fill(out, out + count, 0.0F);  // NOLINT
+
+    // Lattice data of each point, for the current octave
+    std::vector<int32_t> index_x(count);
+    std::vector<int32_t> index_y(count);
+    std::vector<int32_t> index_x_next(count);
+    std::vector<int32_t> index_y_next(count);
+    std::vector<float> frac_x(count);
+    std::vector<float> frac_y(count);
+    std::vector<float> fade_x(count);
+    std::vector<float> fade_y(count);
+
+    // Widened copy of the table for the vectorized kernels (see
+    // _SampleGridTile)
+    std::array<int32_t, PERM_TABLE_SIZE> perm;  // NOLINT
+    std::copy(m_Permutations.begin(), m_Permutations.end(), perm.begin());
+
+    kernels::PerlinPointsArgs args{};
+    args.perm = perm.data();
+    args.index_x = index_x.data();
+    args.index_y = index_y.data();
+    args.index_x_next = index_x_next.data();
+    args.index_y_next = index_y_next.data();
+    args.frac_x = frac_x.data();
+    args.frac_y = frac_y.data();
+    args.fade_x = fade_x.data();
+    args.fade_y = fade_y.data();
+    args.count = count;
+    args.out = out;
+    const auto simd_level = PerlinNoise::GetSimdLevel();
+
+    // Same operations (and order) as the per-sample API
+    float ampl = 1.0F;
+    float freq = 1.0F;
+    for (size_t octave = 0; octave < m_NumOctaves; octave++) {
+        const auto& offset = m_OctavesOffsets[octave];
+        const auto period = _GetOctavePeriod(octave);
+        for (size_t k = 0; k < count; k++) {
+            const float sample_x = freq * (xs[k] / m_NoiseScale) + offset.x;
+            const float sample_y = freq * (ys[k] / m_NoiseScale) + offset.y;
+            const float floor_x = std::floor(sample_x);
+            const float floor_y = std::floor(sample_y);
+            _LatticeIndex(floor_x, period.x, &index_x[k], &index_x_next[k]);
+            _LatticeIndex(floor_y, period.y, &index_y[k], &index_y_next[k]);
+            frac_x[k] = sample_x - floor_x;
+            frac_y[k] = sample_y - floor_y;
+            fade_x[k] = _Fade(frac_x[k]);
+            fade_y[k] = _Fade(frac_y[k]);
+        }
+        args.ampl = ampl;
+        kernels::PerlinPoints2d(simd_level, args);
+        ampl *= m_Persistance;
+        freq *= m_Lacunarity;
+    }
+}
+
+auto PerlinNoiseGenerator::_GetOctavePeriod(size_t octave) const
+    -> OctavePeriod {
+    if (m_OctavesPeriods.empty()) {
+        return {0, 0};
+    }
+    return m_OctavesPeriods[octave];
+}
+
+auto PerlinNoiseGenerator::_LatticeIndex(float cell, int32_t period,
+                                         int32_t* index, int32_t* index_next)
+    -> void {
+    const auto cell_index = static_cast<int32_t>(cell);
+    if (period <= 0) {
+        // Wrap around by 256 (the table is doubled, so the next index can be
+        // 256 too)
+        *index = cell_index & 255;
+        *index_next = *index + 1;
+        return;
+    }
+    // Wrap by the period first, so the hashes of the corners (which only
+    // depend on the wrapped cells) repeat every period cells
+    const int32_t wrapped = ((cell_index % period) + period) % period;
+    *index = wrapped & 255;
+    *index_next = ((wrapped + 1) % period) & 255;
+}
+
+auto DomainWarp::Then(const PerlinNoiseGenerator& generator,
+                      float amplitude) const -> DomainWarp {
+    auto warp = *this;
+    warp.m_Stages.push_back({generator, amplitude});
+    return warp;
+}
+
+auto DomainWarp::Warp(float x, float y) const -> Vec2 {
+    for (const auto& stage : m_Stages) {
+        const float disp_x = stage.generator.Sample2d(x, y);
+        const float disp_y =
+            stage.generator.Sample2d(x + WARP_SHIFT_X, y + WARP_SHIFT_Y);
+        x += stage.amplitude * disp_x;
+        y += stage.amplitude * disp_y;
+    }
+    return {x, y};
+}
+
+auto DomainWarp::WarpPoints(size_t count, float* xs, float* ys) const -> void {
+    if (m_Stages.empty()) {
+        return;
+    }
+    std::vector<float> shifted_xs(count);
+    std::vector<float> shifted_ys(count);
+    std::vector<float> disp_x(count);
+    std::vector<float> disp_y(count);
+    for (const auto& stage : m_Stages) {
+        for (size_t k = 0; k < count; k++) {
+            shifted_xs[k] = xs[k] + WARP_SHIFT_X;  // NOLINT
+            shifted_ys[k] = ys[k] + WARP_SHIFT_Y;  // NOLINT
+        }
+        stage.generator.SamplePoints2d(count, xs, ys, disp_x.data());
+        stage.generator.SamplePoints2d(count, shifted_xs.data(),
+                                       shifted_ys.data(), disp_y.data());
+        for (size_t k = 0; k < count; k++) {
+            xs[k] += stage.amplitude * disp_x[k];  // NOLINT
+            ys[k] += stage.amplitude * disp_y[k];  // NOLINT
+        }
+    }
+}
+
 // @todo(wilbert): The variables below are not actually accessible, but
 // could should think about it making it const? (will disable lint for now)
-std::unique_ptr<PerlinNoise> PerlinNoise::s_Instance = nullptr;  // NOLINT
+// NOLINTNEXTLINE
+std::unique_ptr<PerlinNoiseGenerator> PerlinNoise::s_Instance = nullptr;
 
 auto PerlinNoise::Init() -> void {
-    // Initialize singleton (can't use make_unique for now, as const is private)
-    if (!s_Instance) {
-        s_Instance = std::make_unique<PerlinNoise>();
-    }
-
-    // Initialize uniform distribution
-    s_Instance->m_RandUnifDist = std::uniform_real_distribution<float>(
-        DEFAULT_RAND_MIN, DEFAULT_RAND_MAX);
-
-    s_Instance->m_NumOctaves = DEFAULT_NUM_OCTAVES;
-    s_Instance->m_Persistance = DEFAULT_PERSISTANCE;
-    s_Instance->m_Lacunarity = DEFAULT_LACUNARITY;
-    s_Instance->m_NoiseScale = DEFAULT_NOISE_SCALE;
-
-    s_Instance->m_OctavesOffsets.clear();
-    for (size_t i = 0; i < s_Instance->m_NumOctaves; i++) {
-        s_Instance->m_OctavesOffsets.emplace_back(
-            s_Instance->m_RandUnifDist(s_Instance->m_RandEngine),
-            s_Instance->m_RandUnifDist(s_Instance->m_RandEngine));
-    }
-
-    // Initialize the permutation vector with ken perlin's reference permutation
-    // and double it to avoid overflow
-    // clang-format off
-    s_Instance->m_Permutations = {
-        151, 160, 137, 91,  90,  15,  131, 13,  201, 95,  96,  53,  194, 233,// NOLINT
-        7,   225, 140, 36,  103, 30,  69,  142, 8,   99,  37,  240, 21,  10,// NOLINT
-        23,  190, 6,   148, 247, 120, 234, 75,  0,   26,  197, 62,  94,  252,// NOLINT
-        219, 203, 117, 35,  11,  32,  57,  177, 33,  88,  237, 149, 56,  87,// NOLINT
-        174, 20,  125, 136, 171, 168, 68,  175, 74,  165, 71,  134, 139, 48,// NOLINT
-        27,  166, 77,  146, 158, 231, 83,  111, 229, 122, 60,  211, 133, 230,// NOLINT
-        220, 105, 92,  41,  55,  46,  245, 40,  244, 102, 143, 54,  65,  25,// NOLINT
-        63,  161, 1,   216, 80,  73,  209, 76,  132, 187, 208, 89,  18,  169,// NOLINT
-        200, 196, 135, 130, 116, 188, 159, 86,  164, 100, 109, 198, 173, 186,// NOLINT
-        3,   64,  52,  217, 226, 250, 124, 123, 5,   202, 38,  147, 118, 126,// NOLINT
-        255, 82,  85,  212, 207, 206, 59,  227, 47,  16,  58,  17,  182, 189,// NOLINT
-        28,  42,  223, 183, 170, 213, 119, 248, 152, 2,   44,  154, 163, 70,// NOLINT
-        221, 153, 101, 155, 167, 43,  172, 9,   129, 22,  39,  253, 19,  98,// NOLINT
-        108, 110, 79,  113, 224, 232, 178, 185, 112, 104, 218, 246, 97,  228,// NOLINT
-        251, 34,  242, 193, 238, 210, 144, 12,  191, 179, 162, 241, 81,  51,// NOLINT
-        145, 235, 249, 14,  239, 107, 49,  192, 214, 31,  181, 199, 106, 157,// NOLINT
-        184, 84,  204, 176, 115, 121, 50,  45,  127, 4,   150, 254, 138, 236,// NOLINT
-        205, 93,  222, 114, 67,  29,  24,  72,  243, 141, 128, 195, 78,  66,// NOLINT
-        215, 61,  156, 180};// NOLINT
-    // clang-format on
-    s_Instance->m_Permutations.insert(s_Instance->m_Permutations.end(),
-                                      s_Instance->m_Permutations.begin(),
-                                      s_Instance->m_Permutations.end());
+    s_Instance = std::make_unique<PerlinNoiseGenerator>();
 }
 
 auto PerlinNoise::Release() -> void { s_Instance = nullptr; }
@@ -64,129 +787,126 @@ auto PerlinNoise::Config(size_t num_octaves, float persistance,
     LOG_CORE_ASSERT(s_Instance,
                     "PerlinNoise::Config >>> Must initialize perlin-noise "
                     "module before using it");
-    s_Instance->_Config(num_octaves, persistance, lacunarity, noise_scale);
+    s_Instance = std::make_unique<PerlinNoiseGenerator>(
+        s_Instance->seed(), num_octaves, persistance, lacunarity, noise_scale);
+}
+
+auto PerlinNoise::SetGenerator(const PerlinNoiseGenerator& generator)
+    -> void {
+    s_Instance = std::make_unique<PerlinNoiseGenerator>(generator);
+}
+
+auto PerlinNoise::GetGenerator() -> const PerlinNoiseGenerator& {
+    LOG_CORE_ASSERT(s_Instance,
+                    "PerlinNoise::GetGenerator >>> Must initialize "
+                    "perlin-noise module before using it");
+    return *s_Instance;
 }
 
 auto PerlinNoise::Sample1d(float x) -> float {
     LOG_CORE_ASSERT(s_Instance,
                     "PerlinNoise::Sample1d >>> Must initialize perlin-noise "
                     "module before using it");
-    return s_Instance->_Sample1d(x);
+    return s_Instance->Sample1d(x);
 }
 
 auto PerlinNoise::Sample2d(float x, float y) -> float {
     LOG_CORE_ASSERT(s_Instance,
                     "PerlinNoise::Sample2d >>> Must initialize perlin-noise "
                     "module before using it");
-    return s_Instance->_Sample2d(x, y);
+    return s_Instance->Sample2d(x, y);
 }
 
 auto PerlinNoise::Sample2d(const Vec2& xy) -> float {
     LOG_CORE_ASSERT(s_Instance,
                     "PerlinNoise::Sample2d >>> Must initialize perlin-noise "
                     "module before using it");
-    return s_Instance->_Sample2d(xy.x(), xy.y());
+    return s_Instance->Sample2d(xy);
 }
 
-auto PerlinNoise::_Config(size_t num_octaves, float persistance,
-                          float lacunarity, float noise_scale) -> void {
-    m_NumOctaves = num_octaves;
-    m_Persistance = persistance;
-    m_Lacunarity = lacunarity;
-    m_NoiseScale = noise_scale;
+auto PerlinNoise::Sample2dWithGradient(float x, float y) -> NoiseSample2d {
+    LOG_CORE_ASSERT(s_Instance,
+                    "PerlinNoise::Sample2dWithGradient >>> Must initialize "
+                    "perlin-noise module before using it");
+    return s_Instance->Sample2dWithGradient(x, y);
+}
 
-    m_OctavesOffsets.clear();
-    for (size_t o = 0; o < m_NumOctaves; o++) {
-        m_OctavesOffsets.emplace_back(
-            s_Instance->m_RandUnifDist(s_Instance->m_RandEngine),
-            s_Instance->m_RandUnifDist(s_Instance->m_RandEngine));
-    }
+auto PerlinNoise::SampleGrid2d(const Vec2& origin, const Vec2& spacing,
+                               size_t width, size_t height, float* out)
+    -> void {
+    LOG_CORE_ASSERT(s_Instance,
+                    "PerlinNoise::SampleGrid2d >>> Must initialize "
+                    "perlin-noise module before using it");
+    s_Instance->SampleGrid2d(origin, spacing, width, height, out);
 }
 
-auto PerlinNoise::_Sample1d(float x) -> float { return _Sample2d(x, 0.0F); }
+auto PerlinNoise::SampleGrid2d(const Vec2& origin, const Vec2& spacing,
+                               size_t width, size_t height, float* out,
+                               ThreadPool& pool) -> void {
+    LOG_CORE_ASSERT(s_Instance,
+                    "PerlinNoise::SampleGrid2d >>> Must initialize "
+                    "perlin-noise module before using it");
+    s_Instance->SampleGrid2d(origin, spacing, width, height, out, pool);
+}
 
-auto PerlinNoise::_Sample2d(float x, float y) -> float {
-    float ampl = 1.0F;
-    float freq = 1.0F;
-    float noise_value = 0.0F;
+auto PerlinNoise::SampleGrid1d(float origin, float spacing, size_t count,
+                               float* out) -> void {
+    LOG_CORE_ASSERT(s_Instance,
+                    "PerlinNoise::SampleGrid1d >>> Must initialize "
+                    "perlin-noise module before using it");
+    s_Instance->SampleGrid1d(origin, spacing, count, out);
+}
 
-    for (size_t i = 0; i < m_NumOctaves; i++) {
-        float sample_x = freq * (x / m_NoiseScale) + m_OctavesOffsets[i].x();
-        float sample_y = freq * (y / m_NoiseScale) + m_OctavesOffsets[i].y();
-        noise_value += ampl * _Perlin(sample_x, sample_y);
-        ampl *= m_Persistance;
-        freq *= m_Lacunarity;
+auto PerlinNoise::SetSimdLevel(eSimdLevel level) -> void {
+    if (!IsSimdLevelSupported(level)) {
+        LOG_CORE_WARN(
+            "PerlinNoise::SetSimdLevel >>> {0} isn't supported by this cpu, "
+            "using {1} instead",
+            ToString(level), ToString(GetSupportedSimdLevel()));
+        level = GetSupportedSimdLevel();
     }
-    return noise_value;
+    GetSimdLevelState().store(level, std::memory_order_relaxed);
 }
 
-auto PerlinNoise::_Fade(float t) -> float {
+auto PerlinNoise::GetSimdLevel() -> eSimdLevel {
+    return GetSimdLevelState().load(std::memory_order_relaxed);
+}
+
+auto PerlinNoiseGenerator::_Fade(float t) -> float {
     constexpr float KA = 6.0F;
     constexpr float KB = -15.0F;
     constexpr float KC = 10.0F;
     return t * t * t * (t * (t * KA + KB) + KC);
 }
 
-auto PerlinNoise::_Lerp(float a, float b, float t) -> float {
+auto PerlinNoiseGenerator::_FadeDerivative(float t) -> float {
+    constexpr float KA = 30.0F;
+    constexpr float KB = -60.0F;
+    constexpr float KC = 30.0F;
+    return t * t * (t * (t * KA + KB) + KC);
+}
+
+auto PerlinNoiseGenerator::_Lerp(float a, float b, float t) -> float {
     return (1 - t) * a + t * b;
 }
 
-auto PerlinNoise::_DotGrad(size_t hash, float x, float y) -> float {
-    constexpr auto MASK_LSB = 0xf;
-    // Get the LSB from the hash to get the gradient direction
-    const auto HASH_LSB = hash & MASK_LSB;
-    // hash results for (x+y) direction
-    constexpr auto GRAD_DIR_00_0 = 0x0;
-    constexpr auto GRAD_DIR_00_1 = 0x4;
-    constexpr auto GRAD_DIR_00_2 = 0x8;
-    constexpr auto GRAD_DIR_00_3 = 0xc;
-    // hash results for (-x+y) direction
-    constexpr auto GRAD_DIR_01_0 = 0x1;
-    constexpr auto GRAD_DIR_01_1 = 0x5;
-    constexpr auto GRAD_DIR_01_2 = 0x9;
-    constexpr auto GRAD_DIR_01_3 = 0xd;
-    // hash results for (x-y) direction
-    constexpr auto GRAD_DIR_10_0 = 0x2;
-    constexpr auto GRAD_DIR_10_1 = 0x6;
-    constexpr auto GRAD_DIR_10_2 = 0xa;
-    constexpr auto GRAD_DIR_10_3 = 0xe;
-    // hash results for (-x-y) direction
-    constexpr auto GRAD_DIR_11_0 = 0x3;
-    constexpr auto GRAD_DIR_11_1 = 0x7;
-    constexpr auto GRAD_DIR_11_2 = 0xb;
-    constexpr auto GRAD_DIR_11_3 = 0xf;
+auto PerlinNoiseGenerator::_DotGrad(int32_t hash, float x, float y) -> float {
     // Because we are in 2d, there are just 4 options for the gradient vectors
-    // and so, just 4 options for the dot product
-    switch (HASH_LSB) {
-        case GRAD_DIR_00_0:
-        case GRAD_DIR_00_1:
-        case GRAD_DIR_00_2:
-        case GRAD_DIR_00_3:
-            return x + y;
-        case GRAD_DIR_01_0:
-        case GRAD_DIR_01_1:
-        case GRAD_DIR_01_2:
-        case GRAD_DIR_01_3:
-            return -x + y;
-        case GRAD_DIR_10_0:
-        case GRAD_DIR_10_1:
-        case GRAD_DIR_10_2:
-        case GRAD_DIR_10_3:
-            return x - y;
-        case GRAD_DIR_11_0:
-        case GRAD_DIR_11_1:
-        case GRAD_DIR_11_2:
-        case GRAD_DIR_11_3:
-            return -x - y;
-    }
-
-    return 0.0F;
-}
-
-auto PerlinNoise::_Perlin(float x, float y) -> float {
-    // Calculate unit square position in grid (wrap around by 256)
-    const size_t X_INDX = static_cast<size_t>(std::floor(x)) & 255;
-    const size_t Y_INDX = static_cast<size_t>(std::floor(y)) & 255;
+    // (x+y, -x+y, x-y, -x-y), so bits 0 and 1 of the hash select the signs
+    return ((hash & 1) != 0 ? -x : x) + ((hash & 2) != 0 ? -y : y);
+}
+
+auto PerlinNoiseGenerator::_Perlin(float x, float y, size_t octave) const
+    -> float {
+    // Calculate unit square position in grid (wrap around by 256, or by the
+    // period of the octave)
+    const auto period = _GetOctavePeriod(octave);
+    int32_t x_index = 0;
+    int32_t x_index_next = 0;
+    int32_t y_index = 0;
+    int32_t y_index_next = 0;
+    _LatticeIndex(std::floor(x), period.x, &x_index, &x_index_next);
+    _LatticeIndex(std::floor(y), period.y, &y_index, &y_index_next);
 
     // Calculate relative position [0-1] inside unit-square
     const float X_F = x - std::floor(x);
@@ -196,11 +916,12 @@ auto PerlinNoise::_Perlin(float x, float y) -> float {
     const float U = _Fade(X_F);
     const float V = _Fade(Y_F);
 
-    const size_t HASH_00 = m_Permutations[m_Permutations[X_INDX] + Y_INDX];
-    const size_t HASH_01 = m_Permutations[m_Permutations[X_INDX] + Y_INDX + 1];
-    const size_t HASH_10 = m_Permutations[m_Permutations[X_INDX + 1] + Y_INDX];
-    const size_t HASH_11 =
-        m_Permutations[m_Permutations[X_INDX + 1] + Y_INDX + 1];
+    const int32_t PERM_0 = m_Permutations[x_index];
+    const int32_t PERM_1 = m_Permutations[x_index_next];
+    const int32_t HASH_00 = m_Permutations[PERM_0 + y_index];
+    const int32_t HASH_01 = m_Permutations[PERM_0 + y_index_next];
+    const int32_t HASH_10 = m_Permutations[PERM_1 + y_index];
+    const int32_t HASH_11 = m_Permutations[PERM_1 + y_index_next];
 
     const float D_00 = _DotGrad(HASH_00, X_F, Y_F);
     const float D_01 = _DotGrad(HASH_01, X_F, Y_F - 1.0F);
@@ -210,4 +931,52 @@ auto PerlinNoise::_Perlin(float x, float y) -> float {
     return _Lerp(_Lerp(D_00, D_10, U), _Lerp(D_01, D_11, U), V);
 }
 
+auto PerlinNoiseGenerator::_PerlinWithGradient(float x, float y,
+                                               size_t octave, float* grad_x,
+                                               float* grad_y) const -> float {
+    // Same lattice lookups as _Perlin (see there)
+    const auto period = _GetOctavePeriod(octave);
+    int32_t x_index = 0;
+    int32_t x_index_next = 0;
+    int32_t y_index = 0;
+    int32_t y_index_next = 0;
+    _LatticeIndex(std::floor(x), period.x, &x_index, &x_index_next);
+    _LatticeIndex(std::floor(y), period.y, &y_index, &y_index_next);
+    const float X_F = x - std::floor(x);
+    const float Y_F = y - std::floor(y);
+    const float U = _Fade(X_F);
+    const float V = _Fade(Y_F);
+    const float DU = _FadeDerivative(X_F);
+    const float DV = _FadeDerivative(Y_F);
+
+    const int32_t PERM_0 = m_Permutations[x_index];
+    const int32_t PERM_1 = m_Permutations[x_index_next];
+    const int32_t HASH_00 = m_Permutations[PERM_0 + y_index];
+    const int32_t HASH_01 = m_Permutations[PERM_0 + y_index_next];
+    const int32_t HASH_10 = m_Permutations[PERM_1 + y_index];
+    const int32_t HASH_11 = m_Permutations[PERM_1 + y_index_next];
+
+    const float D_00 = _DotGrad(HASH_00, X_F, Y_F);
+    const float D_01 = _DotGrad(HASH_01, X_F, Y_F - 1.0F);
+    const float D_10 = _DotGrad(HASH_10, X_F - 1.0F, Y_F);
+    const float D_11 = _DotGrad(HASH_11, X_F - 1.0F, Y_F - 1.0F);
+    const float D_0 = _Lerp(D_00, D_10, U);
+    const float D_1 = _Lerp(D_01, D_11, U);
+
+    // Derivative of the bilinear blend: the blended gradients of the corners
+    // (the partial derivatives of _DotGrad), plus the change of the weights
+    const float GX_0 = _Lerp(_DotGrad(HASH_00, 1.0F, 0.0F),
+                             _DotGrad(HASH_10, 1.0F, 0.0F), U);
+    const float GX_1 = _Lerp(_DotGrad(HASH_01, 1.0F, 0.0F),
+                             _DotGrad(HASH_11, 1.0F, 0.0F), U);
+    const float GY_0 = _Lerp(_DotGrad(HASH_00, 0.0F, 1.0F),
+                             _DotGrad(HASH_10, 0.0F, 1.0F), U);
+    const float GY_1 = _Lerp(_DotGrad(HASH_01, 0.0F, 1.0F),
+                             _DotGrad(HASH_11, 0.0F, 1.0F), U);
+    *grad_x = _Lerp(GX_0, GX_1, V) + DU * _Lerp(D_10 - D_00, D_11 - D_01, V);
+    *grad_y = _Lerp(GY_0, GY_1, V) + DV * (D_1 - D_0);
+
+    return _Lerp(D_0, D_1, V);
+}
+
 }  // namespace utils
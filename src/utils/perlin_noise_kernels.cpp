@@ -0,0 +1,830 @@
+#include <cmath>
+
+#include <utils/perlin_noise_kernels.hpp>
+
+#if defined(UTILS_SIMD_X86)
+#include <immintrin.h>
+#elif defined(UTILS_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// All kernels evaluate exactly the same operations in the same order as the
+// scalar kernel, so their results are bit-for-bit the same (unless the
+// compiler contracts multiplies and adds into FMAs). The gradient of each
+// corner is selected without branches, by flipping the sign bits of x and y
+// with bits 0 and 1 of the hash (for the 2d case only 4 gradients are used:
+// x+y, -x+y, x-y, -x-y)
+
+namespace utils {
+namespace kernels {
+
+namespace {
+
+/// Number of bits to shift the hash so bit 0 lands in the sign bit of x
+constexpr int SIGN_SHIFT_X = 31;
+/// Number of bits to shift the hash so bit 1 lands in the sign bit of y
+constexpr int SIGN_SHIFT_Y = 30;
+
+inline auto DotGrad(int32_t hash, float x, float y) -> float {
+    return ((hash & 1) != 0 ? -x : x) + ((hash & 2) != 0 ? -y : y);
+}
+
+inline auto Lerp(float a, float b, float t) -> float {
+    return (1 - t) * a + t * b;
+}
+
+/// Returns the arguments for the columns from `start` onwards
+auto Suffix(const PerlinRowArgs& args, size_t start) -> PerlinRowArgs {
+    auto suffix = args;
+    suffix.cols_index += start;       // NOLINT
+    suffix.cols_index_next += start;  // NOLINT
+    suffix.cols_frac += start;        // NOLINT
+    suffix.cols_fade += start;        // NOLINT
+    suffix.out += start;              // NOLINT
+    suffix.width -= start;
+    return suffix;
+}
+
+/// Returns the arguments for the points from `start` onwards
+auto Suffix(const PerlinPointsArgs& args, size_t start) -> PerlinPointsArgs {
+    auto suffix = args;
+    suffix.index_x += start;       // NOLINT
+    suffix.index_y += start;       // NOLINT
+    suffix.index_x_next += start;  // NOLINT
+    suffix.index_y_next += start;  // NOLINT
+    suffix.frac_x += start;        // NOLINT
+    suffix.frac_y += start;        // NOLINT
+    suffix.fade_x += start;        // NOLINT
+    suffix.fade_y += start;        // NOLINT
+    suffix.out += start;           // NOLINT
+    suffix.count -= start;
+    return suffix;
+}
+
+}  // namespace
+
+auto PerlinRow2dScalar(const PerlinRowArgs& args) -> void {
+    const auto* perm = args.perm;
+    const float Y_F = args.row_frac;
+    const float V = args.row_fade;
+    for (size_t j = 0; j < args.width; j++) {
+        const float X_F = args.cols_frac[j];  // NOLINT
+        const float U = args.cols_fade[j];    // NOLINT
+
+        const int32_t PERM_0 = perm[args.cols_index[j]];             // NOLINT
+        const int32_t PERM_1 = perm[args.cols_index_next[j]];        // NOLINT
+        const int32_t HASH_00 = perm[PERM_0 + args.row_index];       // NOLINT
+        const int32_t HASH_01 = perm[PERM_0 + args.row_index_next];  // NOLINT
+        const int32_t HASH_10 = perm[PERM_1 + args.row_index];       // NOLINT
+        const int32_t HASH_11 = perm[PERM_1 + args.row_index_next];  // NOLINT
+
+        const float D_00 = DotGrad(HASH_00, X_F, Y_F);
+        const float D_01 = DotGrad(HASH_01, X_F, Y_F - 1.0F);
+        const float D_10 = DotGrad(HASH_10, X_F - 1.0F, Y_F);
+        const float D_11 = DotGrad(HASH_11, X_F - 1.0F, Y_F - 1.0F);
+
+        args.out[j] += args.ampl * Lerp(Lerp(D_00, D_10, U),  // NOLINT
+                                        Lerp(D_01, D_11, U), V);
+    }
+}
+
+auto PerlinPoints2dScalar(const PerlinPointsArgs& args) -> void {
+    const auto* perm = args.perm;
+    for (size_t j = 0; j < args.count; j++) {
+        const float X_F = args.frac_x[j];  // NOLINT
+        const float Y_F = args.frac_y[j];  // NOLINT
+        const float U = args.fade_x[j];    // NOLINT
+        const float V = args.fade_y[j];    // NOLINT
+
+        const int32_t PERM_0 = perm[args.index_x[j]];                 // NOLINT
+        const int32_t PERM_1 = perm[args.index_x_next[j]];            // NOLINT
+        const int32_t HASH_00 = perm[PERM_0 + args.index_y[j]];       // NOLINT
+        const int32_t HASH_01 = perm[PERM_0 + args.index_y_next[j]];  // NOLINT
+        const int32_t HASH_10 = perm[PERM_1 + args.index_y[j]];       // NOLINT
+        const int32_t HASH_11 = perm[PERM_1 + args.index_y_next[j]];  // NOLINT
+
+        const float D_00 = DotGrad(HASH_00, X_F, Y_F);
+        const float D_01 = DotGrad(HASH_01, X_F, Y_F - 1.0F);
+        const float D_10 = DotGrad(HASH_10, X_F - 1.0F, Y_F);
+        const float D_11 = DotGrad(HASH_11, X_F - 1.0F, Y_F - 1.0F);
+
+        args.out[j] += args.ampl * Lerp(Lerp(D_00, D_10, U),  // NOLINT
+                                        Lerp(D_01, D_11, U), V);
+    }
+}
+
+#if defined(UTILS_SIMD_X86)
+
+namespace {
+
+inline auto DotGradSse2(__m128i hash, __m128 x, __m128 y) -> __m128 {
+    const __m128i sign_x =
+        _mm_slli_epi32(_mm_and_si128(hash, _mm_set1_epi32(1)), SIGN_SHIFT_X);
+    const __m128i sign_y =
+        _mm_slli_epi32(_mm_and_si128(hash, _mm_set1_epi32(2)), SIGN_SHIFT_Y);
+    return _mm_add_ps(_mm_xor_ps(x, _mm_castsi128_ps(sign_x)),
+                      _mm_xor_ps(y, _mm_castsi128_ps(sign_y)));
+}
+
+inline auto LerpSse2(__m128 a, __m128 b, __m128 t) -> __m128 {
+    return _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0F), t), a),
+                      _mm_mul_ps(t, b));
+}
+
+UTILS_TARGET_AVX2 inline auto DotGradAvx2(__m256i hash, __m256 x, __m256 y)
+    -> __m256 {
+    const __m256i sign_x = _mm256_slli_epi32(
+        _mm256_and_si256(hash, _mm256_set1_epi32(1)), SIGN_SHIFT_X);
+    const __m256i sign_y = _mm256_slli_epi32(
+        _mm256_and_si256(hash, _mm256_set1_epi32(2)), SIGN_SHIFT_Y);
+    return _mm256_add_ps(_mm256_xor_ps(x, _mm256_castsi256_ps(sign_x)),
+                         _mm256_xor_ps(y, _mm256_castsi256_ps(sign_y)));
+}
+
+UTILS_TARGET_AVX2 inline auto LerpAvx2(__m256 a, __m256 b, __m256 t)
+    -> __m256 {
+    return _mm256_add_ps(
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.0F), t), a),
+        _mm256_mul_ps(t, b));
+}
+
+UTILS_TARGET_AVX2 inline auto LoadAvx2(const int32_t* indices) -> __m256i {
+    return _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(indices));  // NOLINT
+}
+
+}  // namespace
+
+auto PerlinRow2dSse2(const PerlinRowArgs& args) -> void {
+    constexpr size_t LANES = 4;
+    const auto* perm = args.perm;
+    const __m128 one = _mm_set1_ps(1.0F);
+    const __m128 y_f0 = _mm_set1_ps(args.row_frac);
+    const __m128 y_f1 = _mm_sub_ps(y_f0, one);
+    const __m128 v = _mm_set1_ps(args.row_fade);
+    const __m128 ampl = _mm_set1_ps(args.ampl);
+
+    size_t j = 0;
+    for (; j + LANES <= args.width; j += LANES) {
+        // SSE2 has no gathers, so the lookups are done lane by lane
+        alignas(16) int32_t hashes[4][LANES];  // NOLINT
+        for (size_t k = 0; k < LANES; k++) {
+            const int32_t PERM_0 = perm[args.cols_index[j + k]];       // NOLINT
+            const int32_t PERM_1 = perm[args.cols_index_next[j + k]];  // NOLINT
+            hashes[0][k] = perm[PERM_0 + args.row_index];              // NOLINT
+            hashes[1][k] = perm[PERM_0 + args.row_index_next];         // NOLINT
+            hashes[2][k] = perm[PERM_1 + args.row_index];              // NOLINT
+            hashes[3][k] = perm[PERM_1 + args.row_index_next];         // NOLINT
+        }
+        const __m128 x_f0 = _mm_loadu_ps(args.cols_frac + j);  // NOLINT
+        const __m128 x_f1 = _mm_sub_ps(x_f0, one);
+        const __m128 u = _mm_loadu_ps(args.cols_fade + j);  // NOLINT
+
+        // NOLINTNEXTLINE
+        const auto load = [&](size_t corner) {
+            return _mm_load_si128(
+                reinterpret_cast<const __m128i*>(hashes[corner]));  // NOLINT
+        };
+        const __m128 d_00 = DotGradSse2(load(0), x_f0, y_f0);
+        const __m128 d_01 = DotGradSse2(load(1), x_f0, y_f1);
+        const __m128 d_10 = DotGradSse2(load(2), x_f1, y_f0);
+        const __m128 d_11 = DotGradSse2(load(3), x_f1, y_f1);
+
+        const __m128 noise = LerpSse2(LerpSse2(d_00, d_10, u),
+                                      LerpSse2(d_01, d_11, u), v);
+        float* out = args.out + j;  // NOLINT
+        _mm_storeu_ps(out,
+                      _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(ampl, noise)));
+    }
+    if (j < args.width) {
+        PerlinRow2dScalar(Suffix(args, j));
+    }
+}
+
+auto PerlinPoints2dSse2(const PerlinPointsArgs& args) -> void {
+    constexpr size_t LANES = 4;
+    const auto* perm = args.perm;
+    const __m128 one = _mm_set1_ps(1.0F);
+    const __m128 ampl = _mm_set1_ps(args.ampl);
+
+    size_t j = 0;
+    for (; j + LANES <= args.count; j += LANES) {
+        alignas(16) int32_t hashes[4][LANES];  // NOLINT
+        for (size_t k = 0; k < LANES; k++) {
+            const int32_t PERM_0 = perm[args.index_x[j + k]];       // NOLINT
+            const int32_t PERM_1 = perm[args.index_x_next[j + k]];  // NOLINT
+            const int32_t Y_0 = args.index_y[j + k];                // NOLINT
+            const int32_t Y_1 = args.index_y_next[j + k];           // NOLINT
+            hashes[0][k] = perm[PERM_0 + Y_0];                      // NOLINT
+            hashes[1][k] = perm[PERM_0 + Y_1];                      // NOLINT
+            hashes[2][k] = perm[PERM_1 + Y_0];                      // NOLINT
+            hashes[3][k] = perm[PERM_1 + Y_1];                      // NOLINT
+        }
+        const __m128 x_f0 = _mm_loadu_ps(args.frac_x + j);  // NOLINT
+        const __m128 y_f0 = _mm_loadu_ps(args.frac_y + j);  // NOLINT
+        const __m128 x_f1 = _mm_sub_ps(x_f0, one);
+        const __m128 y_f1 = _mm_sub_ps(y_f0, one);
+        const __m128 u = _mm_loadu_ps(args.fade_x + j);  // NOLINT
+        const __m128 v = _mm_loadu_ps(args.fade_y + j);  // NOLINT
+
+        // NOLINTNEXTLINE
+        const auto load = [&](size_t corner) {
+            return _mm_load_si128(
+                reinterpret_cast<const __m128i*>(hashes[corner]));  // NOLINT
+        };
+        const __m128 d_00 = DotGradSse2(load(0), x_f0, y_f0);
+        const __m128 d_01 = DotGradSse2(load(1), x_f0, y_f1);
+        const __m128 d_10 = DotGradSse2(load(2), x_f1, y_f0);
+        const __m128 d_11 = DotGradSse2(load(3), x_f1, y_f1);
+
+        const __m128 noise = LerpSse2(LerpSse2(d_00, d_10, u),
+                                      LerpSse2(d_01, d_11, u), v);
+        float* out = args.out + j;  // NOLINT
+        _mm_storeu_ps(out,
+                      _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(ampl, noise)));
+    }
+    if (j < args.count) {
+        PerlinPoints2dScalar(Suffix(args, j));
+    }
+}
+
+UTILS_TARGET_AVX2 auto PerlinRow2dAvx2(const PerlinRowArgs& args) -> void {
+    constexpr size_t LANES = 8;
+    constexpr int SCALE = sizeof(int32_t);
+    const auto* perm = args.perm;
+    const __m256i row_index = _mm256_set1_epi32(args.row_index);
+    const __m256i row_index_next = _mm256_set1_epi32(args.row_index_next);
+    const __m256 one = _mm256_set1_ps(1.0F);
+    const __m256 y_f0 = _mm256_set1_ps(args.row_frac);
+    const __m256 y_f1 = _mm256_sub_ps(y_f0, one);
+    const __m256 v = _mm256_set1_ps(args.row_fade);
+    const __m256 ampl = _mm256_set1_ps(args.ampl);
+
+    size_t j = 0;
+    for (; j + LANES <= args.width; j += LANES) {
+        const __m256i x_indx = LoadAvx2(args.cols_index + j);  // NOLINT
+        const __m256i x_indx_next =
+            LoadAvx2(args.cols_index_next + j);  // NOLINT
+        const __m256i perm_0 = _mm256_i32gather_epi32(perm, x_indx, SCALE);
+        const __m256i perm_1 =
+            _mm256_i32gather_epi32(perm, x_indx_next, SCALE);
+        const __m256i hash_00 = _mm256_i32gather_epi32(
+            perm, _mm256_add_epi32(perm_0, row_index), SCALE);
+        const __m256i hash_01 = _mm256_i32gather_epi32(
+            perm, _mm256_add_epi32(perm_0, row_index_next), SCALE);
+        const __m256i hash_10 = _mm256_i32gather_epi32(
+            perm, _mm256_add_epi32(perm_1, row_index), SCALE);
+        const __m256i hash_11 = _mm256_i32gather_epi32(
+            perm, _mm256_add_epi32(perm_1, row_index_next), SCALE);
+
+        const __m256 x_f0 = _mm256_loadu_ps(args.cols_frac + j);  // NOLINT
+        const __m256 x_f1 = _mm256_sub_ps(x_f0, one);
+        const __m256 u = _mm256_loadu_ps(args.cols_fade + j);  // NOLINT
+
+        const __m256 d_00 = DotGradAvx2(hash_00, x_f0, y_f0);
+        const __m256 d_01 = DotGradAvx2(hash_01, x_f0, y_f1);
+        const __m256 d_10 = DotGradAvx2(hash_10, x_f1, y_f0);
+        const __m256 d_11 = DotGradAvx2(hash_11, x_f1, y_f1);
+
+        const __m256 noise = LerpAvx2(LerpAvx2(d_00, d_10, u),
+                                      LerpAvx2(d_01, d_11, u), v);
+        float* out = args.out + j;  // NOLINT
+        _mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out),
+                                            _mm256_mul_ps(ampl, noise)));
+    }
+    if (j < args.width) {
+        PerlinRow2dScalar(Suffix(args, j));
+    }
+}
+
+UTILS_TARGET_AVX2 auto PerlinPoints2dAvx2(const PerlinPointsArgs& args)
+    -> void {
+    constexpr size_t LANES = 8;
+    constexpr int SCALE = sizeof(int32_t);
+    const auto* perm = args.perm;
+    const __m256 one = _mm256_set1_ps(1.0F);
+    const __m256 ampl = _mm256_set1_ps(args.ampl);
+
+    size_t j = 0;
+    for (; j + LANES <= args.count; j += LANES) {
+        const __m256i x_indx = LoadAvx2(args.index_x + j);            // NOLINT
+        const __m256i y_indx = LoadAvx2(args.index_y + j);            // NOLINT
+        const __m256i x_indx_next = LoadAvx2(args.index_x_next + j);  // NOLINT
+        const __m256i y_indx_next = LoadAvx2(args.index_y_next + j);  // NOLINT
+        const __m256i perm_0 = _mm256_i32gather_epi32(perm, x_indx, SCALE);
+        const __m256i perm_1 =
+            _mm256_i32gather_epi32(perm, x_indx_next, SCALE);
+        const __m256i hash_00 = _mm256_i32gather_epi32(
+            perm, _mm256_add_epi32(perm_0, y_indx), SCALE);
+        const __m256i hash_01 = _mm256_i32gather_epi32(
+            perm, _mm256_add_epi32(perm_0, y_indx_next), SCALE);
+        const __m256i hash_10 = _mm256_i32gather_epi32(
+            perm, _mm256_add_epi32(perm_1, y_indx), SCALE);
+        const __m256i hash_11 = _mm256_i32gather_epi32(
+            perm, _mm256_add_epi32(perm_1, y_indx_next), SCALE);
+
+        const __m256 x_f0 = _mm256_loadu_ps(args.frac_x + j);  // NOLINT
+        const __m256 y_f0 = _mm256_loadu_ps(args.frac_y + j);  // NOLINT
+        const __m256 x_f1 = _mm256_sub_ps(x_f0, one);
+        const __m256 y_f1 = _mm256_sub_ps(y_f0, one);
+        const __m256 u = _mm256_loadu_ps(args.fade_x + j);  // NOLINT
+        const __m256 v = _mm256_loadu_ps(args.fade_y + j);  // NOLINT
+
+        const __m256 d_00 = DotGradAvx2(hash_00, x_f0, y_f0);
+        const __m256 d_01 = DotGradAvx2(hash_01, x_f0, y_f1);
+        const __m256 d_10 = DotGradAvx2(hash_10, x_f1, y_f0);
+        const __m256 d_11 = DotGradAvx2(hash_11, x_f1, y_f1);
+
+        const __m256 noise = LerpAvx2(LerpAvx2(d_00, d_10, u),
+                                      LerpAvx2(d_01, d_11, u), v);
+        float* out = args.out + j;  // NOLINT
+        _mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out),
+                                            _mm256_mul_ps(ampl, noise)));
+    }
+    if (j < args.count) {
+        PerlinPoints2dScalar(Suffix(args, j));
+    }
+}
+
+#endif  // UTILS_SIMD_X86
+
+#if defined(UTILS_SIMD_NEON)
+
+namespace {
+
+inline auto DotGradNeon(uint32x4_t hash, float32x4_t x, float32x4_t y)
+    -> float32x4_t {
+    const uint32x4_t sign_x =
+        vshlq_n_u32(vandq_u32(hash, vdupq_n_u32(1)), SIGN_SHIFT_X);
+    const uint32x4_t sign_y =
+        vshlq_n_u32(vandq_u32(hash, vdupq_n_u32(2)), SIGN_SHIFT_Y);
+    return vaddq_f32(
+        vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(x), sign_x)),
+        vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(y), sign_y)));
+}
+
+inline auto LerpNeon(float32x4_t a, float32x4_t b, float32x4_t t)
+    -> float32x4_t {
+    return vaddq_f32(vmulq_f32(vsubq_f32(vdupq_n_f32(1.0F), t), a),
+                     vmulq_f32(t, b));
+}
+
+}  // namespace
+
+auto PerlinRow2dNeon(const PerlinRowArgs& args) -> void {
+    constexpr size_t LANES = 4;
+    const auto* perm = args.perm;
+    const float32x4_t one = vdupq_n_f32(1.0F);
+    const float32x4_t y_f0 = vdupq_n_f32(args.row_frac);
+    const float32x4_t y_f1 = vsubq_f32(y_f0, one);
+    const float32x4_t v = vdupq_n_f32(args.row_fade);
+    const float32x4_t ampl = vdupq_n_f32(args.ampl);
+
+    size_t j = 0;
+    for (; j + LANES <= args.width; j += LANES) {
+        // NEON has no gathers, so the lookups are done lane by lane
+        uint32_t hashes[4][LANES];  // NOLINT
+        for (size_t k = 0; k < LANES; k++) {
+            const int32_t PERM_0 = perm[args.cols_index[j + k]];       // NOLINT
+            const int32_t PERM_1 = perm[args.cols_index_next[j + k]];  // NOLINT
+            const int32_t Y_0 = args.row_index;
+            const int32_t Y_1 = args.row_index_next;
+            hashes[0][k] = static_cast<uint32_t>(perm[PERM_0 + Y_0]);  // NOLINT
+            hashes[1][k] = static_cast<uint32_t>(perm[PERM_0 + Y_1]);  // NOLINT
+            hashes[2][k] = static_cast<uint32_t>(perm[PERM_1 + Y_0]);  // NOLINT
+            hashes[3][k] = static_cast<uint32_t>(perm[PERM_1 + Y_1]);  // NOLINT
+        }
+        const float32x4_t x_f0 = vld1q_f32(args.cols_frac + j);  // NOLINT
+        const float32x4_t x_f1 = vsubq_f32(x_f0, one);
+        const float32x4_t u = vld1q_f32(args.cols_fade + j);  // NOLINT
+
+        const auto d_00 = DotGradNeon(vld1q_u32(hashes[0]), x_f0, y_f0);
+        const auto d_01 = DotGradNeon(vld1q_u32(hashes[1]), x_f0, y_f1);
+        const auto d_10 = DotGradNeon(vld1q_u32(hashes[2]), x_f1, y_f0);
+        const auto d_11 = DotGradNeon(vld1q_u32(hashes[3]), x_f1, y_f1);
+
+        const float32x4_t noise = LerpNeon(LerpNeon(d_00, d_10, u),
+                                           LerpNeon(d_01, d_11, u), v);
+        float* out = args.out + j;  // NOLINT
+        vst1q_f32(out, vaddq_f32(vld1q_f32(out), vmulq_f32(ampl, noise)));
+    }
+    if (j < args.width) {
+        PerlinRow2dScalar(Suffix(args, j));
+    }
+}
+
+auto PerlinPoints2dNeon(const PerlinPointsArgs& args) -> void {
+    constexpr size_t LANES = 4;
+    const auto* perm = args.perm;
+    const float32x4_t one = vdupq_n_f32(1.0F);
+    const float32x4_t ampl = vdupq_n_f32(args.ampl);
+
+    size_t j = 0;
+    for (; j + LANES <= args.count; j += LANES) {
+        uint32_t hashes[4][LANES];  // NOLINT
+        for (size_t k = 0; k < LANES; k++) {
+            const int32_t PERM_0 = perm[args.index_x[j + k]];          // NOLINT
+            const int32_t PERM_1 = perm[args.index_x_next[j + k]];     // NOLINT
+            const int32_t Y_0 = args.index_y[j + k];                   // NOLINT
+            const int32_t Y_1 = args.index_y_next[j + k];              // NOLINT
+            hashes[0][k] = static_cast<uint32_t>(perm[PERM_0 + Y_0]);  // NOLINT
+            hashes[1][k] = static_cast<uint32_t>(perm[PERM_0 + Y_1]);  // NOLINT
+            hashes[2][k] = static_cast<uint32_t>(perm[PERM_1 + Y_0]);  // NOLINT
+            hashes[3][k] = static_cast<uint32_t>(perm[PERM_1 + Y_1]);  // NOLINT
+        }
+        const float32x4_t x_f0 = vld1q_f32(args.frac_x + j);  // NOLINT
+        const float32x4_t y_f0 = vld1q_f32(args.frac_y + j);  // NOLINT
+        const float32x4_t x_f1 = vsubq_f32(x_f0, one);
+        const float32x4_t y_f1 = vsubq_f32(y_f0, one);
+        const float32x4_t u = vld1q_f32(args.fade_x + j);  // NOLINT
+        const float32x4_t v = vld1q_f32(args.fade_y + j);  // NOLINT
+
+        const auto d_00 = DotGradNeon(vld1q_u32(hashes[0]), x_f0, y_f0);
+        const auto d_01 = DotGradNeon(vld1q_u32(hashes[1]), x_f0, y_f1);
+        const auto d_10 = DotGradNeon(vld1q_u32(hashes[2]), x_f1, y_f0);
+        const auto d_11 = DotGradNeon(vld1q_u32(hashes[3]), x_f1, y_f1);
+
+        const float32x4_t noise = LerpNeon(LerpNeon(d_00, d_10, u),
+                                           LerpNeon(d_01, d_11, u), v);
+        float* out = args.out + j;  // NOLINT
+        vst1q_f32(out, vaddq_f32(vld1q_f32(out), vmulq_f32(ampl, noise)));
+    }
+    if (j < args.count) {
+        PerlinPoints2dScalar(Suffix(args, j));
+    }
+}
+
+#endif  // UTILS_SIMD_NEON
+
+auto PerlinRow2d(eSimdLevel level, const PerlinRowArgs& args) -> void {
+    switch (level) {
+#if defined(UTILS_SIMD_X86)
+        case eSimdLevel::AVX2:
+            PerlinRow2dAvx2(args);
+            return;
+        case eSimdLevel::SSE2:
+            PerlinRow2dSse2(args);
+            return;
+#endif
+#if defined(UTILS_SIMD_NEON)
+        case eSimdLevel::NEON:
+            PerlinRow2dNeon(args);
+            return;
+#endif
+        default:
+            PerlinRow2dScalar(args);
+            return;
+    }
+}
+
+auto PerlinPoints2d(eSimdLevel level, const PerlinPointsArgs& args) -> void {
+    switch (level) {
+#if defined(UTILS_SIMD_X86)
+        case eSimdLevel::AVX2:
+            PerlinPoints2dAvx2(args);
+            return;
+        case eSimdLevel::SSE2:
+            PerlinPoints2dSse2(args);
+            return;
+#endif
+#if defined(UTILS_SIMD_NEON)
+        case eSimdLevel::NEON:
+            PerlinPoints2dNeon(args);
+            return;
+#endif
+        default:
+            PerlinPoints2dScalar(args);
+            return;
+    }
+}
+
+auto PerlinRow2dWithGradient(const PerlinRowGradArgs& args) -> void {
+    const auto& row = args.row;
+    const auto* perm = row.perm;
+    const float Y_F = row.row_frac;
+    const float V = row.row_fade;
+    const float DV = args.row_fade_deriv;
+    const float GRAD_AMPL = row.ampl * args.grad_scale;
+    for (size_t j = 0; j < row.width; j++) {
+        const float X_F = row.cols_frac[j];        // NOLINT
+        const float U = row.cols_fade[j];          // NOLINT
+        const float DU = args.cols_fade_deriv[j];  // NOLINT
+
+        const int32_t PERM_0 = perm[row.cols_index[j]];             // NOLINT
+        const int32_t PERM_1 = perm[row.cols_index_next[j]];        // NOLINT
+        const int32_t HASH_00 = perm[PERM_0 + row.row_index];       // NOLINT
+        const int32_t HASH_01 = perm[PERM_0 + row.row_index_next];  // NOLINT
+        const int32_t HASH_10 = perm[PERM_1 + row.row_index];       // NOLINT
+        const int32_t HASH_11 = perm[PERM_1 + row.row_index_next];  // NOLINT
+
+        const float D_00 = DotGrad(HASH_00, X_F, Y_F);
+        const float D_01 = DotGrad(HASH_01, X_F, Y_F - 1.0F);
+        const float D_10 = DotGrad(HASH_10, X_F - 1.0F, Y_F);
+        const float D_11 = DotGrad(HASH_11, X_F - 1.0F, Y_F - 1.0F);
+        const float D_0 = Lerp(D_00, D_10, U);
+        const float D_1 = Lerp(D_01, D_11, U);
+
+        // The gradient of each corner is (+-1, +-1) (the partial derivatives
+        // of DotGrad), which gives the first terms of the chain rule below
+        const float GX_0 = Lerp(DotGrad(HASH_00, 1.0F, 0.0F),
+                                DotGrad(HASH_10, 1.0F, 0.0F), U);
+        const float GX_1 = Lerp(DotGrad(HASH_01, 1.0F, 0.0F),
+                                DotGrad(HASH_11, 1.0F, 0.0F), U);
+        const float GY_0 = Lerp(DotGrad(HASH_00, 0.0F, 1.0F),
+                                DotGrad(HASH_10, 0.0F, 1.0F), U);
+        const float GY_1 = Lerp(DotGrad(HASH_01, 0.0F, 1.0F),
+                                DotGrad(HASH_11, 0.0F, 1.0F), U);
+        const float GRAD_X =
+            Lerp(GX_0, GX_1, V) + DU * Lerp(D_10 - D_00, D_11 - D_01, V);
+        const float GRAD_Y = Lerp(GY_0, GY_1, V) + DV * (D_1 - D_0);
+
+        row.out[j] += row.ampl * Lerp(D_0, D_1, V);  // NOLINT
+        args.out_grad_x[j] += GRAD_AMPL * GRAD_X;    // NOLINT
+        args.out_grad_y[j] += GRAD_AMPL * GRAD_Y;    // NOLINT
+    }
+}
+
+namespace {
+
+/// Mask used to wrap the lattice indices to the 256 entries of the table
+constexpr int32_t PERM_MASK = 255;
+
+inline auto Fade(float t) -> float {
+    constexpr float KA = 6.0F;
+    constexpr float KB = -15.0F;
+    constexpr float KC = 10.0F;
+    return t * t * t * (t * (t * KA + KB) + KC);
+}
+
+/// Returns the lattice cell (wrapped) and the position inside of it
+inline auto Split(float x, int32_t* index, float* frac) -> void {
+    const float floor_x = std::floor(x);
+    *index = static_cast<int32_t>(floor_x) & PERM_MASK;
+    *frac = x - floor_x;
+}
+
+/// Product with one of the 12 gradients of the 3d lattice (the directions to
+/// the edges of a cube, as in ken perlin's improved noise)
+inline auto Grad3d(int32_t hash, float x, float y, float z) -> float {
+    const int32_t h = hash & 15;  // NOLINT
+    const float u = h < 8 ? x : y;
+    const float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);  // NOLINT
+    return ((h & 1) != 0 ? -u : u) + ((h & 2) != 0 ? -v : v);
+}
+
+/// Product with one of the 32 gradients of the 4d lattice (the directions to
+/// the edges of a hypercube)
+inline auto Grad4d(int32_t hash, float x, float y, float z, float w) -> float {
+    const int32_t h = hash & 31;     // NOLINT
+    const float u = h < 24 ? x : y;  // NOLINT
+    const float v = h < 16 ? y : z;  // NOLINT
+    const float t = h < 8 ? z : w;   // NOLINT
+    return ((h & 1) != 0 ? -u : u) + ((h & 2) != 0 ? -v : v) +
+           ((h & 4) != 0 ? -t : t);
+}
+
+/// Product with one of the 8 gradients used by 2d simplex-noise
+inline auto GradSimplex2d(int32_t hash, float x, float y) -> float {
+    const int32_t h = hash & 7;
+    const float u = h < 4 ? x : y;
+    const float v = h < 4 ? y : x;
+    return ((h & 1) != 0 ? -u : u) + ((h & 2) != 0 ? -2.0F * v : 2.0F * v);
+}
+
+/// Noise of a cell of the 3d lattice, given its indices, the position inside
+/// of it, and the fade-curve evaluated at that position
+inline auto PerlinCell3d(const uint8_t* perm, const int32_t* index,
+                         const float* frac, const float* fade) -> float {
+    const float X_F = frac[0];
+    const float Y_F = frac[1];
+    const float Z_F = frac[2];
+    const int32_t A = perm[index[0]] + index[1];      // NOLINT
+    const int32_t B = perm[index[0] + 1] + index[1];  // NOLINT
+    const int32_t AA = perm[A] + index[2];            // NOLINT
+    const int32_t AB = perm[A + 1] + index[2];        // NOLINT
+    const int32_t BA = perm[B] + index[2];            // NOLINT
+    const int32_t BB = perm[B + 1] + index[2];        // NOLINT
+
+    const float D_000 = Grad3d(perm[AA], X_F, Y_F, Z_F);
+    const float D_100 = Grad3d(perm[BA], X_F - 1.0F, Y_F, Z_F);
+    const float D_010 = Grad3d(perm[AB], X_F, Y_F - 1.0F, Z_F);
+    const float D_110 = Grad3d(perm[BB], X_F - 1.0F, Y_F - 1.0F, Z_F);
+    const float D_001 = Grad3d(perm[AA + 1], X_F, Y_F, Z_F - 1.0F);
+    const float D_101 = Grad3d(perm[BA + 1], X_F - 1.0F, Y_F, Z_F - 1.0F);
+    const float D_011 = Grad3d(perm[AB + 1], X_F, Y_F - 1.0F, Z_F - 1.0F);
+    const float D_111 =
+        Grad3d(perm[BB + 1], X_F - 1.0F, Y_F - 1.0F, Z_F - 1.0F);
+
+    return Lerp(Lerp(Lerp(D_000, D_100, fade[0]), Lerp(D_010, D_110, fade[0]),
+                     fade[1]),
+                Lerp(Lerp(D_001, D_101, fade[0]), Lerp(D_011, D_111, fade[0]),
+                     fade[1]),
+                fade[2]);
+}
+
+/// Noise of a cell of the 4d lattice (same arguments as the 3d version)
+inline auto PerlinCell4d(const uint8_t* perm, const int32_t* index,
+                         const float* frac, const float* fade) -> float {
+    constexpr int32_t NUM_CORNERS = 16;
+    // Bit k of the corner selects its side along axis k
+    float dots[NUM_CORNERS];  // NOLINT
+    for (int32_t c = 0; c < NUM_CORNERS; c++) {
+        const int32_t D_X = c & 1;
+        const int32_t D_Y = (c >> 1) & 1;
+        const int32_t D_Z = (c >> 2) & 1;
+        const int32_t D_W = (c >> 3) & 1;
+        const int32_t HASH =
+            perm[perm[perm[perm[index[0] + D_X] + index[1] + D_Y] + index[2] +
+                      D_Z] +
+                 index[3] + D_W];
+        dots[c] = Grad4d(HASH, frac[0] - static_cast<float>(D_X),
+                         frac[1] - static_cast<float>(D_Y),
+                         frac[2] - static_cast<float>(D_Z),
+                         frac[3] - static_cast<float>(D_W));
+    }
+    // Interpolate along x (pairs of consecutive corners), then y, z and w
+    int32_t count = NUM_CORNERS;
+    for (int32_t axis = 0; axis < 4; axis++) {
+        count /= 2;
+        for (int32_t k = 0; k < count; k++) {
+            // NOLINTNEXTLINE
+            dots[k] = Lerp(dots[2 * k], dots[2 * k + 1], fade[axis]);
+        }
+    }
+    return dots[0];
+}
+
+/// Constants of simplex-noise in N dimensions (skewing factors, radius of
+/// the kernel of each corner, and scale to get values in about [-1, 1])
+template <int N>
+struct SimplexTraits;
+
+template <>
+struct SimplexTraits<2> {
+    static constexpr float F = 0.366025403F;  // (sqrt(3) - 1) / 2
+    static constexpr float G = 0.211324865F;  // (3 - sqrt(3)) / 6
+    static constexpr float RADIUS = 0.5F;
+    static constexpr float SCALE = 40.0F;
+    static auto Grad(int32_t hash, const float* p) -> float {
+        return GradSimplex2d(hash, p[0], p[1]);  // NOLINT
+    }
+};
+
+template <>
+struct SimplexTraits<3> {
+    static constexpr float F = 0.333333333F;  // 1 / 3
+    static constexpr float G = 0.166666667F;  // 1 / 6
+    static constexpr float RADIUS = 0.6F;
+    static constexpr float SCALE = 32.0F;
+    static auto Grad(int32_t hash, const float* p) -> float {
+        return Grad3d(hash, p[0], p[1], p[2]);  // NOLINT
+    }
+};
+
+template <>
+struct SimplexTraits<4> {
+    static constexpr float F = 0.309016994F;  // (sqrt(5) - 1) / 4
+    static constexpr float G = 0.138196601F;  // (5 - sqrt(5)) / 20
+    static constexpr float RADIUS = 0.6F;
+    static constexpr float SCALE = 27.0F;
+    static auto Grad(int32_t hash, const float* p) -> float {
+        return Grad4d(hash, p[0], p[1], p[2], p[3]);  // NOLINT
+    }
+};
+
+/// Simplex-noise in N dimensions (following S. Gustavson's reference). Only
+/// the N + 1 corners of the simplex that contains the point contribute,
+/// instead of the 2^N corners of a lattice cell
+template <int N>
+auto SimplexNd(const uint8_t* perm, const float* pos) -> float {
+    using Traits = SimplexTraits<N>;
+    // Skew the space to find the cell, and unskew it back to get the position
+    // relative to the origin of the cell
+    float sum = 0.0F;
+    for (int a = 0; a < N; a++) {
+        sum += pos[a];  // NOLINT
+    }
+    const float skew = sum * Traits::F;
+    int32_t cell[N];  // NOLINT
+    int32_t cell_sum = 0;
+    for (int a = 0; a < N; a++) {
+        cell[a] = static_cast<int32_t>(std::floor(pos[a] + skew));  // NOLINT
+        cell_sum += cell[a];                                        // NOLINT
+    }
+    const float unskew = static_cast<float>(cell_sum) * Traits::G;
+    float rel[N];  // NOLINT
+    for (int a = 0; a < N; a++) {
+        // NOLINTNEXTLINE
+        rel[a] = pos[a] - (static_cast<float>(cell[a]) - unskew);
+    }
+
+    // Rank the axes by the position along them, which gives the order in
+    // which the simplex steps along each axis from its first to last corner
+    int32_t rank[N] = {};  // NOLINT
+    for (int a = 0; a < N; a++) {
+        for (int b = a + 1; b < N; b++) {
+            if (rel[a] > rel[b]) {  // NOLINT
+                rank[a]++;          // NOLINT
+            } else {
+                rank[b]++;  // NOLINT
+            }
+        }
+    }
+
+    float noise = 0.0F;
+    for (int c = 0; c <= N; c++) {
+        int32_t offset[N];  // NOLINT
+        float corner[N];    // NOLINT
+        float weight = Traits::RADIUS;
+        for (int a = 0; a < N; a++) {
+            offset[a] = rank[a] >= N - c ? 1 : 0;  // NOLINT
+            // NOLINTNEXTLINE
+            corner[a] = rel[a] - static_cast<float>(offset[a]) +
+                        static_cast<float>(c) * Traits::G;
+            weight -= corner[a] * corner[a];  // NOLINT
+        }
+        if (weight <= 0.0F) {
+            continue;
+        }
+        int32_t hash = 0;
+        for (int a = N - 1; a >= 0; a--) {
+            // NOLINTNEXTLINE
+            hash = perm[(cell[a] & PERM_MASK) + offset[a] + hash];
+        }
+        weight *= weight;
+        noise += weight * weight * Traits::Grad(hash, corner);
+    }
+    return Traits::SCALE * noise;
+}
+
+}  // namespace
+
+auto PerlinRow3d(const PerlinRowNdArgs& args) -> void {
+    int32_t index[3] = {0, args.row_index[0], args.row_index[1]};  // NOLINT
+    float frac[3] = {0.0F, args.row_frac[0], args.row_frac[1]};    // NOLINT
+    float fade[3] = {0.0F, args.row_fade[0], args.row_fade[1]};    // NOLINT
+    for (size_t j = 0; j < args.width; j++) {
+        index[0] = args.cols_index[j];  // NOLINT
+        frac[0] = args.cols_frac[j];    // NOLINT
+        fade[0] = args.cols_fade[j];    // NOLINT
+        // NOLINTNEXTLINE
+        args.out[j] += args.ampl * PerlinCell3d(args.perm, index, frac, fade);
+    }
+}
+
+auto PerlinRow4d(const PerlinRowNdArgs& args) -> void {
+    int32_t index[4] = {0, args.row_index[0], args.row_index[1],
+                        args.row_index[2]};
+    float frac[4] = {0.0F, args.row_frac[0], args.row_frac[1],
+                     args.row_frac[2]};
+    float fade[4] = {0.0F, args.row_fade[0], args.row_fade[1],
+                     args.row_fade[2]};
+    for (size_t j = 0; j < args.width; j++) {
+        index[0] = args.cols_index[j];
+        frac[0] = args.cols_frac[j];
+        fade[0] = args.cols_fade[j];
+        args.out[j] += args.ampl * PerlinCell4d(args.perm, index, frac, fade);
+    }
+}
+
+auto Perlin3d(const uint8_t* perm, float x, float y, float z) -> float {
+    int32_t index[3];
+    float frac[3];
+    Split(x, &index[0], &frac[0]);
+    Split(y, &index[1], &frac[1]);
+    Split(z, &index[2], &frac[2]);
+    const float fade[3] = {Fade(frac[0]), Fade(frac[1]), Fade(frac[2])};
+    return PerlinCell3d(perm, index, frac, fade);
+}
+
+auto Perlin4d(const uint8_t* perm, float x, float y, float z, float w)
+    -> float {
+    int32_t index[4];
+    float frac[4];
+    Split(x, &index[0], &frac[0]);
+    Split(y, &index[1], &frac[1]);
+    Split(z, &index[2], &frac[2]);
+    Split(w, &index[3], &frac[3]);
+    const float fade[4] = {Fade(frac[0]), Fade(frac[1]), Fade(frac[2]),
+                           Fade(frac[3])};
+    return PerlinCell4d(perm, index, frac, fade);
+}
+
+auto Simplex2d(const uint8_t* perm, float x, float y) -> float {
+    const float pos[2] = {x, y};  // NOLINT
+    return SimplexNd<2>(perm, pos);
+}
+
+auto Simplex3d(const uint8_t* perm, float x, float y, float z) -> float {
+    const float pos[3] = {x, y, z};  // NOLINT
+    return SimplexNd<3>(perm, pos);
+}
+
+auto Simplex4d(const uint8_t* perm, float x, float y, float z, float w)
+    -> float {
+    const float pos[4] = {x, y, z, w};  // NOLINT
+    return SimplexNd<4>(perm, pos);
+}
+
+}  // namespace kernels
+}  // namespace utils
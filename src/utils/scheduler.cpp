@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <utils/scheduler.hpp>
+
+namespace utils {
+
+namespace {
+
+constexpr double NS_TO_SECONDS = 1e-9;
+constexpr double SECONDS_TO_NS = 1e9;
+
+}  // namespace
+
+auto PreciseSleepUntil(int64_t deadline_ns, int64_t spin_threshold_ns)
+    -> void {
+    const auto remaining_ns = deadline_ns - Clock::GetTimeStampNs();
+    if (remaining_ns > spin_threshold_ns) {
+        // Coarse sleep (nanosleep on POSIX), which might oversleep by up to
+        // the scheduler's wake-up latency, hence the spinning tail below
+        std::this_thread::sleep_for(
+            std::chrono::nanoseconds(remaining_ns - spin_threshold_ns));
+    }
+    while (Clock::GetTimeStampNs() < deadline_ns) {
+        // Busy-wait for the remaining (short) interval
+    }
+}
+
+FixedStepScheduler::FixedStepScheduler(double step_size,
+                                       size_t max_catch_up_steps, Clock* clock,
+                                       const std::string& event_name)
+    : m_StepSize(step_size),
+      m_StepNs(static_cast<int64_t>(std::llround(step_size * SECONDS_TO_NS))),
+      m_MaxCatchUpSteps(std::max<size_t>(max_catch_up_steps, 1)),
+      m_Clock(clock) {
+    LOG_CORE_ASSERT(
+        m_StepNs > 0,
+        "FixedStepScheduler >>> step size must be positive, got {0}",
+        step_size);
+    // The assertion might just log and continue, but the accumulator is still
+    // divided by the step, so fall back to the smallest representable one
+    m_StepNs = std::max<int64_t>(m_StepNs, 1);
+    if (m_Clock != nullptr) {
+        m_Event = Clock::RegisterEvent(event_name);
+    }
+}
+
+auto FixedStepScheduler::WaitForNextStep() -> void {
+    if (m_LastUpdateNs == 0) {
+        return;
+    }
+    const auto deadline_ns = m_LastUpdateNs + (m_StepNs - m_AccumulatorNs);
+    PreciseSleepUntil(deadline_ns, m_SpinThresholdNs);
+    const auto lateness =
+        static_cast<double>(Clock::GetTimeStampNs() - deadline_ns) *
+        NS_TO_SECONDS;
+    m_Jitter.Push(lateness);
+    m_MaxJitter = std::max(m_MaxJitter, lateness);
+}
+
+auto FixedStepScheduler::Reset() -> void {
+    m_AccumulatorNs = 0;
+    m_LastUpdateNs = 0;
+    m_NumSteps = 0;
+    m_NumDroppedSteps = 0;
+    m_Jitter.Resize(m_Jitter.window_size());
+    m_MaxJitter = 0.0;
+}
+
+auto FixedStepScheduler::_Accumulate() -> void {
+    const auto now_ns = Clock::GetTimeStampNs();
+    // The first update only sets the time reference
+    if (m_LastUpdateNs != 0) {
+        m_AccumulatorNs += now_ns - m_LastUpdateNs;
+    }
+    m_LastUpdateNs = now_ns;
+}
+
+auto FixedStepScheduler::_DropExcess() -> void {
+    if (m_AccumulatorNs < m_StepNs) {
+        return;
+    }
+    // We fell too far behind (e.g. a debugger break), so rather than trying
+    // to catch up (spiral of death) we drop the whole steps we couldn't run
+    m_NumDroppedSteps += static_cast<uint64_t>(m_AccumulatorNs / m_StepNs);
+    m_AccumulatorNs %= m_StepNs;
+}
+
+}  // namespace utils
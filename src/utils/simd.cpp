@@ -0,0 +1,79 @@
+#include <utils/simd.hpp>
+
+#if defined(UTILS_SIMD_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace utils {
+
+namespace {
+
+auto DetectSimdLevel() -> eSimdLevel {
+#if defined(UTILS_SIMD_X86)
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return eSimdLevel::AVX2;
+    }
+#elif defined(_MSC_VER)
+    constexpr int OSXSAVE_BIT = 1 << 27;
+    constexpr int AVX2_BIT = 1 << 5;
+    constexpr unsigned long long YMM_STATE = 0x6;  // NOLINT
+    int info[4] = {0, 0, 0, 0};                     // NOLINT
+    __cpuid(info, 1);
+    // The OS must also save the upper halves of the ymm registers
+    const bool has_osxsave = (info[2] & OSXSAVE_BIT) != 0;  // NOLINT
+    if (has_osxsave && (_xgetbv(0) & YMM_STATE) == YMM_STATE) {
+        __cpuidex(info, 7, 0);
+        if ((info[1] & AVX2_BIT) != 0) {  // NOLINT
+            return eSimdLevel::AVX2;
+        }
+    }
+#endif
+    return eSimdLevel::SSE2;
+#elif defined(UTILS_SIMD_NEON)
+    return eSimdLevel::NEON;
+#else
+    return eSimdLevel::SCALAR;
+#endif
+}
+
+}  // namespace
+
+auto GetSupportedSimdLevel() -> eSimdLevel {
+    // The cpu doesn't change while running, so detect its features only once
+    static const eSimdLevel s_Level = DetectSimdLevel();  // NOLINT
+    return s_Level;
+}
+
+auto IsSimdLevelSupported(eSimdLevel level) -> bool {
+    const auto supported = GetSupportedSimdLevel();
+    switch (level) {
+        case eSimdLevel::SCALAR:
+            return true;
+        case eSimdLevel::SSE2:
+            return supported == eSimdLevel::SSE2 ||
+                   supported == eSimdLevel::AVX2;
+        case eSimdLevel::AVX2:
+        case eSimdLevel::NEON:
+            return supported == level;
+    }
+    return false;
+}
+
+auto ToString(eSimdLevel level) -> std::string {
+    switch (level) {
+        case eSimdLevel::SCALAR:
+            return "scalar";
+        case eSimdLevel::SSE2:
+            return "sse2";
+        case eSimdLevel::AVX2:
+            return "avx2";
+        case eSimdLevel::NEON:
+            return "neon";
+    }
+    return "undefined";
+}
+
+}  // namespace utils
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <utility>
+
+#include <utils/thread_pool.hpp>
+
+namespace utils {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        num_threads = std::max<size_t>(hardware_threads, 2) - 1;
+    }
+    m_Workers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; i++) {
+        m_Workers.emplace_back(new Worker());
+    }
+    // Start the threads only once all the queues exist (they steal from each
+    // other right away)
+    for (size_t i = 0; i < num_threads; i++) {
+        m_Workers[i]->thread = std::thread([this, i]() { _Run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_Running.store(false, std::memory_order_release);
+    }
+    m_SleepCondVar.notify_all();
+    for (auto& worker : m_Workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+auto ThreadPool::Submit(Task task) -> void {
+    if (m_Workers.empty()) {
+        task();
+        return;
+    }
+    const auto worker = m_NextWorker.fetch_add(1, std::memory_order_relaxed) %
+                        m_Workers.size();
+    _Push(worker, std::move(task));
+    _WakeUp();
+}
+
+auto ThreadPool::ParallelFor(size_t num_tasks,
+                             const std::function<void(size_t)>& fn) -> void {
+    if (m_Workers.empty() || num_tasks <= 1) {
+        for (size_t i = 0; i < num_tasks; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> num_remaining{num_tasks};
+    // Deal the tasks evenly, and let stealing balance uneven workloads
+    const auto first_worker =
+        m_NextWorker.fetch_add(1, std::memory_order_relaxed);
+    const auto num_workers = m_Workers.size();
+    for (size_t i = 0; i < num_tasks; i++) {
+        _Push((first_worker + i) % num_workers, [&fn, &num_remaining, i]() {
+            fn(i);
+            num_remaining.fetch_sub(1, std::memory_order_acq_rel);
+        });
+    }
+    _WakeUp();
+
+    // Help with the work (ours or from other callers) until all tasks are done
+    Task task;
+    while (num_remaining.load(std::memory_order_acquire) > 0) {
+        if (_Steal(first_worker, task)) {
+            task();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+auto ThreadPool::GetDefault() -> ThreadPool& {
+    static ThreadPool s_Pool;  // NOLINT
+    return s_Pool;
+}
+
+auto ThreadPool::_Push(size_t worker, Task task) -> void {
+    {
+        std::lock_guard<std::mutex> lock(m_Workers[worker]->mutex);
+        m_Workers[worker]->tasks.push_back(std::move(task));
+    }
+    m_NumQueued.fetch_add(1, std::memory_order_release);
+}
+
+auto ThreadPool::_PopLocal(size_t worker, Task& task) -> bool {
+    auto& queue = *m_Workers[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    m_NumQueued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+auto ThreadPool::_Steal(size_t start, Task& task) -> bool {
+    const auto num_workers = m_Workers.size();
+    for (size_t i = 0; i < num_workers; i++) {
+        auto& victim = *m_Workers[(start + i) % num_workers];
+        // Don't wait on busy queues, just try the next one
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) {
+            continue;
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        m_NumQueued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+auto ThreadPool::_WakeUp() -> void {
+    // Taking the lock avoids missing the wake-up of a worker that checked the
+    // number of queued tasks right before we queued ours
+    { std::lock_guard<std::mutex> lock(m_SleepMutex); }
+    m_SleepCondVar.notify_all();
+}
+
+auto ThreadPool::_Run(size_t worker) -> void {
+    Task task;
+    while (true) {
+        if (_PopLocal(worker, task) || _Steal(worker + 1, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_SleepCondVar.wait(lock, [this]() {
+            return !m_Running.load(std::memory_order_acquire) ||
+                   m_NumQueued.load(std::memory_order_acquire) > 0;
+        });
+        // Finish the queued tasks before stopping
+        if (!m_Running.load(std::memory_order_acquire) &&
+            m_NumQueued.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+}  // namespace utils
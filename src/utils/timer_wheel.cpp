@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cmath>
+
+#include <utils/scheduler.hpp>
+#include <utils/timer_wheel.hpp>
+
+namespace utils {
+
+namespace {
+
+constexpr double NS_TO_SECONDS = 1e-9;
+constexpr double SECONDS_TO_NS = 1e9;
+
+/// Tolerance used when quantizing times into ticks, so that times that are
+/// exact multiples of the resolution don't end up one tick off
+constexpr double TICK_EPSILON = 1e-9;
+
+}  // namespace
+
+TimerWheel::TimerWheel(double resolution, double start_time) {
+    LOG_CORE_ASSERT(resolution > 0.0,
+                    "TimerWheel >>> resolution must be positive, got {0}",
+                    resolution);
+    if (resolution > 0.0) {
+        m_Resolution = resolution;
+    }
+    m_Heads.fill(NIL);
+    m_Tails.fill(NIL);
+    m_CurrentTick = static_cast<uint64_t>(
+        std::max(std::floor(start_time / m_Resolution + TICK_EPSILON), 0.0));
+}
+
+TimerWheel::~TimerWheel() {
+    StopThread();
+    for (auto& node : m_Nodes) {
+        if (node.state != eNodeState::FREE) {
+            node.destroy(node.storage);
+        }
+    }
+}
+
+auto TimerWheel::Cancel(TimerHandle handle) -> bool {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!handle.valid() || handle.index >= m_Nodes.size()) {
+        return false;
+    }
+    auto& node = m_Nodes[handle.index];
+    if (node.generation != handle.generation ||
+        node.state != eNodeState::PENDING) {
+        return false;
+    }
+    _Unlink(handle.index);
+    _ReleaseNode(handle.index);
+    m_NumPending--;
+    return true;
+}
+
+auto TimerWheel::Advance(double time) -> void {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    const auto target_tick = static_cast<uint64_t>(
+        std::max(std::floor(time / m_Resolution + TICK_EPSILON), 0.0));
+    while (m_CurrentTick < target_tick) {
+        // Nothing to expire, so jump straight to the target
+        if (m_NumPending == 0) {
+            m_CurrentTick = target_tick;
+            break;
+        }
+        _Tick();
+    }
+    _RunExpired(lock);
+}
+
+auto TimerWheel::StartThread() -> void {
+    if (m_ThreadRunning.exchange(true)) {
+        return;
+    }
+    m_Thread = std::thread([this]() {
+        const auto start_time = current_time();
+        const auto start_ns = Clock::GetTimeStampNs();
+        const auto tick_ns =
+            std::max<int64_t>(std::llround(m_Resolution * SECONDS_TO_NS), 1);
+        auto deadline_ns = start_ns + tick_ns;
+        while (m_ThreadRunning.load(std::memory_order_acquire)) {
+            PreciseSleepUntil(deadline_ns, 0);
+            const auto now_ns = Clock::GetTimeStampNs();
+            Advance(start_time +
+                    static_cast<double>(now_ns - start_ns) * NS_TO_SECONDS);
+            // Skip the ticks we missed (Advance already caught up with them)
+            deadline_ns += tick_ns * ((now_ns - deadline_ns) / tick_ns + 1);
+        }
+    });
+}
+
+auto TimerWheel::StopThread() -> void {
+    m_ThreadRunning.store(false, std::memory_order_release);
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+}
+
+auto TimerWheel::size() const -> size_t {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_NumPending;
+}
+
+auto TimerWheel::current_time() const -> double {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return static_cast<double>(m_CurrentTick) * m_Resolution;
+}
+
+auto TimerWheel::_ToTick(double time) const -> uint64_t {
+    // Round up, so timers never fire before the requested time. Timers in the
+    // past (or due now) fire on the next tick, as the current one is done
+    const auto tick = static_cast<uint64_t>(
+        std::max(std::ceil(time / m_Resolution - TICK_EPSILON), 0.0));
+    return std::max(tick, m_CurrentTick + 1);
+}
+
+auto TimerWheel::_AllocateNode() -> uint32_t {
+    uint32_t index = m_FreeHead;
+    if (index == NIL) {
+        index = static_cast<uint32_t>(m_Nodes.size());
+        m_Nodes.emplace_back();
+    } else {
+        m_FreeHead = m_Nodes[index].next;
+    }
+    auto& node = m_Nodes[index];
+    node.prev = NIL;
+    node.next = NIL;
+    node.list = NIL;
+    node.state = eNodeState::PENDING;
+    m_NumPending++;
+    return index;
+}
+
+auto TimerWheel::_ReleaseNode(uint32_t index) -> void {
+    auto& node = m_Nodes[index];
+    node.destroy(node.storage);
+    node.invoke = nullptr;
+    node.destroy = nullptr;
+    node.generation++;
+    node.state = eNodeState::FREE;
+    node.list = NIL;
+    node.prev = NIL;
+    node.next = m_FreeHead;
+    m_FreeHead = index;
+}
+
+auto TimerWheel::_Insert(uint32_t index) -> void {
+    const auto& node = m_Nodes[index];
+    // Nodes due on the current tick (only when cascading) go into the slot
+    // that is about to be expired
+    const auto delta = node.deadline - m_CurrentTick;
+    for (size_t level = 0; level < NUM_LEVELS; level++) {
+        if (delta < (uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+            const auto slot =
+                (node.deadline >> (SLOT_BITS * level)) & (NUM_SLOTS - 1);
+            _Link(index, static_cast<uint32_t>(level * NUM_SLOTS + slot));
+            return;
+        }
+    }
+    // Out of the range of the wheel, so park the timer in the furthest slot of
+    // the last level (it gets re-inserted once that slot is cascaded)
+    const auto range = uint64_t{1} << (SLOT_BITS * NUM_LEVELS);
+    const auto parked = m_CurrentTick + range - 1;
+    const auto slot =
+        (parked >> (SLOT_BITS * (NUM_LEVELS - 1))) & (NUM_SLOTS - 1);
+    _Link(index, static_cast<uint32_t>((NUM_LEVELS - 1) * NUM_SLOTS + slot));
+}
+
+auto TimerWheel::_Link(uint32_t index, uint32_t list) -> void {
+    auto& node = m_Nodes[index];
+    node.list = list;
+    node.next = NIL;
+    node.prev = m_Tails[list];
+    if (node.prev == NIL) {
+        m_Heads[list] = index;
+    } else {
+        m_Nodes[node.prev].next = index;
+    }
+    m_Tails[list] = index;
+}
+
+auto TimerWheel::_Unlink(uint32_t index) -> void {
+    auto& node = m_Nodes[index];
+    if (node.prev == NIL) {
+        m_Heads[node.list] = node.next;
+    } else {
+        m_Nodes[node.prev].next = node.next;
+    }
+    if (node.next == NIL) {
+        m_Tails[node.list] = node.prev;
+    } else {
+        m_Nodes[node.next].prev = node.prev;
+    }
+    node.prev = NIL;
+    node.next = NIL;
+    node.list = NIL;
+}
+
+auto TimerWheel::_Cascade(size_t level) -> size_t {
+    const auto slot =
+        (m_CurrentTick >> (SLOT_BITS * level)) & (NUM_SLOTS - 1);
+    const auto list = static_cast<uint32_t>(level * NUM_SLOTS + slot);
+    // Detach the whole list first, as re-inserting might append to it again
+    auto index = m_Heads[list];
+    m_Heads[list] = NIL;
+    m_Tails[list] = NIL;
+    while (index != NIL) {
+        const auto next = m_Nodes[index].next;
+        _Insert(index);
+        index = next;
+    }
+    return static_cast<size_t>(slot);
+}
+
+auto TimerWheel::_Tick() -> void {
+    m_CurrentTick++;
+    const auto slot = static_cast<uint32_t>(m_CurrentTick & (NUM_SLOTS - 1));
+    // Once a level wraps around, bring the timers of the next slot of the
+    // level above closer (and so on, while the levels keep wrapping around)
+    auto wrapped = (slot == 0);
+    for (size_t level = 1; wrapped && level < NUM_LEVELS; level++) {
+        wrapped = (_Cascade(level) == 0);
+    }
+    while (m_Heads[slot] != NIL) {
+        const auto index = m_Heads[slot];
+        _Unlink(index);
+        m_Nodes[index].state = eNodeState::EXPIRED;
+        _Link(index, EXPIRED_LIST);
+        m_NumPending--;
+    }
+}
+
+auto TimerWheel::_RunExpired(std::unique_lock<std::mutex>& lock) -> void {
+    while (m_Heads[EXPIRED_LIST] != NIL) {
+        const auto index = m_Heads[EXPIRED_LIST];
+        _Unlink(index);
+        // Nodes live in a deque, so the reference survives the pool growing
+        // while the callback runs (e.g. if it schedules other timers)
+        auto& node = m_Nodes[index];
+        node.state = eNodeState::RUNNING;
+        lock.unlock();
+        node.invoke(node.storage);
+        lock.lock();
+        _ReleaseNode(index);
+    }
+}
+
+}  // namespace utils
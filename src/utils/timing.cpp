@@ -1,180 +1,963 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <functional>
 #include <memory>
+#include <thread>
+#include <utility>
 
+#include <utils/profiling.hpp>
 #include <utils/timing.hpp>
 
 namespace utils {
 
 auto ClockEvent::ToString() const -> std::string {
-    std::string str_rep;
-    str_rep += "event   : " + name + "\n\r";
-    str_rep += "start   : " + std::to_string(time_start) + "\n\r";
-    str_rep += "stop    : " + std::to_string(time_stop) + "\n\r";
-    str_rep += "duration: " + std::to_string(time_duration) + "\n\r";
-    return str_rep;
+    return fmt::format(
+        "event   : {0}\n\r"
+        "start   : {1:f}\n\r"
+        "stop    : {2:f}\n\r"
+        "duration: {3:f}\n\r",
+        name, time_start, time_stop, time_duration);
 }
 
-// NOLINTNEXTLINE : using singleton here (instance is not publicly available)
-std::unique_ptr<Clock> Clock::s_Instance = nullptr;
+namespace {
+
+constexpr double NS_TO_SECONDS = 1e-9;
+
+/// Returns 1/time_step, or 0 if no time has elapsed (avoids inf/nan fps)
+auto SafeFps(double time_step) -> double {
+    return (time_step > 0.0) ? (1.0 / time_step) : 0.0;
+}
+
+// NOLINTNEXTLINE : internal state of the clock module
+struct ClockState {
+    ClockState() {
+        event_names.emplace_back(MAIN_EVENT);
+        event_indices[MAIN_EVENT] = Clock::MAIN_EVENT_INDEX;
+        num_events.store(1, std::memory_order_release);
+        retired_threads.clock_name = "retired-threads";
+    }
+
+    /// Registry of events shared by all clocks (names indexed by handle)
+    std::mutex events_mutex;
+    std::vector<std::string> event_names;
+    std::unordered_map<std::string, uint32_t> event_indices;
+    std::atomic<uint32_t> num_events{0};
+    /// All live clocks (used for snapshots)
+    std::mutex clocks_mutex;
+    std::vector<Clock*> clocks;
+    /// Clocks of the threads that use the static API (owned by the threads
+    /// themselves), attached to the module since its last Init/Release
+    std::vector<Clock*> thread_clocks;
+    /// Events of the thread clocks whose threads already finished, merged
+    /// into a single snapshot
+    ClockSnapshot retired_threads;
+    /// Bumped on Init/Release, so threads lazily create a new clock
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool> initialized{false};
+    /// Size of the averaging-windows of newly created clocks
+    std::atomic<size_t> window_size{NUM_FRAMES_FOR_AVG};
+};
+
+auto GetState() -> ClockState& {
+    static ClockState s_State;  // NOLINT
+    return s_State;
+}
+
+auto LookupEventName(uint32_t index) -> std::string {
+    auto& state = GetState();
+    std::lock_guard<std::mutex> lock(state.events_mutex);
+    return (index < state.event_names.size()) ? state.event_names[index] : "";
+}
+
+auto MakeEmptyEvent(std::string name) -> ClockEvent {
+    return {std::move(name), 0.0, 0.0, 0.0, 0, 0, 0, 0, 0, ClockEventStats{}};
+}
+
+/// Detaches the clocks of all threads from the module. The clocks aren't
+/// touched at all, as their threads might be using them right now: each
+/// thread resets its own clock the next time it uses it (see the generation)
+auto ResetThreadClocks(ClockState& state) -> void {
+    std::lock_guard<std::mutex> lock(state.clocks_mutex);
+    for (const auto* clock : state.thread_clocks) {
+        state.clocks.erase(
+            std::remove(state.clocks.begin(), state.clocks.end(), clock),
+            state.clocks.end());
+    }
+    state.thread_clocks.clear();
+    state.retired_threads.events.clear();
+    state.generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+/// Thread-local handle to the clock of a thread that uses the static API. The
+/// clock is owned by the thread, so references to it stay valid until the
+/// thread finishes (even across Init/Release). Once the thread finishes, its
+/// events are folded into the retired-threads snapshot
+struct ThreadClockHandle {
+    ThreadClockHandle() = default;
+    ThreadClockHandle(const ThreadClockHandle&) = delete;
+    ThreadClockHandle(ThreadClockHandle&&) = delete;
+    auto operator=(const ThreadClockHandle&) -> ThreadClockHandle& = delete;
+    auto operator=(ThreadClockHandle&&) -> ThreadClockHandle& = delete;
+
+    ~ThreadClockHandle() {
+        if (clock == nullptr) {
+            return;
+        }
+        auto& state = GetState();
+        clock->FlushIntervals();
+        {
+            std::lock_guard<std::mutex> lock(state.clocks_mutex);
+            // If the module was reset meanwhile, the clock is already detached
+            auto it = std::find(state.thread_clocks.begin(),
+                                state.thread_clocks.end(), clock.get());
+            if (it != state.thread_clocks.end()) {
+                // Hand over the events in one step, so snapshots taken
+                // meanwhile see them either in the clock or in the retired
+                // ones
+                auto snapshot = clock->TakeSnapshot();
+                state.clocks.erase(std::remove(state.clocks.begin(),
+                                               state.clocks.end(), clock.get()),
+                                   state.clocks.end());
+                state.retired_threads.events =
+                    Clock::Merge({state.retired_threads, std::move(snapshot)});
+                state.thread_clocks.erase(it);
+            }
+        }
+        // Destroyed outside of the lock, as the clock unregisters itself
+        clock.reset();
+    }
+
+    Clock::uptr clock = nullptr;
+    uint64_t generation = 0;
+};
+
+// NOLINTNEXTLINE : lives as long as the thread
+thread_local ThreadClockHandle s_ThreadClock;
+
+/// Partial sums used to merge the statistics of an event across clocks
+struct StatsAccumulator {
+    uint64_t window_count = 0;
+    uint64_t num_samples = 0;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    double ewma = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+};
+
+/// Offset (in microseconds) from the clock used by Clock to the one used by
+/// the profiler, so both kinds of results line up in the same session
+std::atomic<int64_t> g_ProfilerOffsetUs{0};  // NOLINT
+
+/// Hook used to forward the intervals of the scoped guards to the profiler
+auto ForwardScopeToProfiler(ClockEventHandle handle, int64_t start_ns,
+                            int64_t stop_ns) -> void {
+    constexpr int64_t NS_PER_US = 1000;
+    constexpr double NS_TO_MS = 1e-6;
+    // Cache the names per thread, to avoid locking the registry every time
+    // NOLINTNEXTLINE
+    static thread_local std::vector<std::string> s_Names;
+    if (handle.index >= s_Names.size()) {
+        s_Names.resize(handle.index + 1);
+    }
+    auto& name = s_Names[handle.index];
+    if (name.empty()) {
+        name = LookupEventName(handle.index);
+    }
+    const auto offset_us = g_ProfilerOffsetUs.load(std::memory_order_relaxed);
+    ProfilerResult result;
+    result.name = name;
+    result.time_start = start_ns / NS_PER_US + offset_us;
+    result.time_end = stop_ns / NS_PER_US + offset_us;
+    result.time_duration = static_cast<double>(stop_ns - start_ns) * NS_TO_MS;
+    Profiler::WriteProfileResult(result);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+std::atomic<ClockScopeHook> Clock::s_ScopeHook{nullptr};
+
+P2QuantileEstimator::P2QuantileEstimator(double quantile)
+    : m_Quantile(quantile) {
+    Reset();
+}
+
+auto P2QuantileEstimator::Push(double value) -> void {
+    // Bootstrap with the first samples, which become the initial markers
+    if (m_Count < NUM_MARKERS) {
+        m_Heights[m_Count++] = value;
+        if (m_Count == NUM_MARKERS) {
+            std::sort(m_Heights.begin(), m_Heights.end());
+        }
+        return;
+    }
+
+    // Find the cell the new sample falls into (adjusting the extremes)
+    size_t cell = 0;
+    if (value < m_Heights[0]) {
+        m_Heights[0] = value;
+        cell = 0;
+    } else if (value >= m_Heights[NUM_MARKERS - 1]) {
+        m_Heights[NUM_MARKERS - 1] = value;
+        cell = NUM_MARKERS - 2;
+    } else {
+        while (cell < NUM_MARKERS - 2 && value >= m_Heights[cell + 1]) {
+            cell++;
+        }
+    }
+    for (size_t i = cell + 1; i < NUM_MARKERS; i++) {
+        m_Positions[i] += 1.0;
+    }
+    for (size_t i = 0; i < NUM_MARKERS; i++) {
+        m_DesiredPositions[i] += m_Increments[i];
+    }
+
+    // Move the middle markers towards their desired positions, using a
+    // piecewise-parabolic prediction (or a linear one if it's not monotonic)
+    for (size_t i = 1; i < NUM_MARKERS - 1; i++) {
+        const auto delta = m_DesiredPositions[i] - m_Positions[i];
+        if ((delta >= 1.0 && m_Positions[i + 1] - m_Positions[i] > 1.0) ||
+            (delta <= -1.0 && m_Positions[i - 1] - m_Positions[i] < -1.0)) {
+            const auto step = (delta >= 0.0) ? 1.0 : -1.0;
+            const auto n_prev = m_Positions[i - 1];
+            const auto n_curr = m_Positions[i];
+            const auto n_next = m_Positions[i + 1];
+            const auto parabolic =
+                m_Heights[i] +
+                step / (n_next - n_prev) *
+                    ((n_curr - n_prev + step) *
+                         (m_Heights[i + 1] - m_Heights[i]) / (n_next - n_curr) +
+                     (n_next - n_curr - step) *
+                         (m_Heights[i] - m_Heights[i - 1]) / (n_curr - n_prev));
+            if (m_Heights[i - 1] < parabolic && parabolic < m_Heights[i + 1]) {
+                m_Heights[i] = parabolic;
+            } else {
+                const auto j = (step > 0.0) ? i + 1 : i - 1;
+                m_Heights[i] += step * (m_Heights[j] - m_Heights[i]) /
+                                (m_Positions[j] - n_curr);
+            }
+            m_Positions[i] += step;
+        }
+    }
+    m_Count++;
+}
+
+auto P2QuantileEstimator::Reset() -> void {
+    const auto q = m_Quantile;
+    m_Count = 0;
+    m_Heights.fill(0.0);
+    m_Positions = {0.0, 1.0, 2.0, 3.0, 4.0};
+    m_DesiredPositions = {0.0, 2.0 * q, 4.0 * q, 2.0 + 2.0 * q, 4.0};
+    m_Increments = {0.0, q / 2.0, q, (1.0 + q) / 2.0, 1.0};
+}
+
+auto P2QuantileEstimator::value() const -> double {
+    if (m_Count == 0) {
+        return 0.0;
+    }
+    if (m_Count < NUM_MARKERS) {
+        // Not enough samples for the markers yet, so use the exact quantile
+        auto samples = m_Heights;
+        std::sort(samples.begin(), samples.begin() + m_Count);
+        const auto index = static_cast<size_t>(
+            std::round(m_Quantile * static_cast<double>(m_Count - 1)));
+        return samples[index];
+    }
+    return m_Heights[2];
+}
+
+RollingStats::RollingStats(size_t window_size) { Resize(window_size); }
+
+auto RollingStats::Push(double value) -> void {
+    m_Ewma = (m_Count == 0) ? value : m_Ewma + m_EwmaAlpha * (value - m_Ewma);
+    const auto evicted = m_Window[m_Index];
+    const auto is_full = (m_Count == m_Window.size());
+    const auto position = m_NumPushed++;
+    m_Window[m_Index] = value;
+    m_Index = (m_Index + 1) % m_Window.size();
+
+    _PushExtreme(m_MinQueue, position, std::less<double>());
+    _PushExtreme(m_MaxQueue, position, std::greater<double>());
+    m_Min = m_Window[m_MinQueue.positions[m_MinQueue.front] % m_Window.size()];
+    m_Max = m_Window[m_MaxQueue.positions[m_MaxQueue.front] % m_Window.size()];
+
+    if (!is_full) {
+        m_Count++;
+        m_Sum += value;
+        m_SumSq += value * value;
+    } else if (m_Index == 0) {
+        // Recompute the sums once per lap around the ring (amortized constant
+        // time), which keeps their rounding errors from drifting
+        _RecomputeSums();
+    } else {
+        m_Sum += value - evicted;
+        m_SumSq += value * value - evicted * evicted;
+    }
+}
+
+auto RollingStats::Resize(size_t window_size) -> void {
+    m_Window.assign(std::max<size_t>(window_size, 1), 0.0);
+    m_EwmaAlpha = 2.0 / (static_cast<double>(m_Window.size()) + 1.0);
+    m_Index = 0;
+    m_Count = 0;
+    m_NumPushed = 0;
+    for (auto* queue : {&m_MinQueue, &m_MaxQueue}) {
+        queue->positions.assign(m_Window.size(), 0);
+        queue->front = 0;
+        queue->size = 0;
+    }
+    m_Sum = 0.0;
+    m_SumSq = 0.0;
+    m_Min = 0.0;
+    m_Max = 0.0;
+    m_Ewma = 0.0;
+}
+
+auto RollingStats::mean() const -> double {
+    return (m_Count > 0) ? m_Sum / static_cast<double>(m_Count) : 0.0;
+}
+
+auto RollingStats::stddev() const -> double {
+    if (m_Count == 0) {
+        return 0.0;
+    }
+    const auto mean = m_Sum / static_cast<double>(m_Count);
+    const auto variance = m_SumSq / static_cast<double>(m_Count) - mean * mean;
+    return (variance > 0.0) ? std::sqrt(variance) : 0.0;
+}
+
+auto RollingStats::_RecomputeSums() -> void {
+    m_Sum = 0.0;
+    m_SumSq = 0.0;
+    for (size_t i = 0; i < m_Count; i++) {
+        const auto value = m_Window[i];
+        m_Sum += value;
+        m_SumSq += value * value;
+    }
+}
+
+template <typename Compare>
+auto RollingStats::_PushExtreme(ExtremesQueue& queue, uint64_t position,
+                                Compare keep) -> void {
+    const auto capacity = m_Window.size();
+    // At most one sample leaves the window per push, and it's the oldest one
+    if (queue.size > 0 && queue.positions[queue.front] + capacity <= position) {
+        queue.front = (queue.front + 1) % capacity;
+        queue.size--;
+    }
+    const auto value = m_Window[position % capacity];
+    while (queue.size > 0) {
+        const auto back = (queue.front + queue.size - 1) % capacity;
+        if (keep(m_Window[queue.positions[back] % capacity], value)) {
+            break;
+        }
+        queue.size--;
+    }
+    queue.positions[(queue.front + queue.size) % capacity] = position;
+    queue.size++;
+}
+
+auto Clock::EventRecord::ResetStats(size_t window_size) -> void {
+    window.Resize(window_size);
+    estimator_p50.Reset();
+    estimator_p99.Reset();
+    estimator_p999.Reset();
+    window_count.store(0, std::memory_order_relaxed);
+    mean.store(0.0, std::memory_order_relaxed);
+    stddev.store(0.0, std::memory_order_relaxed);
+    min.store(0.0, std::memory_order_relaxed);
+    max.store(0.0, std::memory_order_relaxed);
+    ewma.store(0.0, std::memory_order_relaxed);
+    p50.store(0.0, std::memory_order_relaxed);
+    p99.store(0.0, std::memory_order_relaxed);
+    p999.store(0.0, std::memory_order_relaxed);
+}
 
 auto Clock::Init() -> void {
-    if (!s_Instance) {
-        s_Instance = std::make_unique<Clock>();
+    auto& state = GetState();
+    ResetThreadClocks(state);
+    state.initialized.store(true, std::memory_order_release);
+}
+
+auto Clock::Release() -> void {
+    auto& state = GetState();
+    state.initialized.store(false, std::memory_order_release);
+    ResetThreadClocks(state);
+}
+
+auto Clock::RegisterEvent(const std::string& event_name) -> ClockEventHandle {
+    auto& state = GetState();
+    std::lock_guard<std::mutex> lock(state.events_mutex);
+    auto it = state.event_indices.find(event_name);
+    if (it != state.event_indices.end()) {
+        return ClockEventHandle{it->second};
     }
+    const auto index = static_cast<uint32_t>(state.event_names.size());
+    state.event_names.push_back(event_name);
+    state.event_indices[event_name] = index;
+    state.num_events.store(index + 1, std::memory_order_release);
+    return ClockEventHandle{index};
+}
 
-    // All these book-keeping variables are associated with the main event
-    s_Instance->m_TimeCurrent = 0.0;
-    s_Instance->m_TimeStep = 0.0;
-    s_Instance->m_TimeStepAvg = 0.0;
-    s_Instance->m_TimeIndex = 0;
-    for (size_t i = 0; i < NUM_FRAMES_FOR_AVG; i++) {
-        s_Instance->m_TimesBuffer[i] = 0.0;
-        s_Instance->m_FpsBuffer[i] = 0.0;
+auto Clock::GetEventName(ClockEventHandle handle) -> std::string {
+    return LookupEventName(handle.index);
+}
+
+auto Clock::GetNumEvents() -> uint32_t {
+    return GetState().num_events.load(std::memory_order_acquire);
+}
+
+auto Clock::SetScopeHook(ClockScopeHook hook) -> void {
+    s_ScopeHook.store(hook, std::memory_order_relaxed);
+}
+
+auto Clock::ForwardScopesToProfiler(bool enabled) -> void {
+    if (!enabled) {
+        SetScopeHook(nullptr);
+        return;
+    }
+    // The profiler uses high_resolution_clock (in microseconds)
+    const auto profiler_now_us =
+        std::chrono::time_point_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now())
+            .time_since_epoch()
+            .count();
+    constexpr int64_t NS_PER_US = 1000;
+    g_ProfilerOffsetUs.store(profiler_now_us - _TimeStampNow() / NS_PER_US,
+                             std::memory_order_relaxed);
+    SetScopeHook(ForwardScopeToProfiler);
+}
+
+auto Clock::GetThreadInstance() -> Clock& {
+    auto& state = GetState();
+    LOG_CORE_ASSERT(state.initialized.load(std::memory_order_relaxed),
+                    "Clock::GetThreadInstance >>> Must initialize "
+                    "clock-module before using it");
+    const auto generation = state.generation.load(std::memory_order_acquire);
+    if (UTILS_UNLIKELY(s_ThreadClock.clock == nullptr ||
+                       s_ThreadClock.generation != generation)) {
+        if (s_ThreadClock.clock == nullptr) {
+            const auto thread_id =
+                std::hash<std::thread::id>()(std::this_thread::get_id());
+            s_ThreadClock.clock = std::make_unique<Clock>(
+                "thread-" + std::to_string(thread_id));
+        } else {
+            // The module was reset, which already detached the clock (so no
+            // other thread can see it while it's being reset)
+            s_ThreadClock.clock->_Reset(
+                state.window_size.load(std::memory_order_relaxed));
+        }
+        auto* clock = s_ThreadClock.clock.get();
+        std::lock_guard<std::mutex> lock(state.clocks_mutex);
+        if (std::find(state.clocks.begin(), state.clocks.end(), clock) ==
+            state.clocks.end()) {
+            state.clocks.push_back(clock);
+        }
+        // Read again under the lock, in case the module was reset meanwhile
+        s_ThreadClock.generation =
+            state.generation.load(std::memory_order_relaxed);
+        state.thread_clocks.push_back(clock);
     }
-    s_Instance->m_ClockEvents.clear();
-    /// Initialize main clock-event (default event that the clock keeps track
-    /// of)
-    s_Instance->m_ClockEvents[MAIN_EVENT] = ClockEvent();
-    s_Instance->m_ClockEvents[MAIN_EVENT].name = MAIN_EVENT;
-    s_Instance->m_ClockEvents[MAIN_EVENT].time_start =
-        s_Instance->_TimeStampNow();
-    s_Instance->m_ClockEvents[MAIN_EVENT].time_stop =
-        s_Instance->_TimeStampNow();
-    s_Instance->m_ClockEvents[MAIN_EVENT].time_duration = 0.0;
+    return *s_ThreadClock.clock;
 }
 
-auto Clock::Release() -> void { s_Instance = nullptr; }
+auto Clock::Tick(ClockEventHandle handle) -> void {
+    GetThreadInstance().Start(handle);
+}
+
+auto Clock::Tock(ClockEventHandle handle) -> void {
+    GetThreadInstance().Stop(handle);
+}
+
+auto Clock::GetEvent(ClockEventHandle handle) -> ClockEvent {
+    auto& clock = GetThreadInstance();
+    clock.FlushIntervals();
+    if (handle.index >= GetState().num_events.load(std::memory_order_acquire)) {
+        LOG_CORE_WARN(
+            "Clock::GetEvent >>> event with handle {0} wasn't found on the set "
+            "of registered clock-events",
+            handle.index);
+        return MakeEmptyEvent("");
+    }
+    return clock.event(handle);
+}
 
 auto Clock::Tick(const std::string& event_name) -> void {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::Tick >>> Must initialize clock-module before using it");
-    s_Instance->_Tick(event_name);
+    auto& clock = GetThreadInstance();
+    clock.Start(clock._FindEvent(event_name, true));
 }
 
 auto Clock::Tock(const std::string& event_name) -> void {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::Tock >>> Must initialize clock-module before using it");
-    s_Instance->_Tock(event_name);
+    auto& clock = GetThreadInstance();
+    const auto handle = clock._FindEvent(event_name, false);
+    if (!handle.valid()) {
+        LOG_CORE_WARN(
+            "Clock::Tock >>> tried calling Tock() with a non-started "
+            "clock-event \"{0}\"",
+            event_name);
+        return;
+    }
+    clock.Stop(handle);
 }
 
 auto Clock::GetEvent(const std::string& event_name) -> ClockEvent {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::GetEvent >>> Must initialize clock-module before using it");
-    if (s_Instance->m_ClockEvents.find(event_name) ==
-        s_Instance->m_ClockEvents.end()) {
+    auto& clock = GetThreadInstance();
+    clock.FlushIntervals();
+    const auto handle = clock._FindEvent(event_name, false);
+    if (!handle.valid()) {
         LOG_CORE_WARN(
             "Clock::GetEvent >>> event named {0} wasn't found on the set of "
             "registered clock-events",
             event_name);
-        return {event_name, 0.0, 0.0, 0.0};
+        return MakeEmptyEvent(event_name);
     }
-    return s_Instance->m_ClockEvents.at(event_name);
+    return clock.event(handle);
+}
+
+auto Clock::GetWallTime() -> double { return GetThreadInstance().wall_time(); }
+
+auto Clock::GetTimeStep() -> double { return GetThreadInstance().time_step(); }
+
+auto Clock::GetAvgTimeStep() -> double {
+    return GetThreadInstance().avg_time_step();
 }
 
-auto Clock::GetWallTime() -> float {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::GetWallTime >>> Must initialize clock-module before using it");
-    return s_Instance->m_TimeCurrent;
+auto Clock::GetFps() -> double { return GetThreadInstance().fps(); }
+
+auto Clock::GetAvgFps() -> double { return GetThreadInstance().avg_fps(); }
+
+auto Clock::GetTimeIndex() -> size_t {
+    return GetThreadInstance().time_index();
 }
 
-auto Clock::GetTimeStep() -> float {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::GetTimeStep >>> Must initialize clock-module before using it");
-    return s_Instance->m_TimeStep;
+auto Clock::GetTimesBuffer() -> Clock::BufferArray {
+    return GetThreadInstance().times_buffer();
 }
 
-auto Clock::GetAvgTimeStep() -> float {
-    LOG_CORE_ASSERT(s_Instance,
-                    "Clock::GetAvgTimeStep >>> Must initialize clock-module "
-                    "before using it");
-    return s_Instance->m_TimeStepAvg;
+auto Clock::GetFpsBuffer() -> Clock::BufferArray {
+    return GetThreadInstance().fps_buffer();
 }
 
-auto Clock::GetFps() -> float {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::GetFps >>> Must initialize clock-module before using it");
-    return 1.0F / s_Instance->m_TimeStep;
+auto Clock::GetTimesBufferView() -> BufferView {
+    return GetThreadInstance().times_buffer_view();
 }
 
-auto Clock::GetAvgFps() -> float {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::GetAvgFps >>> Must initialize clock-module before using it");
-    return 1.0F / s_Instance->m_TimeStepAvg;
+auto Clock::GetFpsBufferView() -> BufferView {
+    return GetThreadInstance().fps_buffer_view();
 }
 
-auto Clock::GetTimeIndex() -> size_t {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::GetTimeIndex >>> Must initialize clock-module before using it");
-    return s_Instance->m_TimeIndex;
+auto Clock::GetSharedTimesBuffer() -> SharedBuffer {
+    return GetThreadInstance().shared_times_buffer();
 }
 
-auto Clock::GetTimesBuffer() -> Clock::BufferArray {
-    LOG_CORE_ASSERT(s_Instance,
-                    "Clock::GetTimesBuffer >>> Must initialize clock-module "
-                    "before using it");
-    return s_Instance->m_TimesBuffer;
+auto Clock::GetSharedFpsBuffer() -> SharedBuffer {
+    return GetThreadInstance().shared_fps_buffer();
 }
 
-auto Clock::GetFpsBuffer() -> Clock::BufferArray {
-    LOG_CORE_ASSERT(
-        s_Instance,
-        "Clock::GetFpsBuffer >>> Must initialize clock-module before using it");
-    return s_Instance->m_FpsBuffer;
+auto Clock::SetWindowSize(size_t window_size) -> void {
+    window_size = std::max<size_t>(window_size, 1);
+    GetState().window_size.store(window_size, std::memory_order_relaxed);
+    GetThreadInstance().Resize(window_size);
 }
 
-auto Clock::_Tick(const std::string& event_name) -> void {
-    if (m_ClockEvents.find(event_name) == m_ClockEvents.end()) {
-        m_ClockEvents[event_name] = ClockEvent();
-        m_ClockEvents[event_name].name = event_name;
+auto Clock::GetWindowSize() -> size_t {
+    return GetThreadInstance().window_size();
+}
+
+auto Clock::Snapshot() -> std::vector<ClockSnapshot> {
+    auto& state = GetState();
+    // Only the owner can fold the pending intervals of a clock
+    if (s_ThreadClock.clock != nullptr &&
+        s_ThreadClock.generation ==
+            state.generation.load(std::memory_order_acquire)) {
+        s_ThreadClock.clock->FlushIntervals();
+    }
+    std::vector<ClockSnapshot> snapshots;
+    std::lock_guard<std::mutex> lock(state.clocks_mutex);
+    snapshots.reserve(state.clocks.size() + 1);
+    for (const auto* clock : state.clocks) {
+        snapshots.push_back(clock->TakeSnapshot());
+    }
+    if (!state.retired_threads.events.empty()) {
+        snapshots.push_back(state.retired_threads);
+    }
+    return snapshots;
+}
+
+auto Clock::Merge(const std::vector<ClockSnapshot>& snapshots)
+    -> std::vector<ClockEvent> {
+    std::vector<ClockEvent> merged;
+    std::vector<StatsAccumulator> accumulators;
+    for (const auto& snapshot : snapshots) {
+        for (size_t i = 0; i < snapshot.events.size(); i++) {
+            const auto& event = snapshot.events[i];
+            if (i >= merged.size()) {
+                merged.resize(i + 1, MakeEmptyEvent(""));
+                accumulators.resize(i + 1);
+            }
+            auto& dst = merged[i];
+            auto& acc = accumulators[i];
+            const auto& stats = event.stats;
+            if (event.num_samples > 0 && stats.window_count > 0) {
+                const auto n = static_cast<double>(stats.window_count);
+                const auto w = static_cast<double>(event.num_samples);
+                dst.stats.min = (acc.window_count == 0)
+                                    ? stats.min
+                                    : std::min(dst.stats.min, stats.min);
+                dst.stats.max = (acc.window_count == 0)
+                                    ? stats.max
+                                    : std::max(dst.stats.max, stats.max);
+                acc.window_count += stats.window_count;
+                acc.num_samples += event.num_samples;
+                acc.sum += stats.mean * n;
+                acc.sum_sq +=
+                    (stats.stddev * stats.stddev + stats.mean * stats.mean) * n;
+                acc.ewma += stats.ewma * w;
+                acc.p50 += stats.p50 * w;
+                acc.p99 += stats.p99 * w;
+                acc.p999 += stats.p999 * w;
+            }
+            dst.name = event.name;
+            dst.num_samples += event.num_samples;
+            dst.total_duration_ns += event.total_duration_ns;
+            // Timestamps come from the same monotonic clock on every thread,
+            // so the most recent sample is the one that stopped last
+            if (event.num_samples > 0 &&
+                event.time_stop_ns >= dst.time_stop_ns) {
+                dst.time_start = event.time_start;
+                dst.time_stop = event.time_stop;
+                dst.time_duration = event.time_duration;
+                dst.time_start_ns = event.time_start_ns;
+                dst.time_stop_ns = event.time_stop_ns;
+                dst.duration_ns = event.duration_ns;
+            }
+        }
     }
-    m_ClockEvents[event_name].time_start = _TimeStampNow();
+    // Windows are pooled exactly, whereas the moving averages and quantiles
+    // can't be merged exactly, so they're weighted by the number of samples
+    for (size_t i = 0; i < merged.size(); i++) {
+        const auto& acc = accumulators[i];
+        auto& stats = merged[i].stats;
+        if (acc.window_count == 0) {
+            continue;
+        }
+        const auto n = static_cast<double>(acc.window_count);
+        const auto w = static_cast<double>(acc.num_samples);
+        const auto variance = acc.sum_sq / n - (acc.sum / n) * (acc.sum / n);
+        stats.window_count = acc.window_count;
+        stats.mean = acc.sum / n;
+        stats.stddev = (variance > 0.0) ? std::sqrt(variance) : 0.0;
+        stats.ewma = acc.ewma / w;
+        stats.p50 = acc.p50 / w;
+        stats.p99 = acc.p99 / w;
+        stats.p999 = acc.p999 / w;
+    }
+    return merged;
+}
+
+Clock::Clock(std::string name, size_t window_size)
+    : m_Name(std::move(name)) {
+    if (window_size == 0) {
+        window_size = GetState().window_size.load(std::memory_order_relaxed);
+    }
+    _Reset(window_size);
+
+    auto& state = GetState();
+    std::lock_guard<std::mutex> lock(state.clocks_mutex);
+    state.clocks.push_back(this);
 }
 
-auto Clock::_Tock(const std::string& event_name) -> void {
-    if (m_ClockEvents.find(event_name) == m_ClockEvents.end()) {
+Clock::~Clock() {
+    auto& state = GetState();
+    std::lock_guard<std::mutex> lock(state.clocks_mutex);
+    state.clocks.erase(
+        std::remove(state.clocks.begin(), state.clocks.end(), this),
+        state.clocks.end());
+}
+
+auto Clock::Start(ClockEventHandle handle) -> int64_t {
+    auto& record = _GetRecord(handle);
+    const auto now = _TimeStampNow();
+    _BeginWrite();
+    record.time_start_ns.store(now, std::memory_order_relaxed);
+    _EndWrite();
+    return now;
+}
+
+auto Clock::Stop(ClockEventHandle handle) -> int64_t {
+    const auto now = _TimeStampNow();
+    if (m_NumPendingIntervals > 0) {
+        FlushIntervals();
+    }
+    auto& record = _GetRecord(handle);
+    // Only the owner writes into the records, so relaxed loads are enough
+    const auto time_start_ns =
+        record.time_start_ns.load(std::memory_order_relaxed);
+    // Handles are shared by all clocks, so the event might have been started
+    // by other clocks but never by this one
+    if (UTILS_UNLIKELY(time_start_ns == 0)) {
         LOG_CORE_WARN(
-            "Clock::_Tock >>> tried calling _Tock() with a non-started "
-            "clock-event \"{0}\"",
-            event_name);
-        return;
+            "Clock::Stop >>> tried stopping the non-started clock-event "
+            "\"{0}\" on clock \"{1}\"",
+            LookupEventName(handle.index), m_Name);
+        return now;
+    }
+    _RecordSample(handle, record, time_start_ns, now);
+    return now;
+}
+
+auto Clock::FlushIntervals() -> void {
+    for (size_t i = 0; i < m_NumPendingIntervals; i++) {
+        const auto& interval = m_PendingIntervals[i];
+        const ClockEventHandle handle{interval.index};
+        _RecordSample(handle, _GetRecord(handle), interval.start_ns,
+                      interval.stop_ns);
     }
-    m_ClockEvents[event_name].time_stop = _TimeStampNow();
-    m_ClockEvents[event_name].time_duration =
-        m_ClockEvents[event_name].time_stop -
-        m_ClockEvents[event_name].time_start;
-    if (event_name == MAIN_EVENT) {
-        // @todo(wilbert): check why we couldn't use double in all sides here
-        m_TimeStep =
-            static_cast<float>(m_ClockEvents[MAIN_EVENT].time_duration);
+    m_NumPendingIntervals = 0;
+}
+
+auto Clock::_RecordSample(ClockEventHandle handle, EventRecord& record,
+                          int64_t start_ns, int64_t stop_ns) -> void {
+    const auto duration_ns = stop_ns - start_ns;
+    const auto total_ns =
+        record.total_duration_ns.load(std::memory_order_relaxed) + duration_ns;
+    const auto num_samples =
+        record.num_samples.load(std::memory_order_relaxed) + 1;
+    const auto duration = static_cast<double>(duration_ns) * NS_TO_SECONDS;
+    record.window.Push(duration);
+    record.estimator_p50.Push(duration);
+    record.estimator_p99.Push(duration);
+    record.estimator_p999.Push(duration);
+
+    _BeginWrite();
+    record.time_start_ns.store(start_ns, std::memory_order_relaxed);
+    record.time_stop_ns.store(stop_ns, std::memory_order_relaxed);
+    record.duration_ns.store(duration_ns, std::memory_order_relaxed);
+    record.total_duration_ns.store(total_ns, std::memory_order_relaxed);
+    record.num_samples.store(num_samples, std::memory_order_relaxed);
+    record.window_count.store(record.window.count(),
+                              std::memory_order_relaxed);
+    record.mean.store(record.window.mean(), std::memory_order_relaxed);
+    record.stddev.store(record.window.stddev(), std::memory_order_relaxed);
+    record.min.store(record.window.min(), std::memory_order_relaxed);
+    record.max.store(record.window.max(), std::memory_order_relaxed);
+    record.ewma.store(record.window.ewma(), std::memory_order_relaxed);
+    record.p50.store(record.estimator_p50.value(), std::memory_order_relaxed);
+    record.p99.store(record.estimator_p99.value(), std::memory_order_relaxed);
+    record.p999.store(record.estimator_p999.value(),
+                      std::memory_order_relaxed);
+    _EndWrite();
+
+    if (handle.index == MAIN_EVENT_INDEX) {
+        auto& times_buffer = *m_TimesBuffer;
+        const auto window_size = static_cast<double>(times_buffer.size());
+        m_TimeStep = duration;
         m_TimeCurrent += m_TimeStep;
-        m_TimeStepAvg =
-            m_TimeStepAvg +
-            (m_TimeStep - m_TimesBuffer[m_TimeIndex]) / NUM_FRAMES_FOR_AVG;
-        m_TimesBuffer[m_TimeIndex] = m_TimeStep;
-        m_FpsBuffer[m_TimeIndex] = 1.0F / m_TimeStep;
-        m_TimeIndex = (m_TimeIndex + 1) % NUM_FRAMES_FOR_AVG;
-    }
-}
-
-auto Clock::_TimeStampNow() -> double {
-    constexpr auto TO_SECONDS = 0.001;
-    auto time_stamp_chrono = std::chrono::high_resolution_clock::now();
-    auto time_stamp =
-        static_cast<double>(
-            std::chrono::time_point_cast<std::chrono::milliseconds>(
-                time_stamp_chrono)
-                .time_since_epoch()
-                .count()) *
-        TO_SECONDS;
-    return time_stamp;
+        m_TimeStepAvg = m_TimeStepAvg +
+                        (m_TimeStep - times_buffer[m_TimeIndex]) / window_size;
+        times_buffer[m_TimeIndex] = m_TimeStep;
+        (*m_FpsBuffer)[m_TimeIndex] = SafeFps(m_TimeStep);
+        m_TimeIndex = (m_TimeIndex + 1) % times_buffer.size();
+    }
+}
+
+auto Clock::event(ClockEventHandle handle) const -> ClockEvent {
+    auto event = MakeEmptyEvent(LookupEventName(handle.index));
+    std::lock_guard<std::mutex> lock(m_RecordsMutex);
+    if (handle.index < m_Records.size()) {
+        _ReadRecord(m_Records[handle.index], event);
+    }
+    return event;
+}
+
+auto Clock::ReadSamples(int64_t* durations_ns, uint64_t* num_samples,
+                        size_t count) const -> void {
+    std::lock_guard<std::mutex> lock(m_RecordsMutex);
+    const auto num_records = std::min(count, m_Records.size());
+    while (true) {
+        const auto seq_begin = m_Sequence.load(std::memory_order_acquire);
+        if (seq_begin & 1U) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < num_records; i++) {
+            durations_ns[i] =  // NOLINT
+                m_Records[i].duration_ns.load(std::memory_order_relaxed);
+            num_samples[i] =  // NOLINT
+                m_Records[i].num_samples.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_Sequence.load(std::memory_order_relaxed) == seq_begin) {
+            break;
+        }
+    }
+    for (size_t i = num_records; i < count; i++) {
+        durations_ns[i] = 0;  // NOLINT
+        num_samples[i] = 0;   // NOLINT
+    }
+}
+
+auto Clock::TakeSnapshot() const -> ClockSnapshot {
+    ClockSnapshot snapshot;
+    snapshot.clock_name = m_Name;
+    std::vector<std::string> names;
+    {
+        auto& state = GetState();
+        std::lock_guard<std::mutex> lock(state.events_mutex);
+        names = state.event_names;
+    }
+    std::lock_guard<std::mutex> lock(m_RecordsMutex);
+    snapshot.events.reserve(m_Records.size());
+    for (size_t i = 0; i < m_Records.size(); i++) {
+        // Events registered after copying the names are left unnamed
+        snapshot.events.push_back(
+            MakeEmptyEvent(i < names.size() ? names[i] : ""));
+        _ReadRecord(m_Records[i], snapshot.events.back());
+    }
+    return snapshot;
+}
+
+auto Clock::Resize(size_t window_size) -> void {
+    window_size = std::max<size_t>(window_size, 1);
+    // Swap in new buffers, as the old ones might still be shared
+    m_TimesBuffer = std::make_shared<BufferArray>(window_size, 0.0);
+    m_FpsBuffer = std::make_shared<BufferArray>(window_size, 0.0);
+    m_TimeIndex = 0;
+    m_TimeStepAvg = 0.0;
+    m_NumPendingIntervals = 0;
+    for (auto& record : m_Records) {
+        _BeginWrite();
+        record.ResetStats(window_size);
+        _EndWrite();
+    }
+}
+
+auto Clock::fps() const -> double { return SafeFps(m_TimeStep); }
+
+auto Clock::_Reset(size_t window_size) -> void {
+    window_size = std::max<size_t>(window_size, 1);
+    m_TimeCurrent = 0.0;
+    m_TimeStep = 0.0;
+    m_TimeStepAvg = 0.0;
+    m_TimeIndex = 0;
+    m_NumPendingIntervals = 0;
+    m_TimesBuffer = std::make_shared<BufferArray>(window_size, 0.0);
+    m_FpsBuffer = std::make_shared<BufferArray>(window_size, 0.0);
+    {
+        std::lock_guard<std::mutex> lock(m_RecordsMutex);
+        m_Records.clear();
+    }
+
+    // The main event always exists, and starts at the reset of the clock
+    auto& main_record = _GetRecord(GetMainEvent());
+    const auto now = _TimeStampNow();
+    main_record.time_start_ns.store(now, std::memory_order_relaxed);
+    main_record.time_stop_ns.store(now, std::memory_order_relaxed);
+}
+
+auto Clock::avg_fps() const -> double { return SafeFps(m_TimeStepAvg); }
+
+auto Clock::_GetRecord(ClockEventHandle handle) -> EventRecord& {
+    if (UTILS_UNLIKELY(handle.index >= m_Records.size())) {
+        const auto num_events =
+            GetState().num_events.load(std::memory_order_acquire);
+        if (handle.index >= num_events) {
+            LOG_CORE_ASSERT(false, "Clock >>> Invalid event handle {0}",
+                            handle.index);
+            // Writes through invalid handles (if the assertion continues)
+            // end up in a scratch record
+            static thread_local EventRecord s_Discarded(1);  // NOLINT
+            return s_Discarded;
+        }
+        // Readers hold this lock, so they never see the records while the
+        // deque is growing (the owner itself reads the size without it)
+        std::lock_guard<std::mutex> lock(m_RecordsMutex);
+        while (m_Records.size() <= handle.index) {
+            m_Records.emplace_back(m_TimesBuffer->size());
+        }
+    }
+    return m_Records[handle.index];
+}
+
+auto Clock::_ReadRecord(const EventRecord& record, ClockEvent& dst) const
+    -> void {
+    while (true) {
+        const auto seq_begin = m_Sequence.load(std::memory_order_acquire);
+        if (seq_begin & 1U) {
+            std::this_thread::yield();
+            continue;
+        }
+        dst.time_start_ns =
+            record.time_start_ns.load(std::memory_order_relaxed);
+        dst.time_stop_ns =
+            record.time_stop_ns.load(std::memory_order_relaxed);
+        dst.duration_ns = record.duration_ns.load(std::memory_order_relaxed);
+        dst.total_duration_ns =
+            record.total_duration_ns.load(std::memory_order_relaxed);
+        dst.num_samples = record.num_samples.load(std::memory_order_relaxed);
+        dst.stats.window_count =
+            record.window_count.load(std::memory_order_relaxed);
+        dst.stats.mean = record.mean.load(std::memory_order_relaxed);
+        dst.stats.stddev = record.stddev.load(std::memory_order_relaxed);
+        dst.stats.min = record.min.load(std::memory_order_relaxed);
+        dst.stats.max = record.max.load(std::memory_order_relaxed);
+        dst.stats.ewma = record.ewma.load(std::memory_order_relaxed);
+        dst.stats.p50 = record.p50.load(std::memory_order_relaxed);
+        dst.stats.p99 = record.p99.load(std::memory_order_relaxed);
+        dst.stats.p999 = record.p999.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_Sequence.load(std::memory_order_relaxed) == seq_begin) {
+            break;
+        }
+    }
+    dst.time_start = static_cast<double>(dst.time_start_ns) * NS_TO_SECONDS;
+    dst.time_stop = static_cast<double>(dst.time_stop_ns) * NS_TO_SECONDS;
+    dst.time_duration = static_cast<double>(dst.duration_ns) * NS_TO_SECONDS;
+}
+
+auto Clock::_FindEvent(const std::string& event_name, bool register_if_missing)
+    -> ClockEventHandle {
+    auto it = m_EventsIndices.find(event_name);
+    if (it != m_EventsIndices.end()) {
+        return ClockEventHandle{it->second};
+    }
+    ClockEventHandle handle;
+    if (register_if_missing) {
+        handle = RegisterEvent(event_name);
+    } else {
+        auto& state = GetState();
+        std::lock_guard<std::mutex> lock(state.events_mutex);
+        auto it_state = state.event_indices.find(event_name);
+        if (it_state != state.event_indices.end()) {
+            handle = ClockEventHandle{it_state->second};
+        }
+    }
+    if (handle.valid()) {
+        m_EventsIndices[event_name] = handle.index;
+    }
+    return handle;
+}
+
+auto Clock::_BeginWrite() -> void {
+    const auto seq = m_Sequence.load(std::memory_order_relaxed);
+    m_Sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+auto Clock::_EndWrite() -> void {
+    const auto seq = m_Sequence.load(std::memory_order_relaxed);
+    m_Sequence.store(seq + 1, std::memory_order_release);
+}
+
+auto Clock::_TimeStampNow() -> int64_t {
+    // steady_clock is guaranteed to be monotonic (high_resolution_clock is
+    // usually an alias of system_clock, which can jump backwards)
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
 }
 
 }  // namespace utils
@@ -1,4 +1,9 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
 #include <catch2/catch.hpp>
+#include <utils/common.hpp>
 #include <utils/logging.hpp>
 
 // NOLINTNEXTLINE
@@ -59,4 +64,131 @@ TEST_CASE("Testing logging module", "[Logging]") {
                 ::utils::Logger::eType::CONSOLE_LOGGER);
         ::utils::Logger::Release();
     }
+    SECTION("Structured key-value records") {
+        auto& buffer = ::utils::GetThreadKvBuffer();
+        // Json-lines records hold the message and the fields in order
+        ::utils::kv::EncodeRecord(buffer, ::utils::eKvFormat::JSON_LINES,
+                                  spdlog::level::info, "step", "frame", 3,
+                                  "ok", true, "name", "a\"b");
+        REQUIRE(std::string(buffer.data(), buffer.size()) ==
+                R"("msg":"step","frame":3,"ok":true,"name":"a\"b")");
+
+        // Binary records are prefixed with their total size in bytes
+        ::utils::kv::EncodeRecord(buffer, ::utils::eKvFormat::BINARY,
+                                  spdlog::level::warn, "step", "dt", 0.5);
+        uint32_t record_size = 0;
+        std::memcpy(&record_size, buffer.data(), sizeof(record_size));
+        REQUIRE(record_size == buffer.size());
+
+        // Should be able to send structured records to the loggers
+        ::utils::Logger::Init();
+        LOG_CORE_INFO_KV("core-step", "frame", 1, "dt", 0.016);
+        LOG_INFO_KV("client-step", "frame", 2, "dt", 0.016);
+        ::utils::Logger::Release();
+
+        ::utils::Logger::Init(::utils::Logger::eType::FILE_LOGGER,
+                              ::utils::eKvFormat::BINARY);
+        REQUIRE(::utils::Logger::GetInstance().kv_format() ==
+                ::utils::eKvFormat::BINARY);
+        LOG_WARN_KV("client-step", "frame", 3, "tag", std::string("warm"));
+        ::utils::Logger::Release();
+    }
+    SECTION("Rate-limited logging") {
+        ::utils::LogRateLimiter every_n;
+        size_t num_emitted = 0;
+        uint64_t num_reported = 0;
+        for (size_t i = 0; i < 10; i++) {
+            num_emitted += every_n.EveryN(4) ? 1 : 0;
+            num_reported += every_n.TakePendingSummary();
+        }
+        // Should emit at calls 0, 4, and 8, reporting the 3 calls skipped
+        // before each of the last two
+        REQUIRE(num_emitted == 3);
+        REQUIRE(num_reported == 6);
+
+        ::utils::LogRateLimiter first_n;
+        num_emitted = 0;
+        num_reported = 0;
+        for (size_t i = 0; i < 10; i++) {
+            num_emitted += first_n.FirstN(2) ? 1 : 0;
+            num_reported += first_n.TakePendingSummary();
+        }
+        // Should emit just the first 2 calls, and report the suppressed ones
+        // when their count hits a power of two (1, 2, 4, 8)
+        REQUIRE(num_emitted == 2);
+        REQUIRE(num_reported == 8);
+
+        ::utils::LogRateLimiter every_ms;
+        num_emitted = 0;
+        for (size_t i = 0; i < 10; i++) {
+            num_emitted += every_ms.EveryMs(60000) ? 1 : 0;
+        }
+        // Only the first call should be emitted within the period
+        REQUIRE(num_emitted == 1);
+
+        for (size_t i = 0; i < 10; i++) {
+            LOG_WARN_EVERY_N(5, "Warning every 5 calls: {0}", i);
+            LOG_CORE_INFO_FIRST_N(1, "Info just once: {0}", i);
+            LOG_ERROR_EVERY_MS(1000, "Error once per second: {0}", i);
+        }
+        ::utils::Logger::Release();
+    }
+    SECTION("Crash log") {
+        constexpr const char* CRASH_LOG_PATH = "./test_crash_log.txt";
+        std::remove(CRASH_LOG_PATH);
+        ::utils::Logger::Init();
+        ::utils::CrashLog::Init(CRASH_LOG_PATH, 4);
+        REQUIRE(::utils::CrashLog::IsEnabled());
+        // Filtered messages should still be recorded into the ring
+        ::utils::Logger::GetInstance().client_logger().set_level(
+            spdlog::level::info);
+        LOG_TRACE("Filtered trace message: {0}", 42);
+        for (size_t i = 0; i < 3; i++) {
+            LOG_INFO("Recorded message: {0}", i);
+        }
+        ::utils::CrashLog::Dump("testing");
+
+        auto contents = ::utils::GetFileContents(CRASH_LOG_PATH);
+        REQUIRE(contents.find("==== crash log: testing ====") !=
+                std::string::npos);
+        REQUIRE(contents.find("Filtered trace message: 42") !=
+                std::string::npos);
+        REQUIRE(contents.find("Recorded message: 2") != std::string::npos);
+
+        // Only the last 4 records should be kept in the ring
+        std::remove(CRASH_LOG_PATH);
+        LOG_INFO("Recorded message: {0}", 3);
+        ::utils::CrashLog::Dump("testing");
+        contents = ::utils::GetFileContents(CRASH_LOG_PATH);
+        REQUIRE(contents.find("Filtered trace message") == std::string::npos);
+        REQUIRE(contents.find("Recorded message: 3") != std::string::npos);
+        ::utils::Logger::Release();
+        REQUIRE(!::utils::CrashLog::IsEnabled());
+        std::remove(CRASH_LOG_PATH);
+    }
+    SECTION("Assertion policies") {
+        ::utils::Logger::Init(::utils::Logger::eType::CONSOLE_LOGGER,
+                              ::utils::eKvFormat::JSON_LINES,
+                              ::utils::Logger::eAssertPolicy::THROW);
+        REQUIRE(::utils::Logger::GetInstance().assert_policy() ==
+                ::utils::Logger::eAssertPolicy::THROW);
+        // Message arguments should only be evaluated if the assertion fails
+        size_t num_evaluations = 0;
+        auto count_evaluation = [&num_evaluations]() -> size_t {
+            return ++num_evaluations;
+        };
+        LOG_ASSERT(1 + 1 == 2, "Evaluated {0} time(s)", count_evaluation());
+        REQUIRE(num_evaluations == 0);
+        REQUIRE_THROWS_AS(LOG_CORE_ASSERT(1 + 1 == 3, "Evaluated {0} time(s)",
+                                          count_evaluation()),
+                          ::utils::AssertionError);
+        REQUIRE(num_evaluations == 1);
+        ::utils::Logger::Release();
+
+        ::utils::Logger::Init(::utils::Logger::eType::CONSOLE_LOGGER,
+                              ::utils::eKvFormat::JSON_LINES,
+                              ::utils::Logger::eAssertPolicy::LOG_AND_CONTINUE);
+        REQUIRE_NOTHROW(LOG_ASSERT(false, "Should just log this failure"));
+        ::utils::Logger::Release();
+    }
 }
@@ -0,0 +1,113 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <utils/noise_field.hpp>
+
+// NOLINTNEXTLINE
+TEST_CASE("Testing noise-field module", "[NoiseField]") {
+    constexpr float SPACING = 0.25F;
+    constexpr size_t CHUNK_SIZE = 8;
+    constexpr size_t MAX_CHUNKS = 4;
+    constexpr float EPSILON = 1e-5F;
+    const ::utils::PerlinNoiseGenerator generator(42);
+
+    SECTION("Samples at the nodes match the generator") {
+        ::utils::NoiseField field(generator, SPACING, CHUNK_SIZE, MAX_CHUNKS);
+        // Nodes on both sides of the origin (and on chunk borders)
+        for (int i = -20; i <= 20; i += 3) {
+            for (int j = -20; j <= 20; j += 5) {
+                const float x = static_cast<float>(i) * SPACING;
+                const float y = static_cast<float>(j) * SPACING;
+                REQUIRE(field.Sample(x, y) ==
+                        Approx(generator.Sample2d(x, y)).margin(EPSILON));
+            }
+        }
+    }
+
+    SECTION("Samples inside a cell are interpolated from its nodes") {
+        ::utils::NoiseField field(generator, SPACING, CHUNK_SIZE, MAX_CHUNKS);
+        for (const float x_0 : {-1.75F, 0.0F, 1.75F, 2.0F}) {
+            const float y_0 = 0.5F;
+            const float x_1 = x_0 + SPACING;
+            const float y_1 = y_0 + SPACING;
+            const float t_x = 0.25F;
+            const float t_y = 0.75F;
+            const float value_00 = generator.Sample2d(x_0, y_0);
+            const float value_10 = generator.Sample2d(x_1, y_0);
+            const float value_01 = generator.Sample2d(x_0, y_1);
+            const float value_11 = generator.Sample2d(x_1, y_1);
+            const float value_0 = value_00 + t_x * (value_10 - value_00);
+            const float value_1 = value_01 + t_x * (value_11 - value_01);
+            const float expected = value_0 + t_y * (value_1 - value_0);
+            REQUIRE(field.Sample(x_0 + t_x * SPACING, y_0 + t_y * SPACING) ==
+                    Approx(expected).margin(EPSILON));
+        }
+    }
+
+    SECTION("Repeated queries are served from the cache") {
+        ::utils::NoiseField field(generator, SPACING, CHUNK_SIZE, MAX_CHUNKS);
+        const float value = field.Sample(0.3F, -0.7F);
+        REQUIRE(field.num_misses() == 1);
+        REQUIRE(field.num_hits() == 0);
+        for (size_t i = 0; i < 10; i++) {
+            REQUIRE(field.Sample(0.3F, -0.7F) == value);
+        }
+        // Another position within the same chunk
+        field.Sample(0.5F, -0.5F);
+        REQUIRE(field.num_misses() == 1);
+        REQUIRE(field.num_hits() == 11);
+        REQUIRE(field.num_cached_chunks() == 1);
+
+        field.Clear();
+        REQUIRE(field.num_cached_chunks() == 0);
+        REQUIRE(field.Sample(0.3F, -0.7F) == value);
+        REQUIRE(field.num_misses() == 2);
+    }
+
+    SECTION("The least recently used chunks are evicted first") {
+        ::utils::NoiseField field(generator, SPACING, CHUNK_SIZE, MAX_CHUNKS);
+        const float chunk_extent = SPACING * static_cast<float>(CHUNK_SIZE);
+        std::vector<float> values;
+        for (size_t i = 0; i < MAX_CHUNKS; i++) {
+            values.push_back(
+                field.Sample(static_cast<float>(i) * chunk_extent, 0.1F));
+        }
+        REQUIRE(field.num_cached_chunks() == MAX_CHUNKS);
+        // Touch the first chunk, so the second one is the oldest one now
+        field.Sample(0.0F, 0.1F);
+        field.Sample(-chunk_extent, 0.1F);
+        REQUIRE(field.num_cached_chunks() == MAX_CHUNKS);
+        const auto num_misses = field.num_misses();
+        REQUIRE(field.Sample(0.0F, 0.1F) == values[0]);
+        REQUIRE(field.num_misses() == num_misses);
+        // The evicted chunk is generated again (with the same values)
+        REQUIRE(field.Sample(chunk_extent, 0.1F) == values[1]);
+        REQUIRE(field.num_misses() == num_misses + 1);
+        REQUIRE(field.num_cached_chunks() == MAX_CHUNKS);
+    }
+
+    SECTION("Prefetched chunks are ready when queried") {
+        ::utils::ThreadPool pool(2);
+        ::utils::NoiseField field(generator, SPACING, CHUNK_SIZE, 9, pool);
+        const float chunk_extent = SPACING * static_cast<float>(CHUNK_SIZE);
+        field.Prefetch(0.1F, 0.1F);
+        REQUIRE(field.num_cached_chunks() == 9);
+        for (int i = -1; i <= 1; i++) {
+            for (int j = -1; j <= 1; j++) {
+                const float x = (static_cast<float>(i) + 0.3F) * chunk_extent;
+                const float y = (static_cast<float>(j) + 0.6F) * chunk_extent;
+                const float expected = field.Sample(x, y);
+                REQUIRE(std::isfinite(expected));
+                ::utils::NoiseField reference(generator, SPACING, CHUNK_SIZE,
+                                              1);
+                REQUIRE(reference.Sample(x, y) == expected);
+            }
+        }
+        REQUIRE(field.num_misses() == 0);
+        REQUIRE(field.num_hits() == 9);
+        // Chunks already cached aren't queued again
+        field.Prefetch(0.1F, 0.1F);
+        REQUIRE(field.num_cached_chunks() == 9);
+    }
+}
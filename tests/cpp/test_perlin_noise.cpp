@@ -0,0 +1,402 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <utils/logging.hpp>
+#include <utils/perlin_noise.hpp>
+#include <utils/perlin_noise_kernels.hpp>
+
+// NOLINTNEXTLINE
+TEST_CASE("Testing perlin-noise module", "[PerlinNoise]") {
+    ::utils::Logger::Init();
+    ::utils::PerlinNoise::Init();
+
+    SECTION("Grid sampling matches per-sample calls") {
+        constexpr size_t WIDTH = 37;
+        constexpr size_t HEIGHT = 23;
+        const ::utils::Vec2 origin(-12.5F, 3.25F);
+        const ::utils::Vec2 spacing(0.75F, 1.5F);
+        std::vector<float> grid(WIDTH * HEIGHT);
+        ::utils::PerlinNoise::SampleGrid2d(origin, spacing, WIDTH, HEIGHT,
+                                           grid.data());
+        for (size_t i = 0; i < HEIGHT; i++) {
+            for (size_t j = 0; j < WIDTH; j++) {
+                const float x =
+                    origin.x() + static_cast<float>(j) * spacing.x();
+                const float y =
+                    origin.y() + static_cast<float>(i) * spacing.y();
+                REQUIRE(grid[i * WIDTH + j] ==
+                        Approx(::utils::PerlinNoise::Sample2d(x, y))
+                            .margin(1e-5));
+            }
+        }
+
+        std::vector<float> line(WIDTH);
+        ::utils::PerlinNoise::SampleGrid1d(origin.x(), spacing.x(), WIDTH,
+                                           line.data());
+        for (size_t j = 0; j < WIDTH; j++) {
+            const float x = origin.x() + static_cast<float>(j) * spacing.x();
+            REQUIRE(line[j] ==
+                    Approx(::utils::PerlinNoise::Sample1d(x)).margin(1e-5));
+        }
+    }
+
+    SECTION("Vectorized kernels match the scalar kernel") {
+        // Odd sizes, so the kernels also go through their scalar tails
+        constexpr size_t WIDTH = 203;
+        constexpr size_t HEIGHT = 17;
+        const ::utils::Vec2 origin(-100.3F, 42.7F);
+        const ::utils::Vec2 spacing(0.37F, 0.61F);
+        const auto default_level = ::utils::PerlinNoise::GetSimdLevel();
+        REQUIRE(default_level == ::utils::GetSupportedSimdLevel());
+
+        std::vector<float> xs(WIDTH);
+        std::vector<float> ys(WIDTH);
+        for (size_t k = 0; k < WIDTH; k++) {
+            xs[k] = origin.x() + 0.77F * static_cast<float>(k);
+            ys[k] = origin.y() - 0.29F * static_cast<float>(k * k % 37);
+        }
+        const auto& generator = ::utils::PerlinNoise::GetGenerator();
+
+        ::utils::PerlinNoise::SetSimdLevel(::utils::eSimdLevel::SCALAR);
+        std::vector<float> expected(WIDTH * HEIGHT);
+        ::utils::PerlinNoise::SampleGrid2d(origin, spacing, WIDTH, HEIGHT,
+                                           expected.data());
+        std::vector<float> expected_points(WIDTH);
+        generator.SamplePoints2d(WIDTH, xs.data(), ys.data(),
+                                 expected_points.data());
+
+        for (const auto level :
+             {::utils::eSimdLevel::SSE2, ::utils::eSimdLevel::AVX2,
+              ::utils::eSimdLevel::NEON}) {
+            if (!::utils::IsSimdLevelSupported(level)) {
+                continue;
+            }
+            ::utils::PerlinNoise::SetSimdLevel(level);
+            REQUIRE(::utils::PerlinNoise::GetSimdLevel() == level);
+            // The x86 kernels do the same operations in the same order as the
+            // scalar one, so results are bit-identical. The compiler may fuse
+            // multiply-adds in the NEON kernel (fma contraction), so those are
+            // only checked to be close
+            const double margin =
+                (level == ::utils::eSimdLevel::NEON) ? 1e-6 : 0.0;
+            std::vector<float> grid(WIDTH * HEIGHT);
+            ::utils::PerlinNoise::SampleGrid2d(origin, spacing, WIDTH, HEIGHT,
+                                               grid.data());
+            for (size_t i = 0; i < grid.size(); i++) {
+                if (margin == 0.0) {
+                    REQUIRE(grid[i] == expected[i]);
+                } else {
+                    REQUIRE(grid[i] == Approx(expected[i]).margin(margin));
+                }
+            }
+            std::vector<float> points(WIDTH);
+            generator.SamplePoints2d(WIDTH, xs.data(), ys.data(),
+                                     points.data());
+            for (size_t k = 0; k < WIDTH; k++) {
+                if (margin == 0.0) {
+                    REQUIRE(points[k] == expected_points[k]);
+                } else {
+                    REQUIRE(points[k] ==
+                            Approx(expected_points[k]).margin(margin));
+                }
+            }
+        }
+        ::utils::PerlinNoise::SetSimdLevel(default_level);
+    }
+
+    SECTION("Parallel grid sampling matches the sequential version") {
+        // Not a multiple of the tile size, so there are partial tiles
+        constexpr size_t WIDTH = 300;
+        constexpr size_t HEIGHT = 150;
+        const ::utils::Vec2 origin(-7.5F, 12.25F);
+        const ::utils::Vec2 spacing(0.25F, 0.5F);
+        std::vector<float> expected(WIDTH * HEIGHT);
+        ::utils::PerlinNoise::SampleGrid2d(origin, spacing, WIDTH, HEIGHT,
+                                           expected.data());
+
+        ::utils::ThreadPool pool(3);
+        std::vector<float> grid(WIDTH * HEIGHT);
+        ::utils::PerlinNoise::SampleGrid2d(origin, spacing, WIDTH, HEIGHT,
+                                           grid.data(), pool);
+        REQUIRE(grid == expected);
+    }
+
+    SECTION("Generators are deterministic and independent") {
+        const ::utils::PerlinNoiseGenerator gen_a(7, 5, 0.4F, 2.5F, 20.0F);
+        const ::utils::PerlinNoiseGenerator gen_b(7, 5, 0.4F, 2.5F, 20.0F);
+        const ::utils::PerlinNoiseGenerator gen_c(8, 5, 0.4F, 2.5F, 20.0F);
+        const auto gen_copy = gen_a;  // NOLINT
+        REQUIRE(gen_copy.seed() == 7);
+        REQUIRE(gen_copy.num_octaves() == 5);
+        size_t num_different = 0;
+        for (int i = 0; i < 100; i++) {
+            const float x = 0.37F * static_cast<float>(i) - 11.0F;
+            const float y = 0.21F * static_cast<float>(i) + 3.0F;
+            REQUIRE(gen_a.Sample2d(x, y) == gen_b.Sample2d(x, y));
+            REQUIRE(gen_a.Sample2d(x, y) == gen_copy.Sample2d(x, y));
+            num_different += (gen_a.Sample2d(x, y) != gen_c.Sample2d(x, y));
+        }
+        REQUIRE(num_different > 90);
+
+        // The module samples from its default generator, and reconfiguring
+        // the module doesn't affect the generators created by the user
+        ::utils::PerlinNoise::SetGenerator(gen_c);
+        REQUIRE(::utils::PerlinNoise::Sample2d(1.5F, 2.5F) ==
+                gen_c.Sample2d(1.5F, 2.5F));
+        ::utils::PerlinNoise::Config(3, 0.5F, 2.0F, 10.0F);
+        REQUIRE(::utils::PerlinNoise::GetGenerator().seed() == 8);
+        REQUIRE(::utils::PerlinNoise::GetGenerator().num_octaves() == 3);
+        REQUIRE(gen_c.num_octaves() == 5);
+    }
+
+    SECTION("Seeded generators match the reference values") {
+        // Golden values of seed 1234 (default settings). The tables are drawn
+        // from the raw mt19937 output, so they must match exactly everywhere.
+        // The noise itself may differ in the last bits on platforms where the
+        // compiler fuses multiply-adds (e.g. aarch64), hence the margin
+        const ::utils::PerlinNoiseGenerator generator(1234);
+        const std::vector<uint8_t> expected_permutations = {
+            29, 232, 172, 82, 113, 130, 40, 21, 194, 87, 160, 110};
+        for (size_t i = 0; i < expected_permutations.size(); i++) {
+            REQUIRE(generator.permutations()[i] == expected_permutations[i]);
+            REQUIRE(generator.permutations()[i + 256] ==
+                    expected_permutations[i]);
+        }
+        REQUIRE(generator.Sample2d(0.5F, 0.25F) ==
+                Approx(-0.0693299621).margin(1e-6));
+        REQUIRE(generator.Sample2d(-3.75F, 12.5F) ==
+                Approx(-0.504262567).margin(1e-6));
+        REQUIRE(generator.Sample2d(101.3F, -42.7F) ==
+                Approx(-0.43244195).margin(1e-6));
+        REQUIRE(generator.Sample2d(7.0F, 7.0F) ==
+                Approx(0.0988818705).margin(1e-6));
+    }
+
+    SECTION("3d, 4d and simplex grids match per-sample calls") {
+        constexpr size_t WIDTH = 19;
+        constexpr size_t HEIGHT = 11;
+        constexpr size_t DEPTH = 5;
+        constexpr float W = 2.75F;
+        const ::utils::PerlinNoiseGenerator generator(11, 4, 0.5F, 2.0F, 7.5F);
+        const ::utils::Vec3 origin(-3.5F, 8.25F, -1.5F);
+        const ::utils::Vec3 spacing(0.7F, 0.45F, 1.3F);
+        ::utils::ThreadPool pool(2);
+
+        for (const auto type :
+             {::utils::eNoiseType::PERLIN, ::utils::eNoiseType::SIMPLEX}) {
+            std::vector<float> grid_2d(WIDTH * HEIGHT);
+            generator.SampleGrid2d(::utils::Vec2(origin.x(), origin.y()),
+                                   ::utils::Vec2(spacing.x(), spacing.y()),
+                                   WIDTH, HEIGHT, grid_2d.data(), type);
+            std::vector<float> grid_3d(WIDTH * HEIGHT * DEPTH);
+            generator.SampleGrid3d(origin, spacing, WIDTH, HEIGHT, DEPTH,
+                                   grid_3d.data(), type);
+            std::vector<float> grid_4d(WIDTH * HEIGHT * DEPTH);
+            generator.SampleGrid4d(origin, spacing, W, WIDTH, HEIGHT, DEPTH,
+                                   grid_4d.data(), type);
+
+            for (size_t k = 0; k < DEPTH; k++) {
+                for (size_t i = 0; i < HEIGHT; i++) {
+                    for (size_t j = 0; j < WIDTH; j++) {
+                        const float x =
+                            origin.x() + static_cast<float>(j) * spacing.x();
+                        const float y =
+                            origin.y() + static_cast<float>(i) * spacing.y();
+                        const float z =
+                            origin.z() + static_cast<float>(k) * spacing.z();
+                        const size_t index = (k * HEIGHT + i) * WIDTH + j;
+                        if (k == 0) {
+                            REQUIRE(grid_2d[index] ==
+                                    Approx(generator.Sample2d(x, y, type))
+                                        .margin(1e-5));
+                        }
+                        REQUIRE(grid_3d[index] ==
+                                Approx(generator.Sample3d(x, y, z, type))
+                                    .margin(1e-5));
+                        REQUIRE(grid_4d[index] ==
+                                Approx(generator.Sample4d(x, y, z, W, type))
+                                    .margin(1e-5));
+                        REQUIRE(std::abs(grid_3d[index]) < 2.0F);
+                        REQUIRE(std::abs(grid_4d[index]) < 2.0F);
+                    }
+                }
+            }
+
+            std::vector<float> grid_par(WIDTH * HEIGHT * DEPTH);
+            generator.SampleGrid4d(origin, spacing, W, WIDTH, HEIGHT, DEPTH,
+                                   grid_par.data(), pool, type);
+            REQUIRE(grid_par == grid_4d);
+        }
+    }
+
+    SECTION("Analytic gradients match finite differences") {
+        constexpr size_t WIDTH = 41;
+        constexpr size_t HEIGHT = 13;
+        // The octaves are sampled far from the origin (random offsets), where
+        // the float positions are coarse, so the finite differences need a
+        // large step (and a loose margin)
+        constexpr float STEP = 0.05F;
+        constexpr double EPS = 3e-2;
+        const ::utils::PerlinNoiseGenerator generator(5, 4, 0.5F, 2.0F, 9.0F);
+        const ::utils::Vec2 origin(-6.3F, 14.1F);
+        const ::utils::Vec2 spacing(0.53F, 0.77F);
+        std::vector<float> grid(WIDTH * HEIGHT);
+        std::vector<float> grad_x(WIDTH * HEIGHT);
+        std::vector<float> grad_y(WIDTH * HEIGHT);
+        generator.SampleGrid2dWithGradient(origin, spacing, WIDTH, HEIGHT,
+                                           grid.data(), grad_x.data(),
+                                           grad_y.data());
+
+        for (size_t i = 0; i < HEIGHT; i++) {
+            for (size_t j = 0; j < WIDTH; j++) {
+                const float x =
+                    origin.x() + static_cast<float>(j) * spacing.x();
+                const float y =
+                    origin.y() + static_cast<float>(i) * spacing.y();
+                const auto sample = generator.Sample2dWithGradient(x, y);
+                REQUIRE(sample.value == generator.Sample2d(x, y));
+
+                const double diff_x = (generator.Sample2d(x + STEP, y) -
+                                       generator.Sample2d(x - STEP, y)) /
+                                      (2.0 * STEP);
+                const double diff_y = (generator.Sample2d(x, y + STEP) -
+                                       generator.Sample2d(x, y - STEP)) /
+                                      (2.0 * STEP);
+                REQUIRE(sample.gradient.x() == Approx(diff_x).margin(EPS));
+                REQUIRE(sample.gradient.y() == Approx(diff_y).margin(EPS));
+
+                const size_t index = i * WIDTH + j;
+                REQUIRE(grid[index] == Approx(sample.value).margin(1e-5));
+                REQUIRE(grad_x[index] ==
+                        Approx(sample.gradient.x()).margin(1e-5));
+                REQUIRE(grad_y[index] ==
+                        Approx(sample.gradient.y()).margin(1e-5));
+            }
+        }
+
+        ::utils::ThreadPool pool(2);
+        std::vector<float> grid_par(WIDTH * HEIGHT);
+        std::vector<float> grad_x_par(WIDTH * HEIGHT);
+        std::vector<float> grad_y_par(WIDTH * HEIGHT);
+        generator.SampleGrid2dWithGradient(origin, spacing, WIDTH, HEIGHT,
+                                           grid_par.data(), grad_x_par.data(),
+                                           grad_y_par.data(), pool);
+        REQUIRE(grid_par == grid);
+        REQUIRE(grad_x_par == grad_x);
+        REQUIRE(grad_y_par == grad_y);
+    }
+
+    SECTION("Periodic noise tiles seamlessly") {
+        const ::utils::PerlinNoiseGenerator base(9, 4, 0.5F, 2.0F, 10.0F);
+        const auto generator = base.WithPeriod(::utils::Vec2(40.0F, 20.0F));
+        REQUIRE(generator.period().x() == 40.0F);
+        REQUIRE(base.period().x() == 0.0F);
+        for (int i = 0; i < 50; i++) {
+            const float x = 0.83F * static_cast<float>(i) - 7.0F;
+            const float y = 0.37F * static_cast<float>(i) + 2.0F;
+            // Positions are offset far from the origin, so wrapped samples
+            // are only equal up to the float resolution there
+            const float value = generator.Sample2d(x, y);
+            REQUIRE(generator.Sample2d(x + 40.0F, y) ==
+                    Approx(value).margin(5e-3));
+            REQUIRE(generator.Sample2d(x, y - 20.0F) ==
+                    Approx(value).margin(5e-3));
+            REQUIRE(generator.Sample2d(x - 80.0F, y + 60.0F) ==
+                    Approx(value).margin(5e-3));
+        }
+
+        constexpr size_t WIDTH = 45;
+        constexpr size_t HEIGHT = 21;
+        const ::utils::Vec2 origin(-3.0F, 1.5F);
+        const ::utils::Vec2 spacing(1.0F, 1.0F);
+        std::vector<float> grid(WIDTH * HEIGHT);
+        generator.SampleGrid2d(origin, spacing, WIDTH, HEIGHT, grid.data());
+        for (size_t i = 0; i < HEIGHT; i++) {
+            for (size_t j = 0; j < WIDTH; j++) {
+                const float x = origin.x() + static_cast<float>(j);
+                const float y = origin.y() + static_cast<float>(i);
+                REQUIRE(grid[i * WIDTH + j] ==
+                        Approx(generator.Sample2d(x, y)).margin(1e-5));
+            }
+            // Columns 0 and 40 are a period apart
+            REQUIRE(grid[i * WIDTH + 40] ==
+                    Approx(grid[i * WIDTH]).margin(5e-3));
+        }
+    }
+
+    SECTION("Point batches and warped grids match per-sample calls") {
+        const auto generator =
+            ::utils::PerlinNoiseGenerator(13, 5, 0.5F, 2.0F, 12.0F)
+                .WithPeriod(::utils::Vec2(48.0F, 0.0F));
+        const auto warp =
+            ::utils::DomainWarp()
+                .Then(::utils::PerlinNoiseGenerator(21, 3, 0.5F, 2.0F, 30.0F),
+                      4.0F)
+                .Then(::utils::PerlinNoiseGenerator(22, 2, 0.5F, 2.0F, 8.0F),
+                      1.5F);
+        REQUIRE(warp.num_stages() == 2);
+
+        // More points than a batch, so there's more than one batch
+        constexpr size_t NUM_POINTS = 5000;
+        std::vector<float> xs(NUM_POINTS);
+        std::vector<float> ys(NUM_POINTS);
+        for (size_t k = 0; k < NUM_POINTS; k++) {
+            xs[k] = 0.131F * static_cast<float>(k) - 300.0F;
+            ys[k] = 17.0F * std::sin(0.01F * static_cast<float>(k));
+        }
+        std::vector<float> values(NUM_POINTS);
+        generator.SamplePoints2d(NUM_POINTS, xs.data(), ys.data(),
+                                 values.data());
+        for (size_t k = 0; k < NUM_POINTS; k++) {
+            REQUIRE(values[k] ==
+                    Approx(generator.Sample2d(xs[k], ys[k])).margin(1e-5));
+        }
+        ::utils::ThreadPool pool(2);
+        std::vector<float> values_par(NUM_POINTS);
+        generator.SamplePoints2d(NUM_POINTS, xs.data(), ys.data(),
+                                 values_par.data(), pool);
+        REQUIRE(values_par == values);
+
+        constexpr size_t WIDTH = 150;
+        constexpr size_t HEIGHT = 9;
+        const ::utils::Vec2 origin(-20.0F, 4.0F);
+        const ::utils::Vec2 spacing(0.4F, 0.9F);
+        std::vector<float> grid(WIDTH * HEIGHT);
+        generator.SampleGrid2dWarped(warp, origin, spacing, WIDTH, HEIGHT,
+                                     grid.data());
+        for (size_t i = 0; i < HEIGHT; i++) {
+            for (size_t j = 0; j < WIDTH; j++) {
+                const float x =
+                    origin.x() + static_cast<float>(j) * spacing.x();
+                const float y =
+                    origin.y() + static_cast<float>(i) * spacing.y();
+                const auto warped = warp.Warp(x, y);
+                REQUIRE(grid[i * WIDTH + j] ==
+                        Approx(generator.Sample2d(warped)).margin(1e-4));
+            }
+        }
+        std::vector<float> grid_par(WIDTH * HEIGHT);
+        generator.SampleGrid2dWarped(warp, origin, spacing, WIDTH, HEIGHT,
+                                     grid_par.data(), pool);
+        REQUIRE(grid_par == grid);
+    }
+
+    SECTION("Generators can be sampled from several threads") {
+        const ::utils::PerlinNoiseGenerator generator(3);
+        constexpr size_t NUM_SAMPLES = 2000;
+        std::vector<float> expected(NUM_SAMPLES);
+        for (size_t i = 0; i < NUM_SAMPLES; i++) {
+            expected[i] = generator.Sample1d(0.1F * static_cast<float>(i));
+        }
+        std::vector<float> results(NUM_SAMPLES);
+        ::utils::ThreadPool pool(3);
+        pool.ParallelFor(NUM_SAMPLES, [&](size_t i) {
+            results[i] = generator.Sample1d(0.1F * static_cast<float>(i));
+        });
+        REQUIRE(results == expected);
+    }
+
+    ::utils::PerlinNoise::Release();
+    ::utils::Logger::Release();
+}
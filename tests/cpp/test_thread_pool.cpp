@@ -0,0 +1,48 @@
+#include <atomic>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <utils/thread_pool.hpp>
+
+// NOLINTNEXTLINE
+TEST_CASE("Testing thread-pool module", "[ThreadPool]") {
+    SECTION("ParallelFor runs every task exactly once") {
+        for (const size_t num_threads : {0, 1, 3}) {
+            ::utils::ThreadPool pool(num_threads);
+            if (num_threads != 0) {
+                REQUIRE(pool.num_threads() == num_threads);
+            }
+            // Reuse the same pool for several calls
+            for (const size_t num_tasks : {0, 1, 7, 1000}) {
+                std::vector<std::atomic<int>> counts(num_tasks);
+                for (auto& count : counts) {
+                    count.store(0);
+                }
+                pool.ParallelFor(num_tasks, [&](size_t i) { counts[i]++; });
+                for (const auto& count : counts) {
+                    REQUIRE(count.load() == 1);
+                }
+            }
+        }
+    }
+
+    SECTION("Nested ParallelFor calls don't deadlock") {
+        ::utils::ThreadPool pool(2);
+        std::atomic<size_t> total{0};
+        pool.ParallelFor(8, [&](size_t) {
+            pool.ParallelFor(8, [&](size_t) { total++; });
+        });
+        REQUIRE(total.load() == 64);
+    }
+
+    SECTION("Submitted tasks finish before the pool is destroyed") {
+        std::atomic<size_t> total{0};
+        {
+            ::utils::ThreadPool pool(2);
+            for (size_t i = 0; i < 100; i++) {
+                pool.Submit([&total]() { total++; });
+            }
+        }
+        REQUIRE(total.load() == 100);
+    }
+}
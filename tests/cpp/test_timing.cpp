@@ -0,0 +1,533 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <utils/clock_exporter.hpp>
+#include <utils/logging.hpp>
+#include <utils/periodic_task.hpp>
+#include <utils/scheduler.hpp>
+#include <utils/timer_wheel.hpp>
+#include <utils/timing.hpp>
+
+// NOLINTNEXTLINE
+TEST_CASE("Testing timing module", "[Timing]") {
+    ::utils::Logger::Init();
+    ::utils::Clock::Init();
+
+    SECTION("Sub-millisecond durations") {
+        // Events shorter than a millisecond should still report a duration
+        const auto handle = ::utils::Clock::RegisterEvent("sub_ms");
+        ::utils::Clock::Tick(handle);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        ::utils::Clock::Tock(handle);
+        const auto event = ::utils::Clock::GetEvent(handle);
+        REQUIRE(event.duration_ns > 0);
+        REQUIRE(event.time_duration > 0.0);
+        REQUIRE(event.time_duration < 1.0);
+        REQUIRE(event.time_stop_ns >= event.time_start_ns);
+    }
+
+    SECTION("Fps is always finite") {
+        // Back-to-back tick-tock calls shouldn't produce inf/nan fps
+        ::utils::Clock::Tick();
+        ::utils::Clock::Tock();
+        REQUIRE(std::isfinite(::utils::Clock::GetFps()));
+        REQUIRE(std::isfinite(::utils::Clock::GetAvgFps()));
+        REQUIRE(::utils::Clock::GetTimeStep() >= 0.0);
+    }
+
+    SECTION("String representation of events") {
+        // Same format as the original clock (parsed by log scrapers)
+        const ::utils::ClockEvent event{
+            "frame", 1.5, 2.0, 0.5, 0, 0, 0, 0, 0, ::utils::ClockEventStats{}};
+        REQUIRE(event.ToString() ==
+                "event   : frame\n\r"
+                "start   : 1.500000\n\r"
+                "stop    : 2.000000\n\r"
+                "duration: 0.500000\n\r");
+    }
+
+    SECTION("Per-thread clocks and snapshots") {
+        constexpr size_t NUM_THREADS = 4;
+        constexpr uint64_t NUM_SAMPLES = 1000;
+        const auto handle = ::utils::Clock::RegisterEvent("worker");
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < NUM_THREADS; i++) {
+            workers.emplace_back([handle]() {
+                for (uint64_t j = 0; j < NUM_SAMPLES; j++) {
+                    ::utils::Clock::Tick(handle);
+                    ::utils::Clock::Tock(handle);
+                }
+            });
+        }
+        // Snapshots can be taken while the workers are still ticking
+        for (size_t i = 0; i < 10; i++) {
+            auto events = ::utils::Clock::Merge(::utils::Clock::Snapshot());
+            if (events.size() > handle.index) {
+                REQUIRE(events[handle.index].num_samples <=
+                        NUM_THREADS * NUM_SAMPLES);
+            }
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        const auto events = ::utils::Clock::Merge(::utils::Clock::Snapshot());
+        REQUIRE(events.size() > handle.index);
+        REQUIRE(events[handle.index].name == "worker");
+        REQUIRE(events[handle.index].num_samples == NUM_THREADS * NUM_SAMPLES);
+
+        // The clocks of finished threads are dropped, and their samples are
+        // kept in a single snapshot (so it doesn't grow with more threads)
+        const auto num_snapshots = ::utils::Clock::Snapshot().size();
+        for (size_t i = 0; i < NUM_THREADS; i++) {
+            std::thread([handle]() {
+                ::utils::Clock::Tick(handle);
+                ::utils::Clock::Tock(handle);
+            }).join();
+        }
+        const auto snapshots = ::utils::Clock::Snapshot();
+        REQUIRE(snapshots.size() == num_snapshots);
+        REQUIRE(snapshots.back().clock_name == "retired-threads");
+        REQUIRE(::utils::Clock::Merge(snapshots)[handle.index].num_samples ==
+                NUM_THREADS * (NUM_SAMPLES + 1));
+        // The calling thread never ticked the event, so it has no samples
+        REQUIRE(::utils::Clock::GetEvent(handle).num_samples == 0);
+        // ... and stopping it there is ignored (the name is known, though)
+        ::utils::Clock::Tock("worker");
+        ::utils::Clock::Tock(handle);
+        REQUIRE(::utils::Clock::GetEvent(handle).num_samples == 0);
+        REQUIRE(::utils::Clock::GetEvent(handle).duration_ns == 0);
+    }
+
+    SECTION("Thread clocks outlive Init/Release") {
+        const auto handle = ::utils::Clock::RegisterEvent("resetting");
+        std::atomic<bool> ready{false};
+        std::atomic<bool> done{false};
+        uint64_t num_samples_before = 0;
+        uint64_t num_samples_after = 0;
+        // The worker keeps ticking its clock (through a reference obtained
+        // before the reset) while the module is released and initialized
+        std::thread worker([&]() {
+            auto& clock = ::utils::Clock::GetThreadInstance();
+            ready.store(true);
+            while (!done.load()) {
+                clock.Start(handle);
+                clock.Stop(handle);
+            }
+            num_samples_before = clock.event(handle).num_samples;
+            // The next use of the static API starts over with a clean clock
+            ::utils::Clock::Tick(handle);
+            ::utils::Clock::Tock(handle);
+            num_samples_after = ::utils::Clock::GetEvent(handle).num_samples;
+        });
+        while (!ready.load()) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < 10; i++) {
+            ::utils::Clock::Release();
+            ::utils::Clock::Init();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        done.store(true);
+        worker.join();
+        REQUIRE(num_samples_before > 0);
+        REQUIRE(num_samples_after == 1);
+    }
+
+    SECTION("Standalone clock instances") {
+        const auto handle = ::utils::Clock::RegisterEvent("subsystem");
+        ::utils::Clock clock("subsystem-clock");
+        clock.Start(handle);
+        clock.Stop(handle);
+        REQUIRE(clock.event(handle).num_samples == 1);
+        REQUIRE(clock.TakeSnapshot().clock_name == "subsystem-clock");
+    }
+
+    SECTION("Rolling statistics") {
+        ::utils::RollingStats stats(4);
+        for (const double value : {1.0, 2.0, 3.0, 4.0, 5.0, 6.0}) {
+            stats.Push(value);
+        }
+        // Only the last 4 samples (3, 4, 5, 6) remain in the window
+        REQUIRE(stats.count() == 4);
+        REQUIRE(stats.mean() == Approx(4.5));
+        REQUIRE(stats.min() == Approx(3.0));
+        REQUIRE(stats.max() == Approx(6.0));
+        REQUIRE(stats.stddev() == Approx(std::sqrt(1.25)));
+
+        // Extremes match the ones of the window, for constant, monotonic and
+        // oscillating streams (with ties)
+        constexpr size_t WINDOW_SIZE = 7;
+        for (const int pattern : {0, 1, 2, 3}) {
+            ::utils::RollingStats window(WINDOW_SIZE);
+            std::vector<double> samples;
+            for (size_t i = 0; i < 50; i++) {
+                const auto x = static_cast<double>(i);
+                const auto wave = static_cast<double>((i * 7) % 5);
+                const double value = (pattern == 0)   ? 1.0
+                                     : (pattern == 1) ? x
+                                     : (pattern == 2) ? -x
+                                                      : wave;
+                window.Push(value);
+                samples.push_back(value);
+                const auto first =
+                    samples.end() -
+                    static_cast<std::ptrdiff_t>(
+                        std::min<size_t>(samples.size(), WINDOW_SIZE));
+                const auto last = samples.end();
+                REQUIRE(window.min() == *std::min_element(first, last));
+                REQUIRE(window.max() == *std::max_element(first, last));
+            }
+        }
+    }
+
+    SECTION("Streaming quantiles") {
+        ::utils::P2QuantileEstimator p50(0.5);
+        ::utils::P2QuantileEstimator p99(0.99);
+        constexpr size_t NUM_SAMPLES = 10000;
+        for (size_t i = 0; i < NUM_SAMPLES; i++) {
+            // Deterministic permutation of [0, NUM_SAMPLES)
+            const auto value = static_cast<double>((i * 7919) % NUM_SAMPLES);
+            p50.Push(value);
+            p99.Push(value);
+        }
+        REQUIRE(p50.value() == Approx(0.5 * NUM_SAMPLES).epsilon(0.02));
+        REQUIRE(p99.value() == Approx(0.99 * NUM_SAMPLES).epsilon(0.02));
+    }
+
+    SECTION("Per-event statistics with runtime window size") {
+        ::utils::Clock::SetWindowSize(8);
+        REQUIRE(::utils::Clock::GetWindowSize() == 8);
+        REQUIRE(::utils::Clock::GetTimesBuffer().size() == 8);
+        const auto handle = ::utils::Clock::RegisterEvent("stats");
+        for (size_t i = 0; i < 20; i++) {
+            ::utils::Clock::Tick(handle);
+            ::utils::Clock::Tock(handle);
+        }
+        const auto stats = ::utils::Clock::GetEvent(handle).stats;
+        REQUIRE(stats.window_count == 8);
+        REQUIRE(stats.min <= stats.mean);
+        REQUIRE(stats.mean <= stats.max);
+        // The quantiles cover all samples (not just the window, as the
+        // extremes do), so they can't be bounded by min/max
+        REQUIRE(stats.p50 > 0.0);
+        ::utils::Clock::SetWindowSize(NUM_FRAMES_FOR_AVG);
+    }
+
+    SECTION("Views of the ring buffers") {
+        const auto view = ::utils::Clock::GetTimesBufferView();
+        REQUIRE(view.size == ::utils::Clock::GetWindowSize());
+        REQUIRE(view.write_index == ::utils::Clock::GetTimeIndex());
+        ::utils::Clock::Tick();
+        ::utils::Clock::Tock();
+        // The view aliases the storage of the clock, so it sees new samples
+        REQUIRE(view.data == ::utils::Clock::GetTimesBufferView().data);
+        REQUIRE(view[view.write_index] == ::utils::Clock::GetTimeStep());
+        REQUIRE(::utils::Clock::GetFpsBufferView().write_index ==
+                (view.write_index + 1) % view.size);
+
+        // Shared buffers outlive resizes (which swap in new buffers)
+        ::utils::Clock clock("shared-buffers", 16);
+        const auto shared = clock.shared_times_buffer();
+        REQUIRE(shared->data() == clock.times_buffer_view().data);
+        clock.Resize(4);
+        REQUIRE(shared->size() == 16);
+        REQUIRE(clock.times_buffer().size() == 4);
+        REQUIRE(shared.get() != clock.shared_times_buffer().get());
+    }
+
+    SECTION("Fixed-step scheduler") {
+        constexpr double STEP_SIZE = 0.001;
+        constexpr size_t NUM_ITERATIONS = 50;
+        ::utils::Clock clock("scheduler");
+        ::utils::FixedStepScheduler scheduler(STEP_SIZE, 5, &clock);
+        double sim_time = 0.0;
+        const auto start_ns = ::utils::Clock::GetTimeStampNs();
+        for (size_t i = 0; i < NUM_ITERATIONS; i++) {
+            scheduler.Update([&sim_time](double dt) { sim_time += dt; });
+            REQUIRE(scheduler.alpha() >= 0.0);
+            REQUIRE(scheduler.alpha() < 1.0);
+            scheduler.WaitForNextStep();
+        }
+        const auto elapsed =
+            static_cast<double>(::utils::Clock::GetTimeStampNs() - start_ns) *
+            1e-9;
+        // Simulated time never runs ahead of the real elapsed time
+        REQUIRE(sim_time <= elapsed + STEP_SIZE);
+        REQUIRE(scheduler.num_steps() > 0);
+        REQUIRE(scheduler.jitter().count() > 0);
+        REQUIRE(scheduler.jitter().min() >= 0.0);
+        const auto handle = ::utils::Clock::RegisterEvent("fixed_step");
+        REQUIRE(clock.event(handle).num_samples == scheduler.num_steps());
+    }
+
+    SECTION("Fixed-step scheduler with an invalid step") {
+        // The failed assertion is only logged, so the scheduler has to keep
+        // working with the smallest step it can represent
+        ::utils::Logger::Release();
+        ::utils::Logger::Init(::utils::Logger::eType::CONSOLE_LOGGER,
+                              ::utils::eKvFormat::JSON_LINES,
+                              ::utils::Logger::eAssertPolicy::LOG_AND_CONTINUE);
+        ::utils::FixedStepScheduler scheduler(0.0, 3);
+        size_t num_steps = 0;
+        for (size_t i = 0; i < 3; i++) {
+            num_steps += scheduler.Update([](double) {});
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+        REQUIRE(num_steps > 0);
+        REQUIRE(num_steps <= 6);
+        REQUIRE(scheduler.num_dropped_steps() > 0);
+        REQUIRE(std::isfinite(scheduler.alpha()));
+    }
+
+    SECTION("Periodic task") {
+        ::utils::PeriodicTaskOptions options;
+        options.name = "periodic";
+        options.period = 0.001;
+        std::atomic<uint64_t> num_calls{0};
+        ::utils::PeriodicTask task([&num_calls]() { num_calls++; }, options);
+        task.Start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        task.Stop();
+        REQUIRE(task.num_periods() == num_calls.load());
+        REQUIRE(task.num_periods() > 10);
+        REQUIRE(task.latency().count() == task.num_periods());
+        REQUIRE(task.jitter().count() == task.num_periods() - 1);
+        // Runs of the task show up as events of its clock
+        REQUIRE(task.clock().event(task.event()).num_samples ==
+                task.num_periods());
+    }
+
+    SECTION("Periodic task overruns") {
+        ::utils::PeriodicTaskOptions options;
+        options.name = "periodic_overrun";
+        options.period = 0.001;
+        ::utils::PeriodicTask task(
+            []() {
+                std::this_thread::sleep_for(std::chrono::microseconds(2500));
+            },
+            options);
+        task.Start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        task.Stop();
+        REQUIRE(task.num_overruns() > 0);
+        REQUIRE(task.num_missed_deadlines() >= task.num_overruns());
+    }
+
+    SECTION("Scoped clock events") {
+        for (size_t i = 0; i < 3; i++) {
+            CLOCK_SCOPE("scoped");
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        const auto event = ::utils::Clock::GetEvent("scoped");
+        REQUIRE(event.num_samples == 3);
+        REQUIRE(event.duration_ns > 0);
+    }
+
+    SECTION("Scoped clock events are folded in batches") {
+        constexpr size_t NUM_PASSES = 1000;
+        const auto handle = ::utils::Clock::RegisterEvent("batched");
+        const auto other = ::utils::Clock::RegisterEvent("batched-other");
+        ::utils::Clock clock("batched-clock");
+        for (size_t i = 0; i < 10; i++) {
+            CLOCK_SCOPE_IN(clock, "batched");
+        }
+        // The guards only store the time-stamps, until the owner folds them
+        REQUIRE(clock.event(handle).num_samples == 0);
+        clock.FlushIntervals();
+        REQUIRE(clock.event(handle).num_samples == 10);
+        // A full buffer of pending intervals is folded by the guard itself,
+        // and the rest by the next Stop() of any event of the clock
+        for (size_t i = 0; i < NUM_PASSES; i++) {
+            CLOCK_SCOPE_IN(clock, "batched");
+        }
+        REQUIRE(clock.event(handle).num_samples > 10);
+        REQUIRE(clock.event(handle).num_samples < 10 + NUM_PASSES);
+        clock.Start(other);
+        clock.Stop(other);
+        const auto event = clock.event(handle);
+        REQUIRE(event.num_samples == 10 + NUM_PASSES);
+        REQUIRE(event.time_stop_ns >= event.time_start_ns);
+        REQUIRE(event.stats.window_count > 0);
+        REQUIRE(event.stats.min <= event.stats.max);
+    }
+
+    SECTION("Scope hooks") {
+        static size_t s_NumCalls = 0;
+        static int64_t s_DurationNs = 0;
+        ::utils::Clock::SetScopeHook(
+            [](::utils::ClockEventHandle, int64_t start_ns, int64_t stop_ns) {
+                s_NumCalls++;
+                s_DurationNs = stop_ns - start_ns;
+            });
+        {
+            CLOCK_SCOPE("hooked");
+        }
+        ::utils::Clock::SetScopeHook(nullptr);
+        {
+            CLOCK_SCOPE("hooked");
+        }
+        REQUIRE(s_NumCalls == 1);
+        REQUIRE(s_DurationNs >= 0);
+    }
+
+    SECTION("Clock exporter") {
+        const auto handle = ::utils::Clock::RegisterEvent("exported");
+        const auto num_events = ::utils::Clock::GetNumEvents();
+        constexpr size_t NUM_FRAMES = 10;
+        {
+            ::utils::ClockExporter exporter("./clock_export_test.bin",
+                                            ::utils::eClockExportFormat::BINARY,
+                                            4);
+            REQUIRE(exporter.ok());
+            for (size_t i = 0; i < NUM_FRAMES; i++) {
+                ::utils::Clock::Tick();
+                // The event is only sampled on even frames
+                if (i % 2 == 0) {
+                    ::utils::Clock::Tick(handle);
+                    ::utils::Clock::Tock(handle);
+                }
+                ::utils::Clock::Tock();
+                exporter.Record();
+            }
+            exporter.Flush();
+            REQUIRE(exporter.num_frames() == NUM_FRAMES);
+        }
+
+        // Blocks of 4 frames: 4 + 4 + 2
+        std::ifstream file("./clock_export_test.bin", std::ios::binary);
+        REQUIRE(file.is_open());
+        char magic[::utils::ClockExporter::BINARY_MAGIC_SIZE];  // NOLINT
+        file.read(magic, sizeof(magic));
+        REQUIRE(std::memcmp(magic, ::utils::ClockExporter::BINARY_MAGIC,
+                            sizeof(magic)) == 0);
+        size_t frames_read = 0;
+        std::vector<int64_t> exported;
+        uint32_t sizes[2] = {0, 0};  // NOLINT
+        while (file.read(reinterpret_cast<char*>(sizes),  // NOLINT
+                         sizeof(sizes))) {
+            REQUIRE(sizes[1] == num_events);
+            std::vector<std::string> names(sizes[1]);
+            for (auto& name : names) {
+                uint32_t name_size = 0;
+                file.read(reinterpret_cast<char*>(&name_size),  // NOLINT
+                          sizeof(name_size));
+                name.resize(name_size);
+                file.read(&name[0], name_size);
+            }
+            REQUIRE(names[0] == MAIN_EVENT);
+            REQUIRE(names[handle.index] == "exported");
+            std::vector<int64_t> frames(sizes[0]);
+            std::vector<double> wall_times(sizes[0]);
+            std::vector<int64_t> durations(sizes[0] * sizes[1]);
+            file.read(reinterpret_cast<char*>(frames.data()),  // NOLINT
+                      static_cast<std::streamsize>(frames.size() * 8));
+            file.read(reinterpret_cast<char*>(wall_times.data()),  // NOLINT
+                      static_cast<std::streamsize>(wall_times.size() * 8));
+            file.read(reinterpret_cast<char*>(durations.data()),  // NOLINT
+                      static_cast<std::streamsize>(durations.size() * 8));
+            for (size_t i = 0; i < sizes[0]; i++) {
+                REQUIRE(frames[i] == static_cast<int64_t>(frames_read + i));
+                REQUIRE(durations[i] > 0);  // main event, sampled every frame
+                exported.push_back(durations[handle.index * sizes[0] + i]);
+            }
+            frames_read += sizes[0];
+        }
+        REQUIRE(frames_read == NUM_FRAMES);
+        for (size_t i = 0; i < NUM_FRAMES; i++) {
+            REQUIRE((exported[i] >= 0) == (i % 2 == 0));
+        }
+        file.close();
+        std::remove("./clock_export_test.bin");
+
+        {
+            ::utils::ClockExporter exporter("./clock_export_test.csv",
+                                            ::utils::eClockExportFormat::CSV);
+            for (size_t i = 0; i < NUM_FRAMES; i++) {
+                ::utils::Clock::Tick();
+                ::utils::Clock::Tock();
+                exporter.Record();
+            }
+        }
+        std::ifstream csv_file("./clock_export_test.csv");
+        std::string line;
+        std::getline(csv_file, line);
+        REQUIRE(line.rfind("frame,wall_time,walltime", 0) == 0);
+        size_t num_lines = 0;
+        while (std::getline(csv_file, line)) {
+            num_lines++;
+        }
+        REQUIRE(num_lines == NUM_FRAMES);
+        csv_file.close();
+        std::remove("./clock_export_test.csv");
+    }
+
+    SECTION("Timer wheel") {
+        ::utils::TimerWheel wheel(0.001);
+        // Delays that land on every level of the wheel, plus one out of range
+        const std::vector<uint64_t> delays = {1,    5,     63,     64,    65,
+                                              4095, 4096,  70000,  262144,
+                                              300000, 17000000};
+        std::vector<uint64_t> fired(delays.size(), 0);
+        for (size_t i = 0; i < delays.size(); i++) {
+            wheel.Schedule(static_cast<double>(delays[i]) * 0.001, [&, i]() {
+                fired[i] = static_cast<uint64_t>(
+                    std::llround(wheel.current_time() / 0.001));
+            });
+        }
+        auto cancelled = wheel.Schedule(0.010, [&]() { fired[0] = 0; });
+        REQUIRE(wheel.size() == delays.size() + 1);
+        REQUIRE(wheel.Cancel(cancelled));
+        REQUIRE_FALSE(wheel.Cancel(cancelled));
+        REQUIRE(wheel.size() == delays.size());
+
+        // Advancing one tick at a time, each timer fires at its exact tick
+        for (uint64_t tick = 1; tick <= 300000; tick++) {
+            wheel.Advance(static_cast<double>(tick) * 0.001);
+        }
+        for (size_t i = 0; i + 1 < delays.size(); i++) {
+            REQUIRE(fired[i] == delays[i]);
+        }
+        REQUIRE(wheel.size() == 1);
+        // Large jumps fire everything that expired in between
+        wheel.Advance(17000.0);
+        REQUIRE(fired.back() == delays.back());
+        REQUIRE(wheel.size() == 0);
+
+        // Callbacks can schedule other timers, and stale handles are ignored
+        size_t num_calls = 0;
+        const auto stale = wheel.Schedule(0.0, [&]() {
+            num_calls++;
+            wheel.Schedule(0.002, [&]() { num_calls++; });
+        });
+        wheel.Advance(wheel.current_time() + 0.001);
+        REQUIRE(num_calls == 1);
+        REQUIRE_FALSE(wheel.Cancel(stale));
+        wheel.Advance(wheel.current_time() + 0.002);
+        REQUIRE(num_calls == 2);
+
+        // Driven by its own thread
+        std::atomic<bool> done{false};
+        wheel.Schedule(0.005, [&]() { done = true; });
+        wheel.StartThread();
+        const auto start = std::chrono::steady_clock::now();
+        while (!done && std::chrono::steady_clock::now() - start <
+                            std::chrono::seconds(1)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        wheel.StopThread();
+        REQUIRE(done);
+    }
+
+    ::utils::Clock::Release();
+    ::utils::Logger::Release();
+}
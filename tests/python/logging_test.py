@@ -1,5 +1,7 @@
+import logging
+
 import pytest
-from utils import Logger, LoggerType
+from utils import Logger, LoggerType, LogLevel, NativeLogHandler
 
 
 def test_init_release() -> None:
@@ -53,3 +55,28 @@ def test_auto_initialization() -> None:
     assert Logger.GetInstance().ready == True
     assert Logger.GetInstance().type == LoggerType.CONSOLE_LOGGER
     Logger.Release()
+
+
+def test_format_args() -> None:
+    Logger.Init()
+    # Should be able to pass the arguments to be formatted natively
+    Logger.Info("frame: {0}, dt: {1}, name: {2}", 10, 0.016, "step")
+    Logger.CoreWarn("flag: {}, big: {}", True, 2**70)
+    # Messages without arguments are passed as they are
+    Logger.LogMessage(LogLevel.INFO, "braces {} are kept as-is")
+    assert Logger.IsEnabled(LogLevel.TRACE)
+    Logger.Release()
+
+
+def test_native_log_handler() -> None:
+    Logger.Init()
+    py_logger = logging.getLogger("native_bridge_test")
+    py_logger.setLevel(logging.DEBUG)
+    handler = NativeLogHandler()
+    py_logger.addHandler(handler)
+    # Records from python's logging should end up in the native loggers
+    py_logger.debug("debug record %d", 1)
+    py_logger.info("info record {not-a-field}")
+    py_logger.warning("warning record")
+    py_logger.removeHandler(handler)
+    Logger.Release()
@@ -0,0 +1,82 @@
+import numpy as np
+import pytest
+from utils import (
+    IsSimdLevelSupported,
+    PerlinNoise,
+    PerlinNoiseGenerator,
+    SimdLevel,
+)
+
+
+def test_sample_points() -> None:
+    generator = PerlinNoiseGenerator(seed=42)
+    rng = np.random.default_rng(0)
+    xs = rng.uniform(-10.0, 10.0, size=(16, 32)).astype(np.float32)
+    ys = rng.uniform(-10.0, 10.0, size=(16, 32)).astype(np.float32)
+
+    # The samples keep the shape of the coordinates
+    values = generator.SamplePoints2d(xs, ys)
+    assert values.shape == xs.shape
+    assert values.dtype == np.float32
+    for i in range(0, xs.shape[0], 5):
+        for j in range(0, xs.shape[1], 7):
+            expected = generator.Sample2d(float(xs[i, j]), float(ys[i, j]))
+            assert values[i, j] == pytest.approx(expected, abs=1e-5)
+
+    # Sequential and parallel sampling give the same results
+    serial = generator.SamplePoints2d(xs, ys, parallel=False)
+    assert np.array_equal(serial, values)
+
+    # Other dtypes are converted first
+    converted = generator.SamplePoints2d(
+        xs.astype(np.float64), ys.astype(np.float64)
+    )
+    assert np.array_equal(converted, values)
+
+
+def test_sample_points_into_array() -> None:
+    generator = PerlinNoiseGenerator(seed=7)
+    xs = np.linspace(-4.0, 4.0, 1000, dtype=np.float32)
+    ys = np.linspace(3.0, -3.0, 1000, dtype=np.float32)
+
+    # Samples are written in place into the given array
+    out = np.zeros_like(xs)
+    result = generator.SamplePoints2d(xs, ys, out=out)
+    assert np.shares_memory(result, out)
+    assert np.array_equal(out, generator.SamplePoints2d(xs, ys))
+
+    # Arrays that would need a copy are rejected
+    with pytest.raises(TypeError):
+        generator.SamplePoints2d(xs, ys, out=np.zeros(1000, dtype=np.float64))
+    with pytest.raises(ValueError):
+        generator.SamplePoints2d(xs, ys, out=np.zeros(999, dtype=np.float32))
+    with pytest.raises(ValueError):
+        generator.SamplePoints2d(xs, ys[:500])
+    readonly = np.zeros_like(xs)
+    readonly.setflags(write=False)
+    with pytest.raises(ValueError):
+        generator.SamplePoints2d(xs, ys, out=readonly)
+
+    # Writing the samples over the coordinates is rejected
+    with pytest.raises(ValueError):
+        generator.SamplePoints2d(xs, ys, out=xs)
+    with pytest.raises(ValueError):
+        generator.SamplePoints2d(xs, ys, out=ys)
+
+
+def test_simd_levels() -> None:
+    generator = PerlinNoiseGenerator(seed=3)
+    xs = np.linspace(-8.0, 8.0, 257, dtype=np.float32)
+    ys = np.linspace(-2.0, 5.0, 257, dtype=np.float32)
+
+    default_level = PerlinNoise.GetSimdLevel()
+    PerlinNoise.SetSimdLevel(SimdLevel.SCALAR)
+    assert PerlinNoise.GetSimdLevel() == SimdLevel.SCALAR
+    expected = generator.SamplePoints2d(xs, ys)
+    for level in (SimdLevel.SSE2, SimdLevel.AVX2, SimdLevel.NEON):
+        if not IsSimdLevelSupported(level):
+            continue
+        PerlinNoise.SetSimdLevel(level)
+        values = generator.SamplePoints2d(xs, ys)
+        assert np.allclose(values, expected, atol=1e-5)
+    PerlinNoise.SetSimdLevel(default_level)
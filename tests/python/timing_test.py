@@ -0,0 +1,78 @@
+import numpy as np
+from utils import (
+    Clock,
+    ClockExporter,
+    ClockExportFormat,
+    Logger,
+    load_clock_export,
+)
+
+
+def test_buffer_views() -> None:
+    Logger.Init()
+    Clock.Init()
+
+    times = Clock.GetTimesBuffer()
+    # The buffers are exposed as read-only views (no copies)
+    assert isinstance(times, np.ndarray)
+    assert times.shape == (Clock.GetWindowSize(),)
+    assert not times.flags.writeable
+
+    # The view is updated in place by the clock
+    index = Clock.GetTimeIndex()
+    Clock.Tick("walltime")
+    Clock.Tock("walltime")
+    assert times[index] == Clock.GetTimeStep()
+
+    # Views keep their buffer alive, even after the clock is resized (which
+    # swaps in new buffers) or destroyed
+    clock = Clock("dashboard", window_size=16)
+    fps = clock.fps_buffer
+    clock.Resize(4)
+    assert fps.shape == (16,)
+    assert clock.fps_buffer.shape == (4,)
+    del clock
+    assert fps.shape == (16,)
+    assert np.all(fps == 0.0)
+
+    # Same for the views of the calling thread's clock
+    time_step = Clock.GetTimeStep()
+    window_size = Clock.GetWindowSize()
+    Clock.Release()
+    assert times.shape == (window_size,)
+    assert times[index] == time_step
+
+    Logger.Release()
+
+
+def test_clock_export(tmp_path) -> None:
+    Logger.Init()
+    Clock.Init()
+
+    handle = Clock.RegisterEvent("exported")
+    for fmt, filename in (
+        (ClockExportFormat.BINARY, "timings.bin"),
+        (ClockExportFormat.CSV, "timings.csv"),
+    ):
+        filepath = str(tmp_path / filename)
+        exporter = ClockExporter(filepath, format=fmt, block_size=4)
+        for i in range(10):
+            Clock.Tick("walltime")
+            # The event is only sampled on even frames
+            if i % 2 == 0:
+                Clock.Tick(handle)
+                Clock.Tock(handle)
+            Clock.Tock("walltime")
+            exporter.Record()
+        exporter.Close()
+
+        trace = load_clock_export(filepath)
+        assert np.array_equal(trace["frame"], np.arange(10))
+        assert trace["wall_time"].dtype == np.float64
+        assert np.all(np.diff(trace["wall_time"]) > 0.0)
+        assert np.all(trace["walltime"] > 0)
+        sampled = trace["exported"] >= 0
+        assert np.array_equal(sampled, np.arange(10) % 2 == 0)
+
+    Clock.Release()
+    Logger.Release()